@@ -0,0 +1,417 @@
+/*
+    artistDictionary.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+#include "artistDictionary.h"
+#include "hashTablePolicies.h"
+
+/*
+Append a number to a string as a variable length integer, seven bits per byte
+@param data the string to append to
+@param value the number to append
+*/
+static void appendVarint(std::string &data, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    data.push_back(static_cast<char>(value));
+}
+
+/*
+Read a variable length integer and move past it
+@param data the position of the integer, moved to the byte after it
+@return the number read
+*/
+static uint32_t readVarint(const char *&data)
+{
+    uint32_t value = 0;
+    for (unsigned shift = 0;; shift += 7)
+    {
+        unsigned char byte = static_cast<unsigned char>(*data++);
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (byte < 0x80)
+        {
+            return value;
+        }
+    }
+}
+
+/*
+Decode the next name of a block over the previous one
+@param data the position of the entry, moved to the next entry
+@param name the previous name of the block, replaced by the decoded name
+@param first true for the first name of a block, which is stored whole
+*/
+static void decodeEntry(const char *&data, std::string &name, bool first)
+{
+    uint32_t shared = first ? 0 : readVarint(data);
+    uint32_t suffixLength = readVarint(data);
+    name.resize(shared);
+    name.append(data, suffixLength);
+    data += suffixLength;
+}
+
+/*
+Compare two names ignoring case, equal names ordered by their exact bytes
+@param lhs the first name
+@param rhs the second name
+@return true if lhs comes before rhs
+*/
+static bool foldedLess(const std::string &lhs, const std::string &rhs)
+{
+    size_t length = std::min(lhs.size(), rhs.size());
+    for (size_t i = 0; i < length; ++i)
+    {
+        int left = tolower(static_cast<unsigned char>(lhs[i]));
+        int right = tolower(static_cast<unsigned char>(rhs[i]));
+        if (left != right)
+        {
+            return left < right;
+        }
+    }
+    return lhs.size() != rhs.size() ? lhs.size() < rhs.size() : lhs < rhs;
+}
+
+/*
+Check whether two names are equal ignoring case
+@param lhs the first name
+@param rhs the second name
+@return true if the names are equal ignoring case, false otherwise
+*/
+static bool foldedEqual(const std::string &lhs, const std::string &rhs)
+{
+    if (lhs.size() != rhs.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i)
+    {
+        if (tolower(static_cast<unsigned char>(lhs[i])) != tolower(static_cast<unsigned char>(rhs[i])))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Constructor
+ArtistDictionary::ArtistDictionary() : slots(16, 0), slotBits(4) {}
+
+/*
+Hash a name ignoring case, the hash used when the caller does not give one
+@param name the artist name
+@return the djb2 hash of the lowercase name
+*/
+uint64_t ArtistDictionary::foldedHash(const std::string &name)
+{
+    return Djb2Hash::hash<CaseInsensitiveKey>(name);
+}
+
+/*
+Find the first slot to probe for a hash
+djb2 spreads its entropy poorly over the low bits, so the slot is taken from the top bits of a multiplied hash
+@param hashValue the hash of a name
+@return the index of the slot
+*/
+size_t ArtistDictionary::firstSlot(uint64_t hashValue) const
+{
+    return static_cast<size_t>((hashValue * fibonacciMultiplier) >> (64 - slotBits));
+}
+
+/*
+Store an id in the first free slot for its hash
+@param id the id to store
+*/
+void ArtistDictionary::placeInSlots(uint32_t id)
+{
+    size_t mask = slots.size() - 1;
+    size_t slot = firstSlot(hashes[id]);
+    while (slots[slot] != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = id + 1;
+}
+
+/*
+Record a new id in the slots, doubling them when half full
+@param id the id to record, every smaller id is already recorded
+*/
+void ArtistDictionary::addToSlots(uint32_t id)
+{
+    if ((static_cast<size_t>(id) + 1) * 2 > slots.size())
+    {
+        slotBits++;
+        slots.assign(size_t(1) << slotBits, 0);
+        for (uint32_t other = 0; other < id; ++other)
+        {
+            placeInSlots(other);
+        }
+    }
+    placeInSlots(id);
+}
+
+/*
+Decode the name at a sorted position
+Decoding starts from the whole name at the head of its block
+@param position the sorted position of the name
+@param name the string receiving the name
+*/
+void ArtistDictionary::decodeSorted(uint32_t position, std::string &name) const
+{
+    uint32_t block = position / blockSize;
+    const char *data = blockData.data() + blockOffsets[block];
+    name.clear();
+    for (uint32_t i = block * blockSize; i <= position; ++i)
+    {
+        decodeEntry(data, name, i == block * blockSize);
+    }
+}
+
+/*
+Sort every name again and front code them into blocks
+Ids do not change, only where their names are stored
+*/
+void ArtistDictionary::rebuild()
+{
+    std::vector<std::pair<std::string, uint32_t>> entries;
+    entries.reserve(locations.size());
+
+    // Decode the sorted names in a single pass over the blocks
+    const char *data = blockData.data();
+    std::string name;
+    for (uint32_t position = 0; position < sortedIds.size(); ++position)
+    {
+        decodeEntry(data, name, position % blockSize == 0);
+        entries.emplace_back(name, sortedIds[position]);
+    }
+    for (std::string &recentName : recentNames)
+    {
+        entries.emplace_back(std::move(recentName), 0);
+    }
+    for (uint32_t id = 0; id < locations.size(); ++id)
+    {
+        if (locations[id] & recentBit)
+        {
+            entries[sortedIds.size() + (locations[id] & ~recentBit)].second = id;
+        }
+    }
+    recentNames.clear();
+    recentNames.shrink_to_fit();
+
+    // Spellings of a name differing only in case end up next to each other
+    std::sort(entries.begin(), entries.end(), [](const std::pair<std::string, uint32_t> &lhs, const std::pair<std::string, uint32_t> &rhs)
+              { return foldedLess(lhs.first, rhs.first); });
+
+    std::string newBlockData;
+    std::vector<uint32_t> newBlockOffsets;
+    sortedIds.assign(entries.size(), 0);
+    for (uint32_t position = 0; position < entries.size(); ++position)
+    {
+        const std::string &current = entries[position].first;
+        if (position % blockSize == 0)
+        {
+            newBlockOffsets.push_back(static_cast<uint32_t>(newBlockData.size()));
+            appendVarint(newBlockData, static_cast<uint32_t>(current.size()));
+            newBlockData += current;
+        }
+        else
+        {
+            const std::string &previous = entries[position - 1].first;
+            size_t shared = std::mismatch(previous.begin(), previous.begin() + std::min(previous.size(), current.size()), current.begin()).first - previous.begin();
+            appendVarint(newBlockData, static_cast<uint32_t>(shared));
+            appendVarint(newBlockData, static_cast<uint32_t>(current.size() - shared));
+            newBlockData.append(current, shared, std::string::npos);
+        }
+        sortedIds[position] = entries[position].second;
+        locations[entries[position].second] = position;
+    }
+    newBlockData.shrink_to_fit();
+    blockData.swap(newBlockData);
+    blockOffsets.swap(newBlockOffsets);
+}
+
+/*
+Get the id of a name, adding the name if it is new
+@param name the artist name, compared exactly
+@param hashValue the hash of the name, the hash table passes the one it places the artist's tracks with
+@return the id of the name
+*/
+uint32_t ArtistDictionary::intern(const std::string &name, uint64_t hashValue)
+{
+    uint32_t id = find(name, hashValue);
+    if (id != notFound)
+    {
+        return id;
+    }
+
+    id = static_cast<uint32_t>(locations.size());
+    hashes.push_back(hashValue);
+    addToSlots(id);
+    locations.push_back(recentBit | static_cast<uint32_t>(recentNames.size()));
+    recentNames.push_back(name);
+
+    // Sorting again once the recent names reach an eighth of the sorted ones keeps the cost amortised
+    if (recentNames.size() > std::max<size_t>(256, sortedIds.size() / 8))
+    {
+        rebuild();
+    }
+    return id;
+}
+
+/*
+Get the id of a name under the folded hash, adding the name if it is new
+@param name the artist name, compared exactly
+@return the id of the name
+*/
+uint32_t ArtistDictionary::intern(const std::string &name)
+{
+    return intern(name, foldedHash(name));
+}
+
+/*
+Find the id of a name
+@param name the artist name, compared exactly
+@param hashValue the hash the name was added with
+@return the id of the name, or notFound if it was never added
+*/
+uint32_t ArtistDictionary::find(const std::string &name, uint64_t hashValue) const
+{
+    size_t mask = slots.size() - 1;
+    std::string candidate;
+    for (size_t slot = firstSlot(hashValue); slots[slot] != 0; slot = (slot + 1) & mask)
+    {
+        uint32_t id = slots[slot] - 1;
+        // Names are only decoded when their hashes agree
+        if (hashes[id] == hashValue)
+        {
+            getName(id, candidate);
+            if (candidate == name)
+            {
+                return id;
+            }
+        }
+    }
+    return notFound;
+}
+
+/*
+Find the id of a name added under the folded hash
+@param name the artist name, compared exactly
+@return the id of the name, or notFound if it was never added
+*/
+uint32_t ArtistDictionary::find(const std::string &name) const
+{
+    return find(name, foldedHash(name));
+}
+
+/*
+Find the ids of every spelling of a name, ignoring case
+@param name the artist name
+@param hashValue the hash shared by every spelling of the name
+@return the ids of the names equal to it ignoring case, empty if there are none
+*/
+std::vector<uint32_t> ArtistDictionary::findIgnoringCase(const std::string &name, uint64_t hashValue) const
+{
+    std::vector<uint32_t> ids;
+    size_t mask = slots.size() - 1;
+    std::string candidate;
+    for (size_t slot = firstSlot(hashValue); slots[slot] != 0; slot = (slot + 1) & mask)
+    {
+        uint32_t id = slots[slot] - 1;
+        if (hashes[id] == hashValue)
+        {
+            getName(id, candidate);
+            if (foldedEqual(candidate, name))
+            {
+                ids.push_back(id);
+            }
+        }
+    }
+    return ids;
+}
+
+/*
+Find the ids of every spelling of a name added under the folded hash
+@param name the artist name
+@return the ids of the names equal to it ignoring case, empty if there are none
+*/
+std::vector<uint32_t> ArtistDictionary::findIgnoringCase(const std::string &name) const
+{
+    return findIgnoringCase(name, foldedHash(name));
+}
+
+/*
+Get the name of an id
+@param id an id returned by intern
+@param name the string receiving the name
+*/
+void ArtistDictionary::getName(uint32_t id, std::string &name) const
+{
+    uint32_t location = locations[id];
+    if (location & recentBit)
+    {
+        name = recentNames[location & ~recentBit];
+    }
+    else
+    {
+        decodeSorted(location, name);
+    }
+}
+
+/*
+Get the name of an id
+@param id an id returned by intern
+@return the name
+*/
+std::string ArtistDictionary::getName(uint32_t id) const
+{
+    std::string name;
+    getName(id, name);
+    return name;
+}
+
+/*
+Get the hash a name was added with
+@param id an id returned by intern
+@return the hash of the name
+*/
+uint64_t ArtistDictionary::getHash(uint32_t id) const
+{
+    return hashes[id];
+}
+
+/*
+Get the number of distinct names
+@return the number of names added
+*/
+size_t ArtistDictionary::size() const
+{
+    return locations.size();
+}
+
+/*
+Measure the memory held by the dictionary
+@return the number of bytes allocated for names, ids and slots
+*/
+size_t ArtistDictionary::memoryUsage() const
+{
+    size_t bytes = blockData.capacity() + blockOffsets.capacity() * sizeof(uint32_t) +
+                   sortedIds.capacity() * sizeof(uint32_t) + locations.capacity() * sizeof(uint32_t) +
+                   hashes.capacity() * sizeof(uint64_t) + slots.capacity() * sizeof(uint32_t);
+    for (const std::string &name : recentNames)
+    {
+        bytes += sizeof(std::string) + (name.capacity() > 15 ? name.capacity() + 1 : 0);
+    }
+    return bytes;
+}
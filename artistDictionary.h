@@ -0,0 +1,121 @@
+#ifndef __ARTISTDICTIONARY_H_
+#define __ARTISTDICTIONARY_H_
+
+/*
+    artistDictionary.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ArtistDictionary class definition, stores every distinct artist name once and gives it a 4-byte id
+// Names are kept sorted in blocks, each name after the first of its block being front coded as the
+// length of the prefix it shares with the previous name followed by the rest of its bytes
+// Names added since the last rebuild wait in a small unsorted list until it outgrows a fraction of the sorted names
+class ArtistDictionary
+{
+private:
+    // Member datas
+    std::string blockData;              // Front coded names, in order
+    std::vector<uint32_t> blockOffsets; // Start of every block in blockData
+    std::vector<uint32_t> sortedIds;    // Id of the name at every sorted position
+    std::vector<std::string> recentNames;
+    std::vector<uint32_t> locations;    // By id, the sorted position of the name, or recentBit | its index in recentNames
+    std::vector<uint64_t> hashes;       // By id, the hash the name was added with
+    std::vector<uint32_t> slots;        // Open addressing table of id + 1 by hash, 0 for an empty slot
+    unsigned slotBits;
+
+    static constexpr uint32_t recentBit = 0x80000000u;
+
+    // Method to decode the name at a sorted position
+    void decodeSorted(uint32_t position, std::string &name) const;
+    // Method to find the first slot to probe for a hash
+    size_t firstSlot(uint64_t hashValue) const;
+    // Method to store an id in the first free slot for its hash
+    void placeInSlots(uint32_t id);
+    // Method to record a new id in the slots, doubling them when half full
+    void addToSlots(uint32_t id);
+    // Method to sort every name again and front code them into blocks
+    void rebuild();
+
+public:
+    static constexpr uint32_t blockSize = 16;
+    static constexpr uint32_t notFound = UINT32_MAX;
+
+    // Constructor
+    ArtistDictionary();
+
+    /*
+    Hash a name ignoring case, the hash used when the caller does not give one
+    @param name the artist name
+    @return the djb2 hash of the lowercase name
+    */
+    static uint64_t foldedHash(const std::string &name);
+
+    /*
+    Get the id of a name, adding the name if it is new
+    A name must always be given the same hash, and spellings found together by findIgnoringCase must share it
+    @param name the artist name, compared exactly
+    @param hashValue the hash of the name, the hash table passes the one it places the artist's tracks with
+    @return the id of the name
+    */
+    uint32_t intern(const std::string &name, uint64_t hashValue);
+    uint32_t intern(const std::string &name);
+
+    /*
+    Find the id of a name
+    @param name the artist name, compared exactly
+    @param hashValue the hash the name was added with
+    @return the id of the name, or notFound if it was never added
+    */
+    uint32_t find(const std::string &name, uint64_t hashValue) const;
+    uint32_t find(const std::string &name) const;
+
+    /*
+    Find the ids of every spelling of a name, ignoring case
+    @param name the artist name
+    @param hashValue the hash shared by every spelling of the name
+    @return the ids of the names equal to it ignoring case, empty if there are none
+    */
+    std::vector<uint32_t> findIgnoringCase(const std::string &name, uint64_t hashValue) const;
+    std::vector<uint32_t> findIgnoringCase(const std::string &name) const;
+
+    /*
+    Get the name of an id
+    @param id an id returned by intern
+    @param name the string receiving the name
+    */
+    void getName(uint32_t id, std::string &name) const;
+
+    /*
+    Get the name of an id
+    @param id an id returned by intern
+    @return the name
+    */
+    std::string getName(uint32_t id) const;
+
+    /*
+    Get the hash a name was added with
+    @param id an id returned by intern
+    @return the hash of the name
+    */
+    uint64_t getHash(uint32_t id) const;
+
+    /*
+    Get the number of distinct names
+    @return the number of names added
+    */
+    size_t size() const;
+
+    /*
+    Measure the memory held by the dictionary
+    @return the number of bytes allocated for names, ids and slots
+    */
+    size_t memoryUsage() const;
+};
+
+#endif
@@ -0,0 +1,71 @@
+/*
+    artistFilter.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include "artistFilter.h"
+
+// Constructor, the filter starts without blocks
+ArtistFilter::ArtistFilter() : blockCount(0), keyCount(0), capacity(0) {}
+
+/*
+Remove every artist and size the blocks for a number of artists
+@param expectedKeys the number of artists the filter should hold, 0 to free the blocks
+*/
+void ArtistFilter::reset(size_t expectedKeys)
+{
+    keyCount = 0;
+    capacity = expectedKeys;
+    blockCount = (expectedKeys * bitsPerKey + wordsPerBlock * 32 - 1) / (wordsPerBlock * 32);
+    words.assign(blockCount * wordsPerBlock, 0);
+    words.shrink_to_fit();
+}
+
+/*
+Add an artist to the filter
+@param hashValue the hash of the artist name, the one the dictionary stores
+*/
+void ArtistFilter::add(uint64_t hashValue)
+{
+    if (blockCount == 0)
+    {
+        return;
+    }
+    uint64_t mixed = mixBits(hashValue);
+    uint32_t *block = &words[blockOf(mixed) * wordsPerBlock];
+    uint32_t key = static_cast<uint32_t>(mixed);
+    for (size_t i = 0; i < wordsPerBlock; ++i)
+    {
+        block[i] |= bitOf(key, i);
+    }
+    keyCount++;
+}
+
+/*
+Check whether more artists were added than the blocks were sized for
+@return true if the filter should be reset with a larger size, false otherwise
+*/
+bool ArtistFilter::isOverloaded() const
+{
+    return keyCount > capacity;
+}
+
+/*
+Get the number of artists added since the last reset
+@return the number of artists added
+*/
+size_t ArtistFilter::size() const
+{
+    return keyCount;
+}
+
+/*
+Measure the memory held by the filter
+@return the number of bytes allocated for the blocks
+*/
+size_t ArtistFilter::memoryUsage() const
+{
+    return words.capacity() * sizeof(uint32_t);
+}
@@ -0,0 +1,108 @@
+#ifndef __ARTISTFILTER_H_
+#define __ARTISTFILTER_H_
+
+/*
+    artistFilter.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "hashTablePolicies.h"
+
+// ArtistFilter class definition, a split block Bloom filter over artist hashes answering "certainly absent" or "maybe present"
+// Each artist sets one bit in each of the eight 32-bit words of a single 32-byte block, so a check reads one cache line
+// Artists cannot be taken out one by one, the owner resets the filter and adds the remaining ones again instead
+// A filter with no blocks holds nothing and answers "maybe present" to everything
+// The checks are defined here so that they are inlined into the searches in front of which they sit
+class ArtistFilter
+{
+private:
+    // Member datas
+    std::vector<uint32_t> words; // Blocks of wordsPerBlock words, back to back
+    size_t blockCount;
+    size_t keyCount; // Artists added since the last reset
+    size_t capacity; // Artists the blocks were sized for
+
+    static constexpr size_t wordsPerBlock = 8;
+
+    // Method to find the block of a scrambled hash from its top half, scaling instead of dividing
+    size_t blockOf(uint64_t mixed) const
+    {
+        return static_cast<size_t>(((mixed >> 32) * blockCount) >> 32);
+    }
+
+    // Method to find the bit an artist sets in one word of its block, each word using its own odd multiplier
+    static uint32_t bitOf(uint32_t key, size_t word)
+    {
+        static constexpr uint32_t salts[wordsPerBlock] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                          0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+        return 1U << ((key * salts[word]) >> 27);
+    }
+
+public:
+    // About 0.5% of absent artists pass the filter at 16 bits per artist
+    static constexpr size_t bitsPerKey = 16;
+
+    // Constructor
+    ArtistFilter();
+
+    /*
+    Remove every artist and size the blocks for a number of artists
+    @param expectedKeys the number of artists the filter should hold, 0 to free the blocks
+    */
+    void reset(size_t expectedKeys);
+
+    /*
+    Add an artist to the filter
+    @param hashValue the hash of the artist name, the one the dictionary stores
+    */
+    void add(uint64_t hashValue);
+
+    /*
+    Check whether an artist may have been added
+    The hashes of the dictionary spread their low bits poorly, so they are scrambled first
+    @param hashValue the hash of the artist name
+    @return false if the artist was certainly not added, true if it may have been
+    */
+    bool mayContain(uint64_t hashValue) const
+    {
+        if (blockCount == 0)
+        {
+            return true;
+        }
+        uint64_t mixed = mixBits(hashValue);
+        const uint32_t *block = &words[blockOf(mixed) * wordsPerBlock];
+        uint32_t key = static_cast<uint32_t>(mixed);
+        uint32_t missing = 0;
+        for (size_t i = 0; i < wordsPerBlock; ++i)
+        {
+            missing |= ~block[i] & bitOf(key, i);
+        }
+        return missing == 0;
+    }
+
+    /*
+    Check whether more artists were added than the blocks were sized for
+    @return true if the filter should be reset with a larger size, false otherwise
+    */
+    bool isOverloaded() const;
+
+    /*
+    Get the number of artists added since the last reset
+    @return the number of artists added
+    */
+    size_t size() const;
+
+    /*
+    Measure the memory held by the filter
+    @return the number of bytes allocated for the blocks
+    */
+    size_t memoryUsage() const;
+};
+
+#endif
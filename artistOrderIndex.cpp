@@ -0,0 +1,301 @@
+/*
+    artistOrderIndex.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <algorithm>
+#include "artistOrderIndex.h"
+
+// Constructor, no artist is kept at first
+ArtistOrderIndex::ArtistOrderIndex() : rowCount(0) {}
+
+/*
+Cut sorted rows into half full blocks, leaving room for later rows
+@param rows the rows in order
+@return the blocks of rows
+*/
+template <typename Row>
+std::vector<std::vector<Row>> ArtistOrderIndex::makeBlocks(const std::vector<Row> &rows)
+{
+    std::vector<std::vector<Row>> blocks;
+    for (size_t first = 0; first < rows.size(); first += maxBlockRows / 2)
+    {
+        blocks.emplace_back(rows.begin() + first, rows.begin() + std::min(rows.size(), first + maxBlockRows / 2));
+    }
+    return blocks;
+}
+
+/*
+Add a row in its place, splitting its block once it holds more than maxBlockRows rows
+@param blocks the blocks of rows in order
+@param row the row to add
+@param less the order of the rows
+*/
+template <typename Row, typename Less>
+void ArtistOrderIndex::insertRow(std::vector<std::vector<Row>> &blocks, const Row &row, const Less &less)
+{
+    if (blocks.empty())
+    {
+        blocks.emplace_back(1, row);
+        return;
+    }
+
+    // The first block whose last row is not before the row, or the last block for a row after every other
+    auto block = std::lower_bound(blocks.begin(), blocks.end(), row, [&less](const std::vector<Row> &rows, const Row &value)
+                                  { return less(rows.back(), value); });
+    if (block == blocks.end())
+    {
+        --block;
+    }
+    block->insert(std::upper_bound(block->begin(), block->end(), row, less), row);
+    if (block->size() > maxBlockRows)
+    {
+        std::vector<Row> upper(block->begin() + block->size() / 2, block->end());
+        block->resize(block->size() / 2);
+        blocks.insert(block + 1, std::move(upper));
+    }
+}
+
+/*
+Remove a row, dropping its block once empty or joining it with the next one when both are small
+@param blocks the blocks of rows in order
+@param row the row to remove
+@param less the order of the rows
+@return true if the row was found and removed, false otherwise
+*/
+template <typename Row, typename Less>
+bool ArtistOrderIndex::eraseRow(std::vector<std::vector<Row>> &blocks, const Row &row, const Less &less)
+{
+    auto block = std::lower_bound(blocks.begin(), blocks.end(), row, [&less](const std::vector<Row> &rows, const Row &value)
+                                  { return less(rows.back(), value); });
+    if (block == blocks.end())
+    {
+        return false;
+    }
+    auto position = std::lower_bound(block->begin(), block->end(), row, less);
+    if (position == block->end() || less(row, *position))
+    {
+        return false;
+    }
+    block->erase(position);
+
+    if (block->empty())
+    {
+        blocks.erase(block);
+    }
+    else if (block + 1 != blocks.end() && block->size() + (block + 1)->size() <= maxBlockRows / 2)
+    {
+        block->insert(block->end(), (block + 1)->begin(), (block + 1)->end());
+        blocks.erase(block + 1);
+    }
+    return true;
+}
+
+/*
+Keep the tracks of an artist sorted from now on, replacing any rows it had
+@param key the folded artist name
+@param ids the ids of every track of the artist, in any order
+@param durations the duration and id of every track of the artist, in any order
+@param titleLess the order of the ids by title
+*/
+void ArtistOrderIndex::build(const std::string &key, std::vector<uint32_t> ids, std::vector<std::pair<int, uint32_t>> durations,
+                             const TitleLess &titleLess)
+{
+    std::sort(ids.begin(), ids.end(), titleLess);
+    std::sort(durations.begin(), durations.end());
+
+    ArtistOrder &order = orders[key];
+    rowCount -= order.rows;
+    order.byTitle = makeBlocks(ids);
+    order.byDuration = makeBlocks(durations);
+    order.rows = ids.size();
+    rowCount += order.rows;
+}
+
+/*
+Add a track in its place if its artist is kept, nothing otherwise
+@param key the folded artist name
+@param id the id of the track
+@param duration the duration of the track in seconds
+@param titleLess the order of the ids by title
+*/
+void ArtistOrderIndex::add(const std::string &key, uint32_t id, int duration, const TitleLess &titleLess)
+{
+    std::unordered_map<std::string, ArtistOrder>::iterator found = orders.find(key);
+    if (found == orders.end())
+    {
+        return;
+    }
+    ArtistOrder &order = found->second;
+    insertRow(order.byTitle, id, titleLess);
+    insertRow(order.byDuration, std::pair<int, uint32_t>(duration, id), std::less<std::pair<int, uint32_t>>());
+    order.rows++;
+    rowCount++;
+}
+
+/*
+Remove a track if its artist is kept, nothing otherwise
+An artist left without tracks stops being kept
+@param key the folded artist name
+@param id the id of the track, whose title must still be ordered by titleLess
+@param duration the duration the track was added with
+@param titleLess the order of the ids by title
+*/
+void ArtistOrderIndex::remove(const std::string &key, uint32_t id, int duration, const TitleLess &titleLess)
+{
+    std::unordered_map<std::string, ArtistOrder>::iterator found = orders.find(key);
+    if (found == orders.end())
+    {
+        return;
+    }
+    ArtistOrder &order = found->second;
+    if (!eraseRow(order.byTitle, id, titleLess))
+    {
+        return;
+    }
+    eraseRow(order.byDuration, std::pair<int, uint32_t>(duration, id), std::less<std::pair<int, uint32_t>>());
+    order.rows--;
+    rowCount--;
+
+    if (order.rows == 0)
+    {
+        orders.erase(found);
+    }
+}
+
+/*
+Check whether the tracks of an artist are kept sorted
+@param key the folded artist name
+@return true if the artist was built and still has tracks, false otherwise
+*/
+bool ArtistOrderIndex::contains(const std::string &key) const
+{
+    return orders.count(key) != 0;
+}
+
+/*
+Count the tracks of a kept artist
+@param key the folded artist name
+@return the number of tracks of the artist, 0 if it is not kept
+*/
+size_t ArtistOrderIndex::count(const std::string &key) const
+{
+    std::unordered_map<std::string, ArtistOrder>::const_iterator found = orders.find(key);
+    return found == orders.end() ? 0 : found->second.rows;
+}
+
+/*
+Read a page of the tracks of a kept artist
+Whole blocks before the offset are skipped by their size
+@param key the folded artist name
+@param order the order of the tracks
+@param offset the number of tracks to skip
+@param limit the largest number of tracks to return
+@return the ids of the tracks of the page, empty if the artist is not kept or the offset is past its tracks
+*/
+std::vector<uint32_t> ArtistOrderIndex::page(const std::string &key, TrackOrder order, size_t offset, size_t limit) const
+{
+    std::vector<uint32_t> ids;
+    std::unordered_map<std::string, ArtistOrder>::const_iterator found = orders.find(key);
+    if (found == orders.end() || offset >= found->second.rows)
+    {
+        return ids;
+    }
+    ids.reserve(std::min(limit, found->second.rows - offset));
+    auto readRows = [&](const auto &blocks, auto idOf)
+    {
+        size_t skipped = 0;
+        for (const auto &block : blocks)
+        {
+            if (ids.size() == limit)
+            {
+                break;
+            }
+            if (skipped + block.size() <= offset)
+            {
+                skipped += block.size();
+                continue;
+            }
+            for (size_t row = offset > skipped ? offset - skipped : 0; row < block.size() && ids.size() < limit; ++row)
+            {
+                ids.push_back(idOf(block[row]));
+            }
+            skipped += block.size();
+        }
+    };
+    if (order == TrackOrder::Title)
+    {
+        readRows(found->second.byTitle, [](uint32_t id)
+                 { return id; });
+    }
+    else
+    {
+        readRows(found->second.byDuration, [](const std::pair<int, uint32_t> &row)
+                 { return row.second; });
+    }
+    return ids;
+}
+
+/*
+Give every track a new id
+New ids keep the order of the old ones, so the rows stay sorted where they are
+@param newIds the new id by old id, increasing over the ids of the tracks kept
+*/
+void ArtistOrderIndex::remapIds(const std::vector<uint32_t> &newIds)
+{
+    for (std::pair<const std::string, ArtistOrder> &entry : orders)
+    {
+        for (std::vector<uint32_t> &block : entry.second.byTitle)
+        {
+            for (uint32_t &id : block)
+            {
+                id = newIds[id];
+            }
+        }
+        for (std::vector<std::pair<int, uint32_t>> &block : entry.second.byDuration)
+        {
+            for (std::pair<int, uint32_t> &row : block)
+            {
+                row.second = newIds[row.second];
+            }
+        }
+    }
+}
+
+/*
+Stop keeping every artist
+*/
+void ArtistOrderIndex::clear()
+{
+    orders.clear();
+    rowCount = 0;
+}
+
+/*
+Check whether no artist is kept, so that updates can be skipped
+@return true if no artist is kept, false otherwise
+*/
+bool ArtistOrderIndex::isEmpty() const
+{
+    return orders.empty();
+}
+
+/*
+Get the number of artists kept
+@return the number of artists kept sorted
+*/
+size_t ArtistOrderIndex::artistCount() const
+{
+    return orders.size();
+}
+
+/*
+Get the number of tracks kept
+@return the number of tracks over every kept artist
+*/
+size_t ArtistOrderIndex::size() const
+{
+    return rowCount;
+}
@@ -0,0 +1,152 @@
+#ifndef __ARTISTORDERINDEX_H_
+#define __ARTISTORDERINDEX_H_
+
+/*
+    artistOrderIndex.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// TrackOrder enum lists the orders the tracks of an artist can be paged in
+enum class TrackOrder
+{
+    Title,
+    Duration
+};
+
+// ArtistOrderIndex class definition, the tracks of chosen artists kept sorted by title and by duration
+// An artist is only kept once it is built, later tracks of the artist are then added in place
+// so that a page of its tracks is read straight from the sorted rows
+// Rows are held in blocks of a bounded size, so a change moves the rows of a single block
+// Titles are not copied, the table storing them orders ids by title through the TitleLess it passes in
+class ArtistOrderIndex
+{
+public:
+    // Strict order of track ids by folded title, then by id for equal titles
+    using TitleLess = std::function<bool(uint32_t, uint32_t)>;
+
+private:
+    // ArtistOrder struct holds the track ids of one artist twice, by folded title then id and by duration then id
+    struct ArtistOrder
+    {
+        std::vector<std::vector<uint32_t>> byTitle;
+        std::vector<std::vector<std::pair<int, uint32_t>>> byDuration;
+        size_t rows = 0;
+    };
+
+    // Member datas
+    std::unordered_map<std::string, ArtistOrder> orders; // By folded artist name
+    size_t rowCount;                                     // Tracks kept over every artist
+
+    // A block holding more rows than this is split in two
+    static constexpr size_t maxBlockRows = 512;
+
+    // Method to cut sorted rows into half full blocks
+    template <typename Row>
+    static std::vector<std::vector<Row>> makeBlocks(const std::vector<Row> &rows);
+
+    // Method to add a row in its place, splitting its block when full
+    template <typename Row, typename Less>
+    static void insertRow(std::vector<std::vector<Row>> &blocks, const Row &row, const Less &less);
+
+    // Method to remove a row, joining its block with the next one when both are small
+    template <typename Row, typename Less>
+    static bool eraseRow(std::vector<std::vector<Row>> &blocks, const Row &row, const Less &less);
+
+public:
+    // Constructor
+    ArtistOrderIndex();
+
+    /*
+    Keep the tracks of an artist sorted from now on, replacing any rows it had
+    @param key the folded artist name
+    @param ids the ids of every track of the artist, in any order
+    @param durations the duration and id of every track of the artist, in any order
+    @param titleLess the order of the ids by title
+    */
+    void build(const std::string &key, std::vector<uint32_t> ids, std::vector<std::pair<int, uint32_t>> durations,
+               const TitleLess &titleLess);
+
+    /*
+    Add a track in its place if its artist is kept, nothing otherwise
+    @param key the folded artist name
+    @param id the id of the track
+    @param duration the duration of the track in seconds
+    @param titleLess the order of the ids by title
+    */
+    void add(const std::string &key, uint32_t id, int duration, const TitleLess &titleLess);
+
+    /*
+    Remove a track if its artist is kept, nothing otherwise
+    An artist left without tracks stops being kept
+    @param key the folded artist name
+    @param id the id of the track, whose title must still be ordered by titleLess
+    @param duration the duration the track was added with
+    @param titleLess the order of the ids by title
+    */
+    void remove(const std::string &key, uint32_t id, int duration, const TitleLess &titleLess);
+
+    /*
+    Check whether the tracks of an artist are kept sorted
+    @param key the folded artist name
+    @return true if the artist was built and still has tracks, false otherwise
+    */
+    bool contains(const std::string &key) const;
+
+    /*
+    Count the tracks of a kept artist
+    @param key the folded artist name
+    @return the number of tracks of the artist, 0 if it is not kept
+    */
+    size_t count(const std::string &key) const;
+
+    /*
+    Read a page of the tracks of a kept artist
+    @param key the folded artist name
+    @param order the order of the tracks
+    @param offset the number of tracks to skip
+    @param limit the largest number of tracks to return
+    @return the ids of the tracks of the page, empty if the artist is not kept or the offset is past its tracks
+    */
+    std::vector<uint32_t> page(const std::string &key, TrackOrder order, size_t offset, size_t limit) const;
+
+    /*
+    Give every track a new id
+    @param newIds the new id by old id, increasing over the ids of the tracks kept
+    */
+    void remapIds(const std::vector<uint32_t> &newIds);
+
+    /*
+    Stop keeping every artist
+    */
+    void clear();
+
+    /*
+    Check whether no artist is kept, so that updates can be skipped
+    @return true if no artist is kept, false otherwise
+    */
+    bool isEmpty() const;
+
+    /*
+    Get the number of artists kept
+    @return the number of artists kept sorted
+    */
+    size_t artistCount() const;
+
+    /*
+    Get the number of tracks kept
+    @return the number of tracks over every kept artist
+    */
+    size_t size() const;
+};
+
+#endif
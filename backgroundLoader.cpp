@@ -0,0 +1,147 @@
+/*
+    backgroundLoader.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <vector>
+
+#include "backgroundLoader.h"
+#include "lineReader.h"
+#include "trackIO.h"
+
+/*
+Constructor
+@param hashTable the HashTable object receiving the tracks
+@param tableMutex the mutex every other user of the hash table holds while using it
+*/
+BackgroundLoader::BackgroundLoader(HashTable &hashTable, std::mutex &tableMutex)
+    : hashTable(hashTable), tableMutex(tableMutex), cancelRequested(false), state(LoadState::Idle),
+      rowsParsed(0), rowsInserted(0), warnings(0), duplicates(0) {}
+
+// Destructor, cancels a running load
+BackgroundLoader::~BackgroundLoader()
+{
+    cancel();
+    wait();
+}
+
+/*
+Start loading a file unless a load is already running
+@param fileName the name of the file containing the tracks
+@return true if the load started, false otherwise
+*/
+bool BackgroundLoader::start(const std::string &fileName)
+{
+    if (isRunning())
+    {
+        return false;
+    }
+    wait();
+
+    // The worker is joined, so nothing else touches these until the new one starts
+    this->fileName = fileName;
+    cancelRequested = false;
+    rowsParsed = 0;
+    rowsInserted = 0;
+    warnings = 0;
+    duplicates = 0;
+    state = LoadState::Running;
+    worker = std::thread(&BackgroundLoader::run, this);
+    return true;
+}
+
+/*
+Ask a running load to stop after the current chunk, tracks already inserted stay
+*/
+void BackgroundLoader::cancel()
+{
+    cancelRequested = true;
+}
+
+/*
+Wait for the current load to end
+*/
+void BackgroundLoader::wait()
+{
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+/*
+Check whether a load is running
+@return true if a load is running, false otherwise
+*/
+bool BackgroundLoader::isRunning() const
+{
+    return state == LoadState::Running;
+}
+
+/*
+Take a snapshot of the current or last load
+@return the progress of the load
+*/
+LoadProgress BackgroundLoader::getProgress() const
+{
+    // fileName only changes in start, which never runs concurrently with the menu asking for progress
+    return LoadProgress{fileName, state, rowsParsed, rowsInserted, warnings, duplicates};
+}
+
+/*
+Parse the file and insert its tracks chunk by chunk, run by the worker thread
+*/
+void BackgroundLoader::run()
+{
+    LineReader inputFile(fileName);
+    if (!inputFile.isOpen())
+    {
+        state = LoadState::Failed;
+        return;
+    }
+
+    std::vector<Track> chunk;
+    chunk.reserve(chunkSize);
+    std::string line;
+    int lineNumber = 0;
+    bool endOfFile = false;
+    while (!endOfFile)
+    {
+        // Parse without the lock so the table stays usable for most of the load
+        chunk.clear();
+        while (chunk.size() < chunkSize && !(endOfFile = !inputFile.readLine(line)))
+        {
+            lineNumber++;
+            if (!parseTrackLine(line, lineNumber, chunk, nullptr))
+            {
+                warnings++;
+            }
+            rowsParsed++;
+        }
+        if (cancelRequested)
+        {
+            state = LoadState::Cancelled;
+            return;
+        }
+        if (chunk.empty())
+        {
+            continue;
+        }
+
+        size_t inserted;
+        {
+            std::lock_guard<std::mutex> lock(tableMutex);
+            inserted = hashTable.insertMany(chunk, false);
+        }
+        rowsInserted += inserted;
+        duplicates += chunk.size() - inserted;
+    }
+
+    if (inputFile.isCorrupt())
+    {
+        warnings++;
+    }
+    state = LoadState::Finished;
+}
@@ -0,0 +1,108 @@
+#ifndef __BACKGROUNDLOADER_H_
+#define __BACKGROUNDLOADER_H_
+
+/*
+    backgroundLoader.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "hashTable.h"
+
+// LoadState enum lists the states of a background load
+enum class LoadState
+{
+    Idle,
+    Running,
+    Finished,
+    Cancelled,
+    Failed
+};
+
+// LoadProgress struct is a snapshot of a background load
+struct LoadProgress
+{
+    std::string fileName;
+    LoadState state;
+    uint64_t rowsParsed;
+    uint64_t rowsInserted;
+    uint64_t warnings;   // Rows skipped for an invalid duration, plus one for damaged compressed data
+    uint64_t duplicates; // Rows skipped as already in the library
+};
+
+// BackgroundLoader class definition, loads a track file on a worker thread while the table stays usable
+class BackgroundLoader
+{
+private:
+    // Member datas
+    HashTable &hashTable;
+    std::mutex &tableMutex; // Held by the worker only while it inserts a chunk
+    std::thread worker;
+    std::string fileName;
+    std::atomic<bool> cancelRequested;
+    std::atomic<LoadState> state;
+    std::atomic<uint64_t> rowsParsed;
+    std::atomic<uint64_t> rowsInserted;
+    std::atomic<uint64_t> warnings;
+    std::atomic<uint64_t> duplicates;
+
+    /*
+    Parse the file and insert its tracks chunk by chunk, run by the worker thread
+    */
+    void run();
+
+public:
+    // Rows parsed before they are inserted, each chunk becomes visible at once
+    static const size_t chunkSize = 4096;
+
+    /*
+    Constructor
+    @param hashTable the HashTable object receiving the tracks
+    @param tableMutex the mutex every other user of the hash table holds while using it
+    */
+    BackgroundLoader(HashTable &hashTable, std::mutex &tableMutex);
+
+    // Destructor, cancels a running load
+    ~BackgroundLoader();
+
+    BackgroundLoader(const BackgroundLoader &) = delete;
+    BackgroundLoader &operator=(const BackgroundLoader &) = delete;
+
+    /*
+    Start loading a file unless a load is already running
+    @param fileName the name of the file containing the tracks
+    @return true if the load started, false otherwise
+    */
+    bool start(const std::string &fileName);
+
+    /*
+    Ask a running load to stop after the current chunk, tracks already inserted stay
+    */
+    void cancel();
+
+    /*
+    Wait for the current load to end
+    */
+    void wait();
+
+    /*
+    Check whether a load is running
+    @return true if a load is running, false otherwise
+    */
+    bool isRunning() const;
+
+    /*
+    Take a snapshot of the current or last load
+    @return the progress of the load
+    */
+    LoadProgress getProgress() const;
+};
+
+#endif
@@ -0,0 +1,219 @@
+/*
+    batchMode.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated: 19/10/26
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "batchMode.h"
+#include "fileIngest.h"
+#include "frozenCatalog.h"
+#include "latencyHistogram.h"
+#include "sharedCatalog.h"
+#include "trackIO.h"
+
+/*
+Split a line on tabs
+@param line the line to split
+@return the fields of the line
+*/
+static std::vector<std::string> splitFields(const std::string &line)
+{
+    std::vector<std::string> fields;
+    size_t start = 0;
+    size_t tab;
+    while ((tab = line.find('\t', start)) != std::string::npos)
+    {
+        fields.push_back(line.substr(start, tab - start));
+        start = tab + 1;
+    }
+    fields.push_back(line.substr(start));
+    return fields;
+}
+
+/*
+Run tab separated commands against the hash table without any prompt
+@param hashTable the HashTable object storing the tracks
+@param input the stream to read the commands from
+@param output the stream to write the results to
+@return the number of commands run and of commands answered with ERR
+*/
+BatchSummary runBatch(HashTable &hashTable, std::istream &input, std::ostream &output)
+{
+    BatchSummary summary = {0, 0};
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(input, line))
+    {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        summary.commands++;
+        std::vector<std::string> fields = splitFields(line);
+        const std::string &command = fields[0];
+        bool failed = false;
+
+        if ((command == "search" || command == "count") && fields.size() == 2)
+        {
+            std::shared_ptr<const std::vector<Track>> foundTracks = hashTable.searchShared(fields[1]);
+            output << "OK\t" << foundTracks->size() << '\n';
+            if (command == "search")
+            {
+                for (const Track &track : *foundTracks)
+                {
+                    output << track.getTitle() << '\t' << track.getArtist() << '\t' << track.getDuration() << '\n';
+                }
+            }
+        }
+        else if (command == "page" && fields.size() == 5 && (fields[2] == "title" || fields[2] == "duration"))
+        {
+            size_t offset, limit;
+            try
+            {
+                offset = std::stoul(fields[3]);
+                limit = std::stoul(fields[4]);
+            }
+            catch (const std::logic_error &ex)
+            {
+                output << "ERR\tinvalid offset or limit on line " << lineNumber << '\n';
+                summary.failures++;
+                continue;
+            }
+
+            TrackOrder order = fields[2] == "title" ? TrackOrder::Title : TrackOrder::Duration;
+            TrackPage page = hashTable.searchPage(fields[1], order, offset, limit);
+            output << "OK\t" << page.tracks.size() << '\t' << page.totalTracks << '\n';
+            for (const Track &track : page.tracks)
+            {
+                output << track.getTitle() << '\t' << track.getArtist() << '\t' << track.getDuration() << '\n';
+            }
+        }
+        else if (command == "add" && fields.size() == 4)
+        {
+            int duration;
+            try
+            {
+                duration = std::stoi(fields[3]);
+            }
+            catch (const std::logic_error &ex)
+            {
+                output << "ERR\tinvalid duration " << fields[3] << '\n';
+                summary.failures++;
+                continue;
+            }
+
+            // The hash table reports duplicates on std::cerr, the size tells whether the track went in
+            size_t sizeBefore = hashTable.size();
+            hashTable.insert(Track(lineNumber, fields[1], fields[2], duration));
+            if (hashTable.size() > sizeBefore)
+            {
+                output << "OK\n";
+            }
+            else
+            {
+                output << "DUPLICATE\n";
+            }
+        }
+        else if (command == "remove" && fields.size() == 3)
+        {
+            if (hashTable.remove(fields[1], fields[2]))
+            {
+                output << "OK\n";
+            }
+            else
+            {
+                output << "NOT_FOUND\n";
+            }
+        }
+        else if (command == "load" && fields.size() == 2)
+        {
+            std::vector<Track> tracks = loadTracksFromFile(fields[1]);
+            if (tracks.empty())
+            {
+                output << "ERR\tno tracks loaded from " << fields[1] << '\n';
+                failed = true;
+            }
+            else
+            {
+                output << "OK\t" << hashTable.insertMany(tracks) << '\n';
+            }
+        }
+        else if (command == "ingest" && fields.size() >= 2)
+        {
+            std::vector<std::string> fileNames(fields.begin() + 1, fields.end());
+            output << "OK\t" << ingestFiles(hashTable, fileNames).inserted << '\n';
+        }
+        else if (command == "save" && fields.size() == 2)
+        {
+            // A .gz name asks for a gzip compressed snapshot
+            const std::string &fileName = fields[1];
+            bool gzipped = fileName.size() > 3 && fileName.compare(fileName.size() - 3, 3, ".gz") == 0;
+            if (writeTracksToFile(hashTable, fileName, gzipped ? Compression::Gzip : Compression::None))
+            {
+                output << "OK\t" << hashTable.size() << '\n';
+            }
+            else
+            {
+                output << "ERR\tcould not write " << fields[1] << '\n';
+                failed = true;
+            }
+        }
+        else if (command == "publish" && fields.size() == 2)
+        {
+            uint64_t version = publishSharedCatalog(hashTable, fields[1]);
+            if (version != 0)
+            {
+                output << "OK\t" << version << '\n';
+            }
+            else
+            {
+                output << "ERR\tcould not publish " << fields[1] << '\n';
+                failed = true;
+            }
+        }
+        else if (command == "freeze" && fields.size() == 2)
+        {
+            if (saveFrozenCatalog(hashTable, fields[1]))
+            {
+                output << "OK\t" << hashTable.size() << '\n';
+            }
+            else
+            {
+                output << "ERR\tcould not freeze " << fields[1] << '\n';
+                failed = true;
+            }
+        }
+        else if (command == "stats" && fields.size() == 1)
+        {
+            hashTable.writeStats(output);
+        }
+        else if (command == "latency" && fields.size() == 1)
+        {
+            writeLatencyReport(output);
+        }
+        else
+        {
+            output << "ERR\tinvalid command on line " << lineNumber << '\n';
+            failed = true;
+        }
+
+        if (failed)
+        {
+            summary.failures++;
+        }
+    }
+
+    output.flush();
+    return summary;
+}
@@ -0,0 +1,45 @@
+#ifndef __BATCHMODE_H_
+#define __BATCHMODE_H_
+
+/*
+    batchMode.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <istream>
+#include <ostream>
+
+#include "hashTable.h"
+
+// BatchSummary struct counts the commands run by a batch and the ones answered with ERR
+struct BatchSummary
+{
+    size_t commands;
+    size_t failures;
+};
+
+/*
+Run tab separated commands against the hash table without any prompt, one line per command:
+    search <artist>                  OK <n>, followed by n lines of title, artist and duration
+    count <artist>                   OK <n>
+    page <artist> <order> <off> <n>  OK <returned> <total>, then the tracks ordered by title or duration
+    add <title> <artist> <duration>  OK, DUPLICATE or ERR <reason>
+    remove <title> <artist>          OK or NOT_FOUND
+    load <file>                      OK <tracks added> or ERR <reason>
+    ingest <file> <file>...          OK <tracks added>, files that cannot be read add nothing
+    save <file>                      OK <tracks saved> or ERR <reason>, a .gz name writes gzip
+    publish <shared catalog name>    OK <version> or ERR <reason>
+    freeze <file>                    OK <tracks frozen> or ERR <reason>
+    stats                            the hash table statistics as JSON
+    latency                          the operation latency percentiles as JSON
+Empty lines and lines starting with # are skipped
+@param hashTable the HashTable object storing the tracks
+@param input the stream to read the commands from
+@param output the stream to write the results to
+@return the number of commands run and of commands answered with ERR
+*/
+BatchSummary runBatch(HashTable &hashTable, std::istream &input, std::ostream &output);
+
+#endif
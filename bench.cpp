@@ -0,0 +1,378 @@
+/*
+    bench.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "track.h"
+#include "hashTable.h"
+#include "trackIO.h"
+#include "frozenCatalog.h"
+#include "catalogGenerator.h"
+
+// Silence the loader and duplicate messages printed to std::cerr while a benchmark runs
+class SilenceErrors
+{
+private:
+    std::streambuf *previous;
+
+public:
+    SilenceErrors() : previous(std::cerr.rdbuf(nullptr)) {}
+    ~SilenceErrors()
+    {
+        std::cerr.rdbuf(previous);
+        std::cerr.clear();
+    }
+};
+
+/*
+Generate distinct tracks, about ten per artist
+@param count the number of tracks to generate
+@param seed the seed of the random generator
+@return the generated tracks
+*/
+static std::vector<Track> makeSyntheticTracks(size_t count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    size_t artistCount = std::max<size_t>(1, count / 10);
+    std::vector<Track> tracks;
+    tracks.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        tracks.emplace_back(static_cast<int>(i + 1),
+                            "Track " + std::to_string(i),
+                            "Artist " + std::to_string(rng() % artistCount),
+                            static_cast<int>(60 + rng() % 480));
+    }
+    return tracks;
+}
+
+/*
+Build a hash table holding synthetic tracks
+@param tracks the tracks to insert
+@param tableSize the number of buckets of the table
+@return the populated table
+*/
+template <typename Table = HashTable>
+static Table *makeTable(const std::vector<Track> &tracks, size_t tableSize)
+{
+    Table *hashTable = new Table(tableSize);
+    hashTable->insertMany(tracks);
+    return hashTable;
+}
+
+// Catalog sizes crossed with table sizes, both as powers of two
+static void catalogAndTableSizes(benchmark::internal::Benchmark *benchmark)
+{
+    benchmark->ArgNames({"tracks", "buckets"});
+    for (int64_t tracks : {1 << 10, 1 << 14, 1 << 17})
+    {
+        for (int64_t buckets : {1 << 8, 1 << 12, 1 << 16})
+        {
+            benchmark->Args({tracks, buckets});
+        }
+    }
+}
+
+// Insert tracks one at a time into an empty table
+static void BM_Insert(benchmark::State &state)
+{
+    std::vector<Track> tracks = makeSyntheticTracks(state.range(0), 1);
+    for (auto _ : state)
+    {
+        HashTable hashTable(state.range(1));
+        for (const auto &track : tracks)
+        {
+            hashTable.insert(track);
+        }
+        benchmark::DoNotOptimize(hashTable.size());
+    }
+    state.SetItemsProcessed(state.iterations() * tracks.size());
+}
+BENCHMARK(BM_Insert)->Apply(catalogAndTableSizes)->Unit(benchmark::kMillisecond);
+
+// Insert the same tracks through the bulk path
+static void BM_InsertMany(benchmark::State &state)
+{
+    std::vector<Track> tracks = makeSyntheticTracks(state.range(0), 1);
+    for (auto _ : state)
+    {
+        HashTable hashTable(state.range(1));
+        benchmark::DoNotOptimize(hashTable.insertMany(tracks));
+    }
+    state.SetItemsProcessed(state.iterations() * tracks.size());
+}
+BENCHMARK(BM_InsertMany)->Apply(catalogAndTableSizes)->Unit(benchmark::kMillisecond);
+
+// Search for artists present in the table
+static void BM_SearchHit(benchmark::State &state)
+{
+    std::vector<Track> tracks = makeSyntheticTracks(state.range(0), 1);
+    HashTable *hashTable = makeTable(tracks, state.range(1));
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(hashTable->search(tracks[next].getArtist()));
+        next = (next + 1) % tracks.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    delete hashTable;
+}
+BENCHMARK(BM_SearchHit)->Apply(catalogAndTableSizes);
+
+// Search for artists absent from the table
+static void BM_SearchMiss(benchmark::State &state)
+{
+    std::vector<Track> tracks = makeSyntheticTracks(state.range(0), 1);
+    HashTable *hashTable = makeTable(tracks, state.range(1));
+    std::vector<std::string> missingArtists;
+    for (size_t i = 0; i < 1024; ++i)
+    {
+        missingArtists.push_back("Missing Artist " + std::to_string(i));
+    }
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(hashTable->search(missingArtists[next]));
+        next = (next + 1) % missingArtists.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    delete hashTable;
+}
+BENCHMARK(BM_SearchMiss)->Apply(catalogAndTableSizes);
+
+// Search for artists drawn with a Zipf skew, as popular artists dominate real query streams, with the search cache off or on
+static void BM_SearchPopular(benchmark::State &state)
+{
+    std::vector<Track> tracks = makeSyntheticTracks(state.range(0), 1);
+    HashTable *hashTable = makeTable(tracks, tracks.size());
+    hashTable->setSearchCacheCapacity(state.range(1) ? SearchCache::defaultCapacity : 0);
+    size_t artistCount = std::max<size_t>(1, tracks.size() / 10);
+    ZipfSampler sampler(artistCount, 1.0);
+    std::mt19937_64 rng(7);
+    std::vector<std::string> queries;
+    for (size_t i = 0; i < 4096; ++i)
+    {
+        queries.push_back("Artist " + std::to_string(sampler.sample(rng) - 1));
+    }
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(hashTable->searchShared(queries[next]));
+        next = (next + 1) % queries.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    HashTableStats stats = hashTable->getStats();
+    if (stats.cacheHits + stats.cacheMisses > 0)
+    {
+        state.counters["hitRate"] = static_cast<double>(stats.cacheHits) / (stats.cacheHits + stats.cacheMisses);
+    }
+    delete hashTable;
+}
+BENCHMARK(BM_SearchPopular)->ArgNames({"tracks", "cache"})->Args({1 << 14, 0})->Args({1 << 14, 1})->Args({1 << 17, 0})->Args({1 << 17, 1});
+
+// Read a page of 20 tracks of one prolific artist sorted by title, by sorting every track found or through searchPage
+static void BM_SearchPage(benchmark::State &state)
+{
+    HashTable hashTable(1024);
+    for (int64_t i = 0; i < state.range(0); ++i)
+    {
+        hashTable.insert(Track(static_cast<int>(i + 1), "Song " + std::to_string((i * 7919) % state.range(0)), "Prolific", static_cast<int>(60 + i % 300)));
+    }
+    hashTable.setSearchCacheCapacity(0);
+    const size_t pageSize = 20;
+    size_t offset = 0;
+    for (auto _ : state)
+    {
+        if (state.range(1))
+        {
+            benchmark::DoNotOptimize(hashTable.searchPage("Prolific", TrackOrder::Title, offset, pageSize));
+        }
+        else
+        {
+            std::vector<Track> foundTracks = hashTable.search("Prolific");
+            std::sort(foundTracks.begin(), foundTracks.end(), [](const Track &lhs, const Track &rhs)
+                      { return lhs.getTitle() < rhs.getTitle(); });
+            std::vector<Track> page(foundTracks.begin() + offset, foundTracks.begin() + std::min(foundTracks.size(), offset + pageSize));
+            benchmark::DoNotOptimize(page);
+        }
+        offset = (offset + pageSize) % static_cast<size_t>(state.range(0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SearchPage)->ArgNames({"tracks", "paged"})->Args({1 << 10, 0})->Args({1 << 10, 1})->Args({1 << 14, 0})->Args({1 << 14, 1});
+
+// Search a frozen image of the table for artists it holds, one slot read per search
+static void BM_SearchFrozenHit(benchmark::State &state)
+{
+    std::vector<Track> tracks = makeSyntheticTracks(state.range(0), 1);
+    HashTable *hashTable = makeTable(tracks, tracks.size());
+    std::string image = buildFrozenCatalog(*hashTable);
+    FrozenCatalogView view(image.data(), image.size());
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(view.search(tracks[next].getArtist()));
+        next = (next + 1) % tracks.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    delete hashTable;
+}
+BENCHMARK(BM_SearchFrozenHit)->ArgName("tracks")->Arg(1 << 14)->Arg(1 << 17);
+
+// Search a frozen image of the table for artists absent from it
+static void BM_SearchFrozenMiss(benchmark::State &state)
+{
+    std::vector<Track> tracks = makeSyntheticTracks(state.range(0), 1);
+    HashTable *hashTable = makeTable(tracks, tracks.size());
+    std::string image = buildFrozenCatalog(*hashTable);
+    FrozenCatalogView view(image.data(), image.size());
+    std::vector<std::string> missingArtists;
+    for (size_t i = 0; i < 1024; ++i)
+    {
+        missingArtists.push_back("Missing Artist " + std::to_string(i));
+    }
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(view.search(missingArtists[next]));
+        next = (next + 1) % missingArtists.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    delete hashTable;
+}
+BENCHMARK(BM_SearchFrozenMiss)->ArgName("tracks")->Arg(1 << 14)->Arg(1 << 17);
+
+// Freeze a populated table into a perfect hash image
+static void BM_Freeze(benchmark::State &state)
+{
+    std::vector<Track> tracks = makeSyntheticTracks(state.range(0), 1);
+    HashTable *hashTable = makeTable(tracks, tracks.size());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(buildFrozenCatalog(*hashTable));
+    }
+    state.SetItemsProcessed(state.iterations() * tracks.size());
+    delete hashTable;
+}
+BENCHMARK(BM_Freeze)->ArgName("tracks")->Arg(1 << 14)->Arg(1 << 17)->Unit(benchmark::kMillisecond);
+
+// Find tracks by title and artist in each compiled configuration, starting from a table sized for the catalog
+template <typename Table>
+static void BM_FindConfigured(benchmark::State &state)
+{
+    std::vector<Track> tracks = makeSyntheticTracks(state.range(0), 1);
+    Table *hashTable = makeTable<Table>(tracks, state.range(0));
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(hashTable->find(tracks[next].getTitle(), tracks[next].getArtist()));
+        next = (next + 1) % tracks.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    delete hashTable;
+}
+BENCHMARK_TEMPLATE(BM_FindConfigured, HashTable)->ArgName("tracks")->Arg(1 << 14)->Arg(1 << 17);
+BENCHMARK_TEMPLATE(BM_FindConfigured, FastHashTable)->ArgName("tracks")->Arg(1 << 14)->Arg(1 << 17);
+BENCHMARK_TEMPLATE(BM_FindConfigured, CaseSensitiveHashTable)->ArgName("tracks")->Arg(1 << 14)->Arg(1 << 17);
+BENCHMARK_TEMPLATE(BM_FindConfigured, FixedHashTable)->ArgName("tracks")->Arg(1 << 14)->Arg(1 << 17);
+
+// Remove every track of a populated table in random order
+static void BM_Remove(benchmark::State &state)
+{
+    std::vector<Track> tracks = makeSyntheticTracks(state.range(0), 1);
+    std::vector<Track> removalOrder = tracks;
+    std::shuffle(removalOrder.begin(), removalOrder.end(), std::mt19937(2));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        HashTable *hashTable = makeTable(tracks, state.range(1));
+        state.ResumeTiming();
+        for (const auto &track : removalOrder)
+        {
+            benchmark::DoNotOptimize(hashTable->remove(track.getTitle(), track.getArtist()));
+        }
+        state.PauseTiming();
+        delete hashTable;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * tracks.size());
+}
+BENCHMARK(BM_Remove)->Apply(catalogAndTableSizes)->Unit(benchmark::kMillisecond);
+
+// Copy every track out of the table
+static void BM_GetAllTracks(benchmark::State &state)
+{
+    std::vector<Track> tracks = makeSyntheticTracks(state.range(0), 1);
+    HashTable *hashTable = makeTable(tracks, state.range(1));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(hashTable->getAllTracks());
+    }
+    state.SetItemsProcessed(state.iterations() * tracks.size());
+    delete hashTable;
+}
+BENCHMARK(BM_GetAllTracks)->Apply(catalogAndTableSizes)->Unit(benchmark::kMillisecond);
+
+// Parse the sample catalog shipped with the project
+static void BM_LoadSampleFile(benchmark::State &state)
+{
+    SilenceErrors silence;
+    if (loadTracksFromFile("sample.txt").empty())
+    {
+        state.SkipWithError("sample.txt not found, run the benchmark from the project directory");
+        return;
+    }
+    size_t loaded = 0;
+    for (auto _ : state)
+    {
+        std::vector<Track> tracks = loadTracksFromFile("sample.txt");
+        loaded = tracks.size();
+    }
+    state.SetItemsProcessed(state.iterations() * loaded);
+}
+BENCHMARK(BM_LoadSampleFile)->Unit(benchmark::kMillisecond);
+
+// Parse a synthetic catalog written by the save path
+static void BM_LoadSyntheticFile(benchmark::State &state)
+{
+    std::string fileName = "bench_load_" + std::to_string(state.range(0)) + ".txt";
+    HashTable *hashTable = makeTable(makeSyntheticTracks(state.range(0), 1), state.range(0));
+    writeTracksToFile(*hashTable, fileName);
+    delete hashTable;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(loadTracksFromFile(fileName));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(fileName.c_str());
+}
+BENCHMARK(BM_LoadSyntheticFile)->ArgName("tracks")->Arg(1 << 14)->Arg(1 << 17)->Unit(benchmark::kMillisecond);
+
+// Write every track of a populated table to a file
+static void BM_SaveTracksToFile(benchmark::State &state)
+{
+    std::string fileName = "bench_save_" + std::to_string(state.range(0)) + ".txt";
+    HashTable *hashTable = makeTable(makeSyntheticTracks(state.range(0), 1), state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(writeTracksToFile(*hashTable, fileName));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(fileName.c_str());
+    delete hashTable;
+}
+BENCHMARK(BM_SaveTracksToFile)->ArgName("tracks")->Arg(1 << 14)->Arg(1 << 17)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
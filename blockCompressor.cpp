@@ -0,0 +1,202 @@
+/*
+    blockCompressor.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <algorithm>
+#include <zlib.h>
+
+#include "blockCompressor.h"
+
+/*
+Compress data held in memory into a single gzip member
+@param data the bytes to compress
+@param size the number of bytes
+@param output the string receiving the compressed bytes
+@param level the zlib compression level, from 1 (fastest) to 9 (smallest)
+@return true if successful, false otherwise
+*/
+bool compressGzip(const char *data, size_t size, std::string &output, int level)
+{
+    z_stream stream = z_stream();
+
+    // windowBits of 15 + 16 writes a gzip header and trailer instead of a zlib one
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return false;
+    }
+
+    // deflateBound leaves room for the whole member, so a single call finishes it
+    output.resize(deflateBound(&stream, size));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = reinterpret_cast<Bytef *>(&output[0]);
+    stream.avail_out = static_cast<uInt>(output.size());
+    int status = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    return status == Z_STREAM_END;
+}
+
+/*
+Constructor, starts the compressing threads
+@param output the stream receiving the gzip file
+@param level the zlib compression level, from 1 (fastest) to 9 (smallest)
+@param threadCount the number of compressing threads, 0 for one per core
+@param blockSize the number of bytes compressed into each member
+*/
+BlockCompressor::BlockCompressor(std::ostream &output, int level, size_t threadCount, size_t blockSize)
+    : output(output), level(level), blockSize(std::max<size_t>(blockSize, 1)), failed(false),
+      nextSubmitted(0), nextWritten(0), stopRequested(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Two blocks per thread keep every thread busy while the previous results are written
+    maxInFlight = threadCount * 2;
+    pending.reserve(this->blockSize);
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&BlockCompressor::work, this);
+    }
+}
+
+// Destructor, finishes the output if finish was not called
+BlockCompressor::~BlockCompressor()
+{
+    finish();
+}
+
+/*
+Compress blocks until asked to stop, run by each compressing thread
+*/
+void BlockCompressor::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        changed.wait(lock, [this]
+                     { return stopRequested || !jobs.empty(); });
+        if (jobs.empty())
+        {
+            return;
+        }
+
+        std::pair<size_t, std::string> job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+
+        std::string compressed;
+        bool compressedOk = compressGzip(job.second.data(), job.second.size(), compressed, level);
+
+        lock.lock();
+        if (!compressedOk)
+        {
+            failed = true;
+        }
+        results[job.first] = std::move(compressed);
+        changed.notify_all();
+    }
+}
+
+/*
+Hand the pending bytes to the compressing threads as one block
+*/
+void BlockCompressor::submitPending()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Make room first so the bytes held stay bounded however fast the data comes
+    writeCompleted(lock, maxInFlight - 1);
+    jobs.emplace_back(nextSubmitted++, std::move(pending));
+    changed.notify_all();
+    lock.unlock();
+
+    pending = std::string();
+    pending.reserve(blockSize);
+}
+
+/*
+Write the compressed blocks that are next in order, waiting until no more than a given number remain
+@param lock the lock held on mutex
+@param remaining the number of blocks allowed to stay in flight
+*/
+void BlockCompressor::writeCompleted(std::unique_lock<std::mutex> &lock, size_t remaining)
+{
+    while (true)
+    {
+        std::map<size_t, std::string>::iterator next = results.find(nextWritten);
+        if (next != results.end())
+        {
+            // Write without the lock so the compressing threads carry on meanwhile
+            std::string compressed = std::move(next->second);
+            results.erase(next);
+            lock.unlock();
+            output.write(compressed.data(), compressed.size());
+            lock.lock();
+            nextWritten++;
+            continue;
+        }
+        if (nextSubmitted - nextWritten <= remaining)
+        {
+            return;
+        }
+        changed.wait(lock);
+    }
+}
+
+/*
+Append bytes to the output, full blocks are compressed in the background
+@param data the bytes to append
+@param size the number of bytes
+*/
+void BlockCompressor::write(const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        size_t taken = std::min(size, blockSize - pending.size());
+        pending.append(data, taken);
+        data += taken;
+        size -= taken;
+        if (pending.size() == blockSize)
+        {
+            submitPending();
+        }
+    }
+}
+
+/*
+Compress the remaining bytes, write every block and stop the compressing threads
+@return true if every block was compressed and written, false otherwise
+*/
+bool BlockCompressor::finish()
+{
+    if (workers.empty())
+    {
+        return !failed && output.good();
+    }
+
+    // An empty output still gets one member so that it is a valid gzip file
+    if (!pending.empty() || nextSubmitted == 0)
+    {
+        submitPending();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    writeCompleted(lock, 0);
+    stopRequested = true;
+    changed.notify_all();
+    lock.unlock();
+
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    output.flush();
+    return !failed && output.good();
+}
@@ -0,0 +1,102 @@
+#ifndef __BLOCKCOMPRESSOR_H_
+#define __BLOCKCOMPRESSOR_H_
+
+/*
+    blockCompressor.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+Compress data held in memory into a single gzip member
+@param data the bytes to compress
+@param size the number of bytes
+@param output the string receiving the compressed bytes
+@param level the zlib compression level, from 1 (fastest) to 9 (smallest)
+@return true if successful, false otherwise
+*/
+bool compressGzip(const char *data, size_t size, std::string &output, int level);
+
+// BlockCompressor class definition, writes data to a stream as a gzip file compressed by several threads
+// Each block becomes its own gzip member, concatenated members being a valid gzip file that decompressGzip and LineReader read back
+class BlockCompressor
+{
+private:
+    // Member datas
+    std::ostream &output;
+    int level;
+    size_t blockSize;
+    size_t maxInFlight; // Blocks submitted but not written yet, bounding the memory held
+    std::string pending;
+    bool failed;
+
+    // Blocks passed to the compressing threads and their compressed results, by block number
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::pair<size_t, std::string>> jobs;
+    std::map<size_t, std::string> results;
+    size_t nextSubmitted;
+    size_t nextWritten;
+    bool stopRequested;
+
+    /*
+    Compress blocks until asked to stop, run by each compressing thread
+    */
+    void work();
+
+    /*
+    Hand the pending bytes to the compressing threads as one block
+    */
+    void submitPending();
+
+    /*
+    Write the compressed blocks that are next in order, waiting until no more than a given number remain
+    @param lock the lock held on mutex
+    @param remaining the number of blocks allowed to stay in flight
+    */
+    void writeCompleted(std::unique_lock<std::mutex> &lock, size_t remaining);
+
+public:
+    static const size_t defaultBlockSize = 1 << 20;
+
+    /*
+    Constructor, starts the compressing threads
+    @param output the stream receiving the gzip file
+    @param level the zlib compression level, from 1 (fastest) to 9 (smallest)
+    @param threadCount the number of compressing threads, 0 for one per core
+    @param blockSize the number of bytes compressed into each member
+    */
+    BlockCompressor(std::ostream &output, int level = 6, size_t threadCount = 0, size_t blockSize = defaultBlockSize);
+
+    // Destructor, finishes the output if finish was not called
+    ~BlockCompressor();
+
+    BlockCompressor(const BlockCompressor &) = delete;
+    BlockCompressor &operator=(const BlockCompressor &) = delete;
+
+    /*
+    Append bytes to the output, full blocks are compressed in the background
+    @param data the bytes to append
+    @param size the number of bytes
+    */
+    void write(const char *data, size_t size);
+
+    /*
+    Compress the remaining bytes, write every block and stop the compressing threads
+    @return true if every block was compressed and written, false otherwise
+    */
+    bool finish();
+};
+
+#endif
@@ -0,0 +1,338 @@
+/*
+    catalogGenerator.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+#include "catalogGenerator.h"
+
+// Syllables used to build artist names, the second list adds non-ASCII characters
+static const char *const asciiSyllables[] = {
+    "al", "be", "ca", "do", "el", "fa", "go", "ha", "in", "jo", "ka", "lu", "ma", "ne", "or", "pa",
+    "qui", "ro", "sa", "te", "ul", "ve", "wa", "xi", "yo", "za", "mon", "ric", "tan", "ver", "les", "dor"};
+static const char *const unicodeSyllables[] = {
+    "jø", "lé", "mü", "ña", "çu", "ß", "ō", "ī", "λα", "дж", "音", "楽", "ł", "å"};
+
+// Words used to build track titles
+static const char *const titleWords[] = {
+    "Love", "Night", "Dream", "Heart", "Fire", "Rain", "Summer", "Blue", "City", "Road",
+    "Light", "Dance", "Time", "World", "Song", "Girl", "Boy", "Baby", "Home", "Sky",
+    "Star", "Moon", "Sun", "River", "Ocean", "Gold", "Silver", "Black", "White", "Red",
+    "Forever", "Tonight", "Again", "Alone", "Together", "Lost", "Found", "Wild", "Free", "Young",
+    "The", "of", "in", "my", "your", "and", "me", "you", "we", "on",
+    "Remix", "Live", "Remastered", "Acoustic", "Edit", "Version", "Interlude", "Reprise", "Intro", "Outro"};
+static const char *const unicodeWords[] = {
+    "Café", "Niño", "Über", "Señor", "Fjørd", "Mañana", "Été", "Ζωή", "Любовь", "夜", "東京", "사랑"};
+
+static const size_t recentRowCapacity = 1024;
+
+/*
+Mix the bits of a number, used to derive artist names from their rank
+@param x the number to mix
+@return the mixed number
+*/
+static uint64_t splitMix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/*
+Draw a number in [0, 1) from the top 53 bits of the generator
+The standard distributions are implementation defined, drawing from the generator's bits
+keeps a catalog the same for a given seed with every standard library
+@param rng the random generator to draw from
+@return the number drawn
+*/
+static double randomUnit(std::mt19937_64 &rng)
+{
+    return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+Draw a number from an approximately normal distribution, as the sum of twelve uniform draws
+Only additions are used, so the result does not depend on the math library
+@param rng the random generator to draw from
+@param mean the mean of the distribution
+@param deviation the standard deviation of the distribution
+@return the number drawn
+*/
+static double randomNormal(std::mt19937_64 &rng, double mean, double deviation)
+{
+    double sum = 0;
+    for (int i = 0; i < 12; ++i)
+    {
+        sum += randomUnit(rng);
+    }
+    return mean + (sum - 6) * deviation;
+}
+
+/*
+Compute log(1 + x) / x, accurate for x close to 0
+@param x the argument
+@return log(1 + x) / x
+*/
+static double log1pOverX(double x)
+{
+    return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+/*
+Compute (exp(x) - 1) / x, accurate for x close to 0
+@param x the argument
+@return (exp(x) - 1) / x
+*/
+static double expm1OverX(double x)
+{
+    return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1 + x * 0.5 * (1 + x * (1.0 / 3) * (1 + 0.25 * x));
+}
+
+/*
+Constructor
+@param numberOfElements the largest rank to draw
+@param exponent the skew of the distribution
+*/
+ZipfSampler::ZipfSampler(uint64_t numberOfElements, double exponent)
+    : numberOfElements(std::max<uint64_t>(numberOfElements, 1)), exponent(exponent)
+{
+    hIntegralX1 = hIntegral(1.5) - 1;
+    hIntegralNumberOfElements = hIntegral(this->numberOfElements + 0.5);
+    threshold = 2 - hIntegralInverse(hIntegral(2.5) - h(2));
+}
+
+// The density 1 / x^s of the continuous distribution bounding the discrete one
+double ZipfSampler::h(double x) const
+{
+    return std::exp(-exponent * std::log(x));
+}
+
+// The integral of h
+double ZipfSampler::hIntegral(double x) const
+{
+    double logX = std::log(x);
+    return expm1OverX((1 - exponent) * logX) * logX;
+}
+
+// The inverse of hIntegral
+double ZipfSampler::hIntegralInverse(double x) const
+{
+    double t = x * (1 - exponent);
+    if (t < -1)
+    {
+        t = -1;
+    }
+    return std::exp(log1pOverX(t) * x);
+}
+
+/*
+Draw a rank using rejection inversion (Hormann and Derflinger)
+@param rng the random generator to draw from
+@return a rank between 1 and numberOfElements
+*/
+uint64_t ZipfSampler::sample(std::mt19937_64 &rng) const
+{
+    while (true)
+    {
+        double u = hIntegralNumberOfElements + randomUnit(rng) * (hIntegralX1 - hIntegralNumberOfElements);
+        double x = hIntegralInverse(u);
+        double rounded = std::floor(x + 0.5);
+        uint64_t k = rounded < 1 ? 1 : rounded > numberOfElements ? numberOfElements : static_cast<uint64_t>(rounded);
+        if (k - x <= threshold || u >= hIntegral(k + 0.5) - h(k))
+        {
+            return k;
+        }
+    }
+}
+
+/*
+Constructor
+@param options the settings of the catalog
+*/
+CatalogGenerator::CatalogGenerator(const GeneratorOptions &options)
+    : options(options), rng(options.seed),
+      artistSampler(options.artistCount ? options.artistCount : std::max<uint64_t>(1, options.trackCount / 10), options.zipfExponent),
+      rowsGenerated(0)
+{
+    recentRows.reserve(recentRowCapacity);
+}
+
+/*
+Build the name of the artist with the given popularity rank
+The name depends only on the rank and the seed, so an artist keeps its name across the catalog
+@param rank the popularity rank of the artist
+@return the artist name
+*/
+std::string CatalogGenerator::artistName(uint64_t rank) const
+{
+    uint64_t bits = splitMix64(rank ^ splitMix64(options.seed));
+    bool unicode = (bits % 10000) < options.unicodeRate * 10000;
+    bits /= 10000;
+
+    std::string name;
+    int wordCount = 1 + bits % 3;
+    bits /= 3;
+    for (int word = 0; word < wordCount; ++word)
+    {
+        if (word > 0)
+        {
+            name += ' ';
+        }
+        size_t wordStart = name.size();
+        int syllableCount = 2 + bits % 2;
+        bits /= 2;
+        for (int syllable = 0; syllable < syllableCount; ++syllable)
+        {
+            if (unicode && word == 0 && syllable == 1)
+            {
+                name += unicodeSyllables[bits % (sizeof(unicodeSyllables) / sizeof(*unicodeSyllables))];
+            }
+            else
+            {
+                name += asciiSyllables[bits % (sizeof(asciiSyllables) / sizeof(*asciiSyllables))];
+            }
+            bits /= 32;
+            if (bits == 0)
+            {
+                bits = splitMix64(rank + word + syllable);
+            }
+        }
+        name[wordStart] = toupper(static_cast<unsigned char>(name[wordStart]));
+    }
+
+    // Keep names distinct even when two ranks draw the same syllables
+    return name + " " + std::to_string(rank);
+}
+
+/*
+Build a random title
+@return the title
+*/
+std::string CatalogGenerator::randomTitle()
+{
+    const size_t titleWordCount = sizeof(titleWords) / sizeof(*titleWords);
+    const size_t unicodeWordCount = sizeof(unicodeWords) / sizeof(*unicodeWords);
+
+    std::string title;
+    int words = options.minTitleWords + static_cast<int>(rng() % (std::max(options.maxTitleWords - options.minTitleWords, 0) + 1));
+    for (int i = 0; i < words; ++i)
+    {
+        if (i > 0)
+        {
+            title += ' ';
+        }
+        title += titleWords[rng() % titleWordCount];
+    }
+    if (randomUnit(rng) < options.unicodeRate)
+    {
+        title += title.empty() ? "" : " ";
+        title += unicodeWords[rng() % unicodeWordCount];
+    }
+    if (options.uniqueTitles)
+    {
+        title += title.empty() ? "" : " ";
+        title += "No. " + std::to_string(rowsGenerated + 1);
+    }
+    return title;
+}
+
+/*
+Build a duration field, valid or not
+@return the duration field
+*/
+std::string CatalogGenerator::randomDuration()
+{
+    if (randomUnit(rng) < options.malformedRate)
+    {
+        // Empty, textual and out of range values are all rejected by the loader
+        static const char *const malformed[] = {"", "n/a", "abc", "--", "99999999999"};
+        return malformed[rng() % (sizeof(malformed) / sizeof(*malformed))];
+    }
+
+    // Most tracks last a few minutes, a few are long mixes
+    if (randomUnit(rng) < 0.02)
+    {
+        return std::to_string(600 + rng() % 3001);
+    }
+    double duration = randomNormal(rng, 240, 70);
+    return std::to_string(static_cast<int>(std::min(std::max(duration, 15.0), 1200.0)));
+}
+
+/*
+Change the letter case of a row so it only matches case insensitively
+@param row the row to change
+@return the row with the case of some ASCII letters swapped
+*/
+std::string CatalogGenerator::changeCase(const std::string &row)
+{
+    std::string changed = row;
+    for (char &c : changed)
+    {
+        unsigned char uc = static_cast<unsigned char>(c);
+        if (uc < 0x80 && isalpha(uc) && rng() % 2)
+        {
+            c = isupper(uc) ? tolower(uc) : toupper(uc);
+        }
+    }
+    return changed;
+}
+
+/*
+Produce the next row of the catalog
+@param row set to the next title, artist and duration separated by tabs
+@return true if a row was produced, false once every row has been generated
+*/
+bool CatalogGenerator::nextRow(std::string &row)
+{
+    if (rowsGenerated >= options.trackCount)
+    {
+        return false;
+    }
+
+    if (!recentRows.empty() && randomUnit(rng) < options.duplicateRate)
+    {
+        row = changeCase(recentRows[rng() % recentRows.size()]);
+    }
+    else
+    {
+        std::string title = randomTitle();
+        std::string artist = artistName(artistSampler.sample(rng));
+        row = title + '\t' + artist + '\t' + randomDuration();
+
+        // Remember the row as a future duplicate source, overwriting the oldest one once full
+        if (recentRows.size() < recentRowCapacity)
+        {
+            recentRows.push_back(row);
+        }
+        else
+        {
+            recentRows[rowsGenerated % recentRowCapacity] = row;
+        }
+    }
+
+    rowsGenerated++;
+    return true;
+}
+
+/*
+Write every remaining row to a stream, one per line
+@param output the stream to write to
+@return the number of rows written
+*/
+uint64_t CatalogGenerator::write(std::ostream &output)
+{
+    uint64_t written = 0;
+    std::string row;
+    while (nextRow(row))
+    {
+        output << row << '\n';
+        written++;
+    }
+    return written;
+}
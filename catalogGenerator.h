@@ -0,0 +1,106 @@
+#ifndef __CATALOGGENERATOR_H_
+#define __CATALOGGENERATOR_H_
+
+/*
+    catalogGenerator.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// GeneratorOptions struct holds the settings of a synthetic catalog
+struct GeneratorOptions
+{
+    uint64_t trackCount = 1000;
+    uint64_t artistCount = 0; // 0 means one artist per ten tracks
+    double zipfExponent = 1.0; // Skew of artist popularity, 0 gives every artist the same weight
+    int minTitleWords = 1;
+    int maxTitleWords = 5;
+    bool uniqueTitles = true;  // Append the row number to titles so only injected duplicates repeat
+    double duplicateRate = 0;  // Share of rows repeating a recent row with different letter case
+    double malformedRate = 0;  // Share of rows with a duration the loader must reject
+    double unicodeRate = 0;    // Share of artists and titles containing non-ASCII characters
+    uint64_t seed = 1;
+};
+
+// ZipfSampler class definition, draws ranks 1..n with probability proportional to 1 / rank^s in constant memory
+class ZipfSampler
+{
+private:
+    // Member datas
+    uint64_t numberOfElements;
+    double exponent;
+    double hIntegralX1;
+    double hIntegralNumberOfElements;
+    double threshold;
+
+    // Helper functions of the rejection inversion method
+    double h(double x) const;
+    double hIntegral(double x) const;
+    double hIntegralInverse(double x) const;
+
+public:
+    /*
+    Constructor
+    @param numberOfElements the largest rank to draw
+    @param exponent the skew of the distribution
+    */
+    ZipfSampler(uint64_t numberOfElements, double exponent);
+
+    /*
+    Draw a rank
+    @param rng the random generator to draw from
+    @return a rank between 1 and numberOfElements
+    */
+    uint64_t sample(std::mt19937_64 &rng) const;
+};
+
+// CatalogGenerator class definition, produces tab separated catalog rows one at a time
+class CatalogGenerator
+{
+private:
+    // Member datas
+    GeneratorOptions options;
+    std::mt19937_64 rng;
+    ZipfSampler artistSampler;
+    uint64_t rowsGenerated;
+    std::vector<std::string> recentRows; // Ring of recent rows used as duplicate sources
+
+    // Build the name of the artist with the given popularity rank
+    std::string artistName(uint64_t rank) const;
+    // Build a random title
+    std::string randomTitle();
+    // Build a duration field, valid or not
+    std::string randomDuration();
+    // Change the letter case of a row so it only matches case insensitively
+    std::string changeCase(const std::string &row);
+
+public:
+    /*
+    Constructor
+    @param options the settings of the catalog
+    */
+    CatalogGenerator(const GeneratorOptions &options);
+
+    /*
+    Produce the next row of the catalog
+    @param row set to the next title, artist and duration separated by tabs
+    @return true if a row was produced, false once every row has been generated
+    */
+    bool nextRow(std::string &row);
+
+    /*
+    Write every remaining row to a stream, one per line
+    @param output the stream to write to
+    @return the number of rows written
+    */
+    uint64_t write(std::ostream &output);
+};
+
+#endif
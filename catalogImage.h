@@ -0,0 +1,46 @@
+#ifndef __CATALOGIMAGE_H_
+#define __CATALOGIMAGE_H_
+
+/*
+    catalogImage.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hashTablePolicies.h"
+
+// Helpers shared by the shared memory and frozen catalog images, which lay out and look up artists the same way
+
+/*
+Hash an artist name ignoring case, with seeded FNV-1a over its bytes
+@param data the bytes of the artist name
+@param length the number of bytes
+@param seed the seed stored in the image, 0 for images without one
+@return the hash value, mixed so that both its top and bottom bits can pick a bucket
+*/
+inline uint64_t catalogArtistHash(const char *data, size_t length, uint64_t seed)
+{
+    uint64_t hashValue = 14695981039346656037ULL ^ seed;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hashValue ^= static_cast<unsigned char>(CaseInsensitiveKey::fold(data[i]));
+        hashValue *= 1099511628211ULL;
+    }
+    return mixBits(hashValue);
+}
+
+/*
+Round an offset up to the next multiple of 8
+@param offset the offset to round
+@return the rounded offset
+*/
+inline uint64_t alignOffset(uint64_t offset)
+{
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+#endif
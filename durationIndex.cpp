@@ -0,0 +1,162 @@
+/*
+    durationIndex.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <algorithm>
+#include "durationIndex.h"
+
+/*
+Find the first block whose last row is not before a row
+@param row the duration and id to look for
+@return the index of the block, or the number of blocks if every row is before it
+*/
+size_t DurationIndex::findBlock(const std::pair<int, uint32_t> &row) const
+{
+    auto block = std::lower_bound(blocks.begin(), blocks.end(), row, [](const std::vector<std::pair<int, uint32_t>> &rows, const std::pair<int, uint32_t> &value)
+                                  { return rows.back() < value; });
+    return block - blocks.begin();
+}
+
+/*
+Add a track to the index
+@param duration the duration of the track in seconds
+@param id the id of the track
+*/
+void DurationIndex::add(int duration, uint32_t id)
+{
+    std::pair<int, uint32_t> row(duration, id);
+    if (blocks.empty())
+    {
+        blocks.emplace_back(1, row);
+        return;
+    }
+
+    // A row after every other one goes to the end of the last block
+    size_t blockIndex = std::min(findBlock(row), blocks.size() - 1);
+    std::vector<std::pair<int, uint32_t>> &rows = blocks[blockIndex];
+    auto position = std::lower_bound(rows.begin(), rows.end(), row);
+    if (position != rows.end() && *position == row)
+    {
+        return;
+    }
+    rows.insert(position, row);
+
+    if (rows.size() > maxBlockRows)
+    {
+        std::vector<std::pair<int, uint32_t>> upperHalf(rows.begin() + rows.size() / 2, rows.end());
+        rows.resize(rows.size() / 2);
+        blocks.insert(blocks.begin() + blockIndex + 1, std::move(upperHalf));
+    }
+}
+
+/*
+Remove a track from the index
+@param duration the duration the track was added with
+@param id the id of the track
+*/
+void DurationIndex::remove(int duration, uint32_t id)
+{
+    std::pair<int, uint32_t> row(duration, id);
+    size_t blockIndex = findBlock(row);
+    if (blockIndex == blocks.size())
+    {
+        return;
+    }
+    std::vector<std::pair<int, uint32_t>> &rows = blocks[blockIndex];
+    auto position = std::lower_bound(rows.begin(), rows.end(), row);
+    if (position == rows.end() || *position != row)
+    {
+        return;
+    }
+    rows.erase(position);
+
+    // A block left small is joined to the next one when both fit in a block, an empty one is dropped
+    if (rows.empty())
+    {
+        blocks.erase(blocks.begin() + blockIndex);
+    }
+    else if (blockIndex + 1 < blocks.size() && rows.size() + blocks[blockIndex + 1].size() <= maxBlockRows / 2)
+    {
+        rows.insert(rows.end(), blocks[blockIndex + 1].begin(), blocks[blockIndex + 1].end());
+        blocks.erase(blocks.begin() + blockIndex + 1);
+    }
+}
+
+/*
+Visit the rows whose duration lies within a range, a block or part of one at a time
+@param minDuration the shortest duration in seconds, inclusive
+@param maxDuration the longest duration in seconds, inclusive
+@param visitor the function called with the first and one past the last row of each run, in order
+*/
+template <typename Visitor>
+void DurationIndex::forEachRange(int minDuration, int maxDuration, Visitor visitor) const
+{
+    if (minDuration > maxDuration)
+    {
+        return;
+    }
+    std::pair<int, uint32_t> lowest(minDuration, 0);
+    std::pair<int, uint32_t> highest(maxDuration, UINT32_MAX);
+    for (size_t blockIndex = findBlock(lowest); blockIndex < blocks.size(); ++blockIndex)
+    {
+        const std::vector<std::pair<int, uint32_t>> &rows = blocks[blockIndex];
+        auto first = rows.front() < lowest ? std::lower_bound(rows.begin(), rows.end(), lowest) : rows.begin();
+        auto last = highest < rows.back() ? std::upper_bound(first, rows.end(), highest) : rows.end();
+        visitor(first, last);
+        if (last != rows.end())
+        {
+            return;
+        }
+    }
+}
+
+/*
+Count the tracks within a duration range
+@param minDuration the shortest duration in seconds, inclusive
+@param maxDuration the longest duration in seconds, inclusive
+@return the number of tracks within the range
+*/
+size_t DurationIndex::count(int minDuration, int maxDuration) const
+{
+    size_t total = 0;
+    forEachRange(minDuration, maxDuration, [&total](auto first, auto last)
+                 { total += last - first; });
+    return total;
+}
+
+/*
+Find the tracks within a duration range
+@param minDuration the shortest duration in seconds, inclusive
+@param maxDuration the longest duration in seconds, inclusive
+@return the ids of the tracks within the range, ordered by duration
+*/
+std::vector<uint32_t> DurationIndex::find(int minDuration, int maxDuration) const
+{
+    std::vector<uint32_t> result;
+    forEachRange(minDuration, maxDuration, [&result](auto first, auto last)
+                 {
+        for (auto row = first; row != last; ++row)
+        {
+            result.push_back(row->second);
+        } });
+    return result;
+}
+
+/*
+Give every track a new id
+New ids keep the order of the old ones, so the rows stay sorted where they are
+@param newIds the new id by old id, increasing over the ids of the tracks in the index
+*/
+void DurationIndex::remapIds(const std::vector<uint32_t> &newIds)
+{
+    for (std::vector<std::pair<int, uint32_t>> &block : blocks)
+    {
+        for (std::pair<int, uint32_t> &row : block)
+        {
+            row.second = newIds[row.second];
+        }
+    }
+}
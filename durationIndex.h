@@ -0,0 +1,74 @@
+#ifndef __DURATIONINDEX_H_
+#define __DURATIONINDEX_H_
+
+/*
+    durationIndex.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// DurationIndex class definition, track ids kept sorted by duration in blocks of a bounded size
+// A change moves the rows of a single block, and a query finds its first block by binary search
+// then reads the rows of the range in order
+// Queries never change the index, so any number of them may run together between changes
+class DurationIndex
+{
+private:
+    // Member datas, rows of duration and id sorted across the blocks, no block is empty
+    std::vector<std::vector<std::pair<int, uint32_t>>> blocks;
+
+    // A block holding more rows than this is split in two
+    static constexpr size_t maxBlockRows = 512;
+
+    // Method to find the first block whose last row is not before a row
+    size_t findBlock(const std::pair<int, uint32_t> &row) const;
+
+    // Method to visit the rows whose duration lies within [minDuration, maxDuration], a block or part of one at a time
+    template <typename Visitor>
+    void forEachRange(int minDuration, int maxDuration, Visitor visitor) const;
+
+public:
+    /*
+    Add a track to the index
+    @param duration the duration of the track in seconds
+    @param id the id of the track
+    */
+    void add(int duration, uint32_t id);
+
+    /*
+    Remove a track from the index
+    @param duration the duration the track was added with
+    @param id the id of the track
+    */
+    void remove(int duration, uint32_t id);
+
+    /*
+    Count the tracks within a duration range
+    @param minDuration the shortest duration in seconds, inclusive
+    @param maxDuration the longest duration in seconds, inclusive
+    @return the number of tracks within the range
+    */
+    size_t count(int minDuration, int maxDuration) const;
+
+    /*
+    Find the tracks within a duration range
+    @param minDuration the shortest duration in seconds, inclusive
+    @param maxDuration the longest duration in seconds, inclusive
+    @return the ids of the tracks within the range, ordered by duration
+    */
+    std::vector<uint32_t> find(int minDuration, int maxDuration) const;
+
+    /*
+    Give every track a new id
+    @param newIds the new id by old id, increasing over the ids of the tracks in the index
+    */
+    void remapIds(const std::vector<uint32_t> &newIds);
+};
+
+#endif
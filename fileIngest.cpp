@@ -0,0 +1,486 @@
+/*
+    fileIngest.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fileIngest.h"
+#include "ioUring.h"
+#include "lineReader.h"
+#include "trackIO.h"
+
+// FileSlot struct holds one file as it moves from reading to parsing to insertion
+struct FileSlot
+{
+    std::string data;
+    bool opened = false;
+    bool parsed = false;
+    std::vector<Track> tracks;
+    std::string warnings;
+    size_t rows = 0;
+    size_t warningCount = 0;
+};
+
+// IngestState struct holds what the reader, the parse threads and the inserting thread share
+struct IngestState
+{
+    const std::vector<std::string> &fileNames;
+    const IngestOptions &options;
+    std::vector<FileSlot> slots;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<size_t> readyToParse; // Files read by io_uring, waiting for a parse thread
+    bool readerFinished = false;
+    size_t nextToClaim = 0;  // Next file a parse thread reads itself, without io_uring
+    size_t nextToInsert = 0; // Files before this one are inserted and released
+
+    IngestState(const std::vector<std::string> &fileNames, const IngestOptions &options)
+        : fileNames(fileNames), options(options), slots(fileNames.size()) {}
+
+    // Files from this index on must wait for earlier ones to be inserted before being read
+    size_t readLimit() const
+    {
+        return std::min(fileNames.size(), nextToInsert + std::max<size_t>(options.maxBufferedFiles, 1));
+    }
+};
+
+/*
+Read a whole file with plain reads
+@param fileName the name of the file
+@param data the string receiving the bytes of the file
+@return true if successful, false otherwise
+*/
+static bool readWholeFile(const std::string &fileName, std::string &data)
+{
+    int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat status;
+    if (fd < 0 || fstat(fd, &status) < 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+
+    data.resize(status.st_size);
+    size_t offset = 0;
+    while (offset < data.size())
+    {
+        ssize_t bytes = read(fd, &data[offset], data.size() - offset);
+        if (bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes <= 0)
+        {
+            break;
+        }
+        offset += bytes;
+    }
+    data.resize(offset); // The file may have shrunk since fstat
+    close(fd);
+    return true;
+}
+
+/*
+Parse the bytes of a file into tracks, line by line as loadTracksFromFile does, then release the bytes
+@param slot the file to parse
+@param fileName the name of the file, for messages
+*/
+static void parseFile(FileSlot &slot, const std::string &fileName)
+{
+    std::ostringstream warnings;
+
+    // Compressed files are recognised by their magic bytes and inflated in memory first
+    Compression compression = detectCompression(slot.data.data(), slot.data.size());
+    if (compression == Compression::Zstd)
+    {
+        warnings << "Error: file " << fileName << " is zstd compressed, which this build cannot read" << std::endl;
+        slot.data.clear();
+    }
+    else if (compression == Compression::Gzip)
+    {
+        std::string decompressed;
+        if (!decompressGzip(slot.data, decompressed))
+        {
+            warnings << "Warning: file " << fileName << " ends with invalid or truncated compressed data" << std::endl;
+            slot.warningCount++;
+        }
+        slot.data.swap(decompressed);
+    }
+
+    const char *position = slot.data.data();
+    const char *end = position + slot.data.size();
+    std::string line;
+    int lineNumber = 0;
+    while (position < end)
+    {
+        const char *newline = static_cast<const char *>(std::memchr(position, '\n', end - position));
+        const char *lineEnd = newline ? newline : end;
+        line.assign(position, lineEnd);
+        position = newline ? newline + 1 : end;
+
+        lineNumber++;
+        if (!parseTrackLine(line, lineNumber, slot.tracks, &warnings))
+        {
+            slot.warningCount++;
+        }
+    }
+    slot.rows = lineNumber;
+    slot.warnings = warnings.str();
+    std::string().swap(slot.data);
+}
+
+/*
+Read every file through io_uring, keeping up to queueDepth block reads in flight, and queue them for parsing
+@param state the shared state of the ingest
+@param ring the ring, already set up
+*/
+static void readWithIoUring(IngestState &state, IoUring &ring)
+{
+    // ReadRequest struct describes a block read in flight, its index is the user data of the read
+    struct ReadRequest
+    {
+        size_t file;
+        uint64_t offset;
+        unsigned length;
+    };
+    std::vector<ReadRequest> requests(state.options.queueDepth);
+    std::vector<unsigned> freeRequests;
+    for (unsigned i = 0; i < requests.size(); ++i)
+    {
+        freeRequests.push_back(static_cast<unsigned>(requests.size()) - 1 - i);
+    }
+
+    size_t fileCount = state.fileNames.size();
+    std::vector<int> fds(fileCount, -1);
+    std::vector<unsigned> readsInFlight(fileCount, 0);
+    std::vector<bool> failed(fileCount, false);
+    std::vector<bool> handedOver(fileCount, false);
+    size_t cursorFile = 0;    // File whose next block is queued next
+    uint64_t cursorOffset = 0;
+    unsigned inFlight = 0;           // Requests taken from freeRequests
+    std::vector<unsigned> toRequeue; // Short reads whose rest did not fit in the submission ring yet
+
+    // A file is handed to the parse threads once all its blocks are in
+    auto finishFile = [&](size_t file)
+    {
+        if (fds[file] >= 0)
+        {
+            close(fds[file]);
+            fds[file] = -1;
+        }
+        handedOver[file] = true;
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.slots[file].opened = !failed[file];
+        state.readyToParse.push_back(file);
+        state.changed.notify_all();
+    };
+
+    // A request given up on leaves its file unreadable
+    auto releaseRequest = [&](unsigned request)
+    {
+        failed[requests[request].file] = true;
+        readsInFlight[requests[request].file]--;
+        freeRequests.push_back(request);
+        inFlight--;
+    };
+
+    // After a ring failure, wait until the kernel is done with every buffer before any is handed over
+    auto abandonReads = [&]()
+    {
+        for (uint64_t request : ring.withdrawQueued())
+        {
+            releaseRequest(static_cast<unsigned>(request));
+        }
+        for (unsigned request : toRequeue)
+        {
+            releaseRequest(request);
+        }
+        toRequeue.clear();
+
+        std::vector<bool> isFree(requests.size(), false);
+        for (unsigned request : freeRequests)
+        {
+            isFree[request] = true;
+        }
+        uint64_t cancelTag = requests.size(); // Never the index of a read
+        for (unsigned request = 0; request < requests.size(); ++request)
+        {
+            if (!isFree[request])
+            {
+                ring.queueCancel(request, cancelTag);
+            }
+        }
+        while (inFlight > 0)
+        {
+            if (!ring.submitAndWait(1))
+            {
+                // Completions are still posted without io_uring_enter, poll for them
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            uint64_t userData;
+            int result;
+            while (ring.popCompletion(userData, result))
+            {
+                if (userData != cancelTag)
+                {
+                    releaseRequest(static_cast<unsigned>(userData));
+                }
+            }
+        }
+    };
+
+    while (true)
+    {
+        size_t limit;
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            // With nothing in flight, sleep until the inserting thread frees room for the next file
+            state.changed.wait(lock, [&]()
+                               { return inFlight > 0 || cursorFile >= fileCount || cursorFile < state.readLimit(); });
+            limit = state.readLimit();
+        }
+        if (inFlight == 0 && cursorFile >= fileCount)
+        {
+            break;
+        }
+
+        // The rest of short reads goes first, then blocks in file order until the queue is full or the next file must wait
+        while (!toRequeue.empty())
+        {
+            ReadRequest &read = requests[toRequeue.back()];
+            if (!ring.queueRead(fds[read.file], &state.slots[read.file].data[read.offset], read.length, read.offset, toRequeue.back()))
+            {
+                break;
+            }
+            toRequeue.pop_back();
+        }
+        while (toRequeue.empty() && !freeRequests.empty() && cursorFile < limit)
+        {
+            FileSlot &slot = state.slots[cursorFile];
+            if (cursorOffset == 0 && fds[cursorFile] < 0)
+            {
+                struct stat status;
+                fds[cursorFile] = open(state.fileNames[cursorFile].c_str(), O_RDONLY | O_CLOEXEC);
+                if (fds[cursorFile] < 0 || fstat(fds[cursorFile], &status) < 0)
+                {
+                    failed[cursorFile] = true;
+                    finishFile(cursorFile++);
+                    continue;
+                }
+                slot.data.resize(status.st_size);
+            }
+            if (cursorOffset >= slot.data.size())
+            {
+                // Empty file, or every block already queued
+                if (readsInFlight[cursorFile] == 0)
+                {
+                    finishFile(cursorFile);
+                }
+                cursorFile++;
+                cursorOffset = 0;
+                continue;
+            }
+
+            unsigned request = freeRequests.back();
+            unsigned length = static_cast<unsigned>(std::min<uint64_t>(state.options.blockSize, slot.data.size() - cursorOffset));
+            if (!ring.queueRead(fds[cursorFile], &slot.data[cursorOffset], length, cursorOffset, request))
+            {
+                break; // Queued once the kernel has taken earlier entries
+            }
+            requests[request] = ReadRequest{cursorFile, cursorOffset, length};
+            freeRequests.pop_back();
+            readsInFlight[cursorFile]++;
+            inFlight++;
+            cursorOffset += length;
+        }
+        if (inFlight == 0)
+        {
+            continue;
+        }
+
+        if (!ring.submitAndWait(1))
+        {
+            std::cerr << "Error: io_uring submission failed: " << std::strerror(errno) << std::endl;
+            abandonReads();
+            break;
+        }
+
+        uint64_t userData;
+        int result;
+        while (ring.popCompletion(userData, result))
+        {
+            ReadRequest &read = requests[userData];
+            FileSlot &slot = state.slots[read.file];
+            if (result > 0 && static_cast<unsigned>(result) < read.length)
+            {
+                // Short read, ask for the rest with the same request, or once the submission ring has room
+                read.offset += result;
+                read.length -= result;
+                if (!ring.queueRead(fds[read.file], &slot.data[read.offset], read.length, read.offset, userData))
+                {
+                    toRequeue.push_back(static_cast<unsigned>(userData));
+                }
+                continue;
+            }
+            if (result <= 0)
+            {
+                // An error, or the end of a file that shrank since fstat
+                failed[read.file] = true;
+            }
+            freeRequests.push_back(static_cast<unsigned>(userData));
+            inFlight--;
+            if (--readsInFlight[read.file] == 0 && (read.file < cursorFile))
+            {
+                finishFile(read.file);
+            }
+        }
+    }
+
+    // After a ring failure, files never finished are reported as unreadable
+    for (size_t file = 0; file < fileCount; ++file)
+    {
+        if (!handedOver[file])
+        {
+            failed[file] = true;
+            finishFile(file);
+        }
+    }
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.readerFinished = true;
+    state.changed.notify_all();
+}
+
+/*
+Parse files until none is left, reading them first when io_uring is not used
+@param state the shared state of the ingest
+@param withIoUring true if a reader thread fills readyToParse, false to read files here
+*/
+static void parseFiles(IngestState &state, bool withIoUring)
+{
+    while (true)
+    {
+        size_t file;
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            if (withIoUring)
+            {
+                state.changed.wait(lock, [&]()
+                                   { return !state.readyToParse.empty() || state.readerFinished; });
+                if (state.readyToParse.empty())
+                {
+                    return;
+                }
+                file = state.readyToParse.front();
+                state.readyToParse.pop_front();
+            }
+            else
+            {
+                if (state.nextToClaim >= state.fileNames.size())
+                {
+                    return;
+                }
+                file = state.nextToClaim++;
+                state.changed.wait(lock, [&]()
+                                   { return file < state.readLimit(); });
+            }
+        }
+
+        FileSlot &slot = state.slots[file];
+        if (!withIoUring)
+        {
+            slot.opened = readWholeFile(state.fileNames[file], slot.data);
+        }
+        if (slot.opened)
+        {
+            parseFile(slot, state.fileNames[file]);
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        slot.parsed = true;
+        state.changed.notify_all();
+    }
+}
+
+/*
+Read and parse many track files concurrently and insert them into one table
+@param hashTable the HashTable object receiving the tracks
+@param fileNames the names of the files to ingest
+@param options the tuning of the ingest
+@return the outcome of every file
+*/
+IngestSummary ingestFiles(HashTable &hashTable, const std::vector<std::string> &fileNames, const IngestOptions &options)
+{
+    IngestState state(fileNames, options);
+    IngestSummary summary;
+    summary.inserted = 0;
+
+    IoUring ring;
+    summary.usedIoUring = options.useIoUring && options.queueDepth > 0 && ring.setup(options.queueDepth);
+    std::thread reader;
+    if (summary.usedIoUring)
+    {
+        reader = std::thread(readWithIoUring, std::ref(state), std::ref(ring));
+    }
+
+    size_t parseThreadCount = options.parseThreads ? options.parseThreads : std::max(1u, std::thread::hardware_concurrency());
+    parseThreadCount = std::min(parseThreadCount, std::max<size_t>(fileNames.size(), 1));
+    std::vector<std::thread> parseThreads;
+    for (size_t i = 0; i < parseThreadCount; ++i)
+    {
+        parseThreads.emplace_back(parseFiles, std::ref(state), summary.usedIoUring);
+    }
+
+    // Insert on this thread in the given order, which is the only place the table is touched
+    for (size_t file = 0; file < fileNames.size(); ++file)
+    {
+        FileSlot &slot = state.slots[file];
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.changed.wait(lock, [&]()
+                               { return slot.parsed; });
+        }
+
+        FileIngestResult result{fileNames[file], slot.opened, slot.rows, 0, slot.warningCount};
+        if (!slot.opened)
+        {
+            std::cerr << "Error: could not open file " << fileNames[file] << std::endl;
+        }
+        std::cerr << slot.warnings;
+        result.inserted = hashTable.insertMany(slot.tracks, options.reportDuplicates);
+        summary.inserted += result.inserted;
+        summary.files.push_back(result);
+        std::vector<Track>().swap(slot.tracks);
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.nextToInsert = file + 1;
+        state.changed.notify_all();
+    }
+
+    for (std::thread &thread : parseThreads)
+    {
+        thread.join();
+    }
+    if (reader.joinable())
+    {
+        reader.join();
+    }
+    return summary;
+}
@@ -0,0 +1,56 @@
+#ifndef __FILEINGEST_H_
+#define __FILEINGEST_H_
+
+/*
+    fileIngest.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "hashTable.h"
+
+// IngestOptions struct holds the tuning of a multi-file ingest
+struct IngestOptions
+{
+    size_t parseThreads = 0;        // 0 uses one thread per core
+    bool useIoUring = true;         // Fall back to reading on the parse threads when false or unavailable
+    unsigned queueDepth = 32;       // Reads in flight through io_uring
+    unsigned blockSize = 1 << 20;   // Bytes per read
+    size_t maxBufferedFiles = 16;   // Files read ahead of the one being inserted
+    bool reportDuplicates = true;
+};
+
+// FileIngestResult struct holds the outcome of one file of an ingest
+struct FileIngestResult
+{
+    std::string fileName;
+    bool opened;
+    size_t rows;
+    size_t inserted;
+    size_t warnings; // Rows skipped for an invalid duration
+};
+
+// IngestSummary struct holds the outcome of a multi-file ingest
+struct IngestSummary
+{
+    std::vector<FileIngestResult> files;
+    size_t inserted;
+    bool usedIoUring;
+};
+
+/*
+Read and parse many track files concurrently and insert them into one table
+Reads overlap with parsing, and files are inserted in the given order so the first copy of a duplicate wins as with sequential loads
+@param hashTable the HashTable object receiving the tracks
+@param fileNames the names of the files to ingest
+@param options the tuning of the ingest
+@return the outcome of every file
+*/
+IngestSummary ingestFiles(HashTable &hashTable, const std::vector<std::string> &fileNames, const IngestOptions &options = IngestOptions());
+
+#endif
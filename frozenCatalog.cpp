@@ -0,0 +1,543 @@
+/*
+    frozenCatalog.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "frozenCatalog.h"
+#include "catalogImage.h"
+
+// "MUSICMPH" in little endian, followed by the layout version
+static const uint64_t frozenMagic = 0x48504D434953554DULL;
+static const uint32_t frozenFormatVersion = 1;
+
+// Artists per bucket on average, fewer means more pilots to store but faster to find
+static const uint32_t artistsPerBucket = 4;
+// Seeds tried before giving up, a seed only fails if two artists share their whole 64-bit hash
+static const uint64_t maxSeedAttempts = 16;
+
+/*
+Find the bucket of an artist from its hash, scaling the top half of the hash instead of dividing
+@param keyHash the hash of the artist name
+@param bucketCount the number of buckets
+@return the bucket of the artist
+*/
+static uint32_t bucketOfKey(uint64_t keyHash, uint32_t bucketCount)
+{
+    return static_cast<uint32_t>(((keyHash >> 32) * bucketCount) >> 32);
+}
+
+/*
+Find the slot an artist is sent to by the pilot of its bucket
+@param keyHash the hash of the artist name
+@param pilot the pilot of the artist's bucket
+@param artistCount the number of slots
+@return the slot of the artist
+*/
+static uint32_t slotOfKey(uint64_t keyHash, uint32_t pilot, uint32_t artistCount)
+{
+    return static_cast<uint32_t>((keyHash ^ mixBits(pilot + 1ULL)) % artistCount);
+}
+
+/*
+Find a pilot for every bucket so that every artist lands in a slot of its own
+Buckets are placed largest first, each taking the first pilot whose slots are all still free
+@param keyHashes the hash of every artist
+@param bucketCount the number of buckets
+@param pilots the vector receiving the pilot of every bucket
+@return true if every bucket found a pilot, false if the hashes need another seed
+*/
+static bool findPilots(const std::vector<uint64_t> &keyHashes, uint32_t bucketCount, std::vector<uint32_t> &pilots)
+{
+    uint32_t artistCount = static_cast<uint32_t>(keyHashes.size());
+
+    // Counting sort of the artists by bucket
+    std::vector<uint32_t> bucketStarts(bucketCount + 1, 0);
+    for (uint64_t keyHash : keyHashes)
+    {
+        bucketStarts[bucketOfKey(keyHash, bucketCount) + 1]++;
+    }
+    for (uint32_t bucket = 0; bucket < bucketCount; ++bucket)
+    {
+        bucketStarts[bucket + 1] += bucketStarts[bucket];
+    }
+    std::vector<uint64_t> bucketHashes(artistCount);
+    std::vector<uint32_t> nextHash(bucketStarts.begin(), bucketStarts.end() - 1);
+    for (uint64_t keyHash : keyHashes)
+    {
+        bucketHashes[nextHash[bucketOfKey(keyHash, bucketCount)]++] = keyHash;
+    }
+
+    std::vector<uint32_t> order(bucketCount);
+    for (uint32_t bucket = 0; bucket < bucketCount; ++bucket)
+    {
+        order[bucket] = bucket;
+    }
+    std::stable_sort(order.begin(), order.end(), [&bucketStarts](uint32_t lhs, uint32_t rhs)
+                     { return bucketStarts[lhs + 1] - bucketStarts[lhs] > bucketStarts[rhs + 1] - bucketStarts[rhs]; });
+
+    // The last free slot takes about artistCount tries to hit, far fewer than this bound
+    uint64_t maxPilot = std::min<uint64_t>(UINT32_MAX, std::max<uint64_t>(1 << 16, artistCount * 64ULL));
+    std::vector<bool> taken(artistCount, false);
+    std::vector<uint32_t> slots;
+    pilots.assign(bucketCount, 0);
+    for (uint32_t bucket : order)
+    {
+        uint32_t begin = bucketStarts[bucket];
+        uint32_t end = bucketStarts[bucket + 1];
+        if (begin == end)
+        {
+            break; // Every remaining bucket is empty
+        }
+
+        // Two artists sharing a hash can never be told apart, whatever the pilot
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            for (uint32_t j = i + 1; j < end; ++j)
+            {
+                if (bucketHashes[i] == bucketHashes[j])
+                {
+                    return false;
+                }
+            }
+        }
+
+        bool placed = false;
+        for (uint64_t pilot = 0; !placed && pilot <= maxPilot; ++pilot)
+        {
+            slots.clear();
+            placed = true;
+            for (uint32_t i = begin; i < end && placed; ++i)
+            {
+                uint32_t slot = slotOfKey(bucketHashes[i], static_cast<uint32_t>(pilot), artistCount);
+                placed = !taken[slot] && std::find(slots.begin(), slots.end(), slot) == slots.end();
+                slots.push_back(slot);
+            }
+            if (placed)
+            {
+                pilots[bucket] = static_cast<uint32_t>(pilot);
+            }
+        }
+        if (!placed)
+        {
+            return false;
+        }
+        for (uint32_t slot : slots)
+        {
+            taken[slot] = true;
+        }
+    }
+    return true;
+}
+
+/*
+Build the frozen image of every track of a hash table
+@param hashTable the HashTable object storing the tracks
+@return the bytes of the image, empty if a title is too long or no perfect hash was found
+*/
+std::string buildFrozenCatalog(const HashTable &hashTable)
+{
+    // Every spelling of an artist is stored once, and spellings equal ignoring case make one artist
+    std::unordered_map<std::string, uint32_t> spellingIndexes;
+    std::unordered_map<std::string, uint32_t> artistIndexes;
+    std::string spellingData;
+    std::vector<uint64_t> spellingStarts(1, 0);
+    std::vector<uint32_t> spellingArtists;
+    std::vector<uint32_t> artistSpellings; // First spelling of every artist, the one its hash is taken from
+
+    // Walking the table visits the tracks of each artist in the order its search returns them
+    std::vector<FrozenTrackRecord> visited;
+    visited.reserve(hashTable.size());
+    std::string titleData;
+    std::string lastArtist;
+    uint32_t lastSpelling = UINT32_MAX;
+    size_t longTitles = 0;
+    auto visitTrack = [&](const Track &track)
+    {
+        // A cut title would no longer be the title stored in the table
+        if (track.getTitle().size() > HashTable::maxTitleLength)
+        {
+            longTitles++;
+            return;
+        }
+
+        const std::string &artist = track.getArtist();
+        if (lastSpelling == UINT32_MAX || artist != lastArtist)
+        {
+            std::unordered_map<std::string, uint32_t>::iterator found = spellingIndexes.find(artist);
+            if (found == spellingIndexes.end())
+            {
+                std::string key(artist);
+                std::transform(key.begin(), key.end(), key.begin(), CaseInsensitiveKey::fold);
+                std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> artistEntry =
+                    artistIndexes.emplace(key, static_cast<uint32_t>(artistSpellings.size()));
+                uint32_t spelling = static_cast<uint32_t>(spellingArtists.size());
+                if (artistEntry.second)
+                {
+                    artistSpellings.push_back(spelling);
+                }
+                spellingArtists.push_back(artistEntry.first->second);
+                spellingData += artist;
+                spellingStarts.push_back(spellingData.size());
+                found = spellingIndexes.emplace(artist, spelling).first;
+            }
+            lastArtist = artist;
+            lastSpelling = found->second;
+        }
+
+        FrozenTrackRecord record = {};
+        record.titleOffset = titleData.size();
+        record.titleLength = track.getTitle().size();
+        record.spelling = lastSpelling;
+        record.duration = track.getDuration();
+        titleData.append(track.getTitle());
+        visited.push_back(record);
+    };
+    hashTable.forEachTrack(visitTrack);
+    if (longTitles > 0)
+    {
+        std::cerr << "Error: " << longTitles << " titles are longer than the " << HashTable::maxTitleLength
+                  << " bytes an image can hold" << std::endl;
+        return std::string();
+    }
+
+    // Try seeds until every bucket of artists finds a pilot
+    uint32_t artistCount = static_cast<uint32_t>(artistSpellings.size());
+    uint32_t bucketCount = std::max<uint32_t>(1, (artistCount + artistsPerBucket - 1) / artistsPerBucket);
+    std::vector<uint64_t> keyHashes(artistCount);
+    std::vector<uint32_t> pilots;
+    uint64_t seed = 0;
+    bool found = false;
+    for (uint64_t attempt = 0; !found && attempt < maxSeedAttempts; ++attempt)
+    {
+        seed = attempt * fibonacciMultiplier;
+        for (uint32_t artist = 0; artist < artistCount; ++artist)
+        {
+            uint32_t spelling = artistSpellings[artist];
+            keyHashes[artist] = catalogArtistHash(spellingData.data() + spellingStarts[spelling],
+                                                  spellingStarts[spelling + 1] - spellingStarts[spelling], seed);
+        }
+        found = findPilots(keyHashes, bucketCount, pilots);
+    }
+    if (!found)
+    {
+        std::cerr << "Error: could not find a perfect hash for the " << artistCount << " artists" << std::endl;
+        return std::string();
+    }
+
+    // Counting sort of the tracks by the slot of their artist, which keeps the tracks of an artist in order
+    std::vector<uint32_t> artistSlots(artistCount);
+    for (uint32_t artist = 0; artist < artistCount; ++artist)
+    {
+        artistSlots[artist] = slotOfKey(keyHashes[artist], pilots[bucketOfKey(keyHashes[artist], bucketCount)], artistCount);
+    }
+    std::vector<uint32_t> slotStarts(artistCount + 1, 0);
+    for (const FrozenTrackRecord &record : visited)
+    {
+        slotStarts[artistSlots[spellingArtists[record.spelling]] + 1]++;
+    }
+    for (uint32_t slot = 0; slot < artistCount; ++slot)
+    {
+        slotStarts[slot + 1] += slotStarts[slot];
+    }
+
+    FrozenCatalogHeader header = {};
+    header.magic = frozenMagic;
+    header.formatVersion = frozenFormatVersion;
+    header.artistCount = artistCount;
+    header.trackCount = visited.size();
+    header.seed = seed;
+    header.bucketCount = bucketCount;
+    header.spellingCount = static_cast<uint32_t>(spellingArtists.size());
+    header.pilotsOffset = alignOffset(sizeof(FrozenCatalogHeader));
+    header.slotsOffset = alignOffset(header.pilotsOffset + pilots.size() * sizeof(uint32_t));
+    header.spellingsOffset = alignOffset(header.slotsOffset + slotStarts.size() * sizeof(uint32_t));
+    header.recordsOffset = alignOffset(header.spellingsOffset + spellingStarts.size() * sizeof(uint64_t));
+    header.stringsOffset = header.recordsOffset + visited.size() * sizeof(FrozenTrackRecord);
+    header.imageSize = header.stringsOffset + titleData.size() + spellingData.size();
+
+    // The spellings follow the titles in the string bytes
+    for (uint64_t &start : spellingStarts)
+    {
+        start += titleData.size();
+    }
+
+    std::string image(header.imageSize, '\0');
+    std::memcpy(&image[0], &header, sizeof(header));
+    std::memcpy(&image[header.pilotsOffset], pilots.data(), pilots.size() * sizeof(uint32_t));
+    std::memcpy(&image[header.slotsOffset], slotStarts.data(), slotStarts.size() * sizeof(uint32_t));
+    std::memcpy(&image[header.spellingsOffset], spellingStarts.data(), spellingStarts.size() * sizeof(uint64_t));
+    std::memcpy(&image[header.stringsOffset], titleData.data(), titleData.size());
+    std::memcpy(&image[header.stringsOffset + titleData.size()], spellingData.data(), spellingData.size());
+
+    std::vector<uint32_t> nextRecord(slotStarts.begin(), slotStarts.end() - 1);
+    for (const FrozenTrackRecord &record : visited)
+    {
+        uint32_t index = nextRecord[artistSlots[spellingArtists[record.spelling]]]++;
+        std::memcpy(&image[header.recordsOffset + index * sizeof(FrozenTrackRecord)], &record, sizeof(record));
+    }
+    return image;
+}
+
+/*
+Freeze the tracks of a hash table into a file that FrozenCatalogFile maps back
+@param hashTable the HashTable object storing the tracks
+@param fileName the name of the file to write
+@return true if successful, false otherwise
+*/
+bool saveFrozenCatalog(const HashTable &hashTable, const std::string &fileName)
+{
+    std::string image = buildFrozenCatalog(hashTable);
+    if (image.empty())
+    {
+        return false;
+    }
+
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Error: could not open file " << fileName << " for writing" << std::endl;
+        return false;
+    }
+    file.write(image.data(), image.size());
+    file.close();
+    if (!file)
+    {
+        std::cerr << "Error: could not write file " << fileName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+Check an image and view it, the view is invalid if the image is truncated or not a frozen image
+@param image the start of the image
+@param size the number of bytes available
+*/
+FrozenCatalogView::FrozenCatalogView(const char *image, size_t size)
+    : header(nullptr), pilots(nullptr), slotStarts(nullptr), spellingStarts(nullptr), records(nullptr), strings(nullptr)
+{
+    if (!image || size < sizeof(FrozenCatalogHeader))
+    {
+        return;
+    }
+    const FrozenCatalogHeader *candidate = reinterpret_cast<const FrozenCatalogHeader *>(image);
+    if (candidate->magic != frozenMagic || candidate->formatVersion != frozenFormatVersion ||
+        candidate->imageSize > size || candidate->bucketCount == 0 ||
+        (candidate->pilotsOffset | candidate->slotsOffset | candidate->spellingsOffset | candidate->recordsOffset) % 8 != 0 ||
+        candidate->pilotsOffset < sizeof(FrozenCatalogHeader) ||
+        candidate->pilotsOffset + candidate->bucketCount * sizeof(uint32_t) > candidate->slotsOffset ||
+        candidate->slotsOffset + (candidate->artistCount + 1ULL) * sizeof(uint32_t) > candidate->spellingsOffset ||
+        candidate->spellingsOffset + (candidate->spellingCount + 1ULL) * sizeof(uint64_t) > candidate->recordsOffset ||
+        candidate->recordsOffset + candidate->trackCount * sizeof(FrozenTrackRecord) > candidate->stringsOffset ||
+        candidate->stringsOffset > candidate->imageSize)
+    {
+        return;
+    }
+
+    header = candidate;
+    pilots = reinterpret_cast<const uint32_t *>(image + header->pilotsOffset);
+    slotStarts = reinterpret_cast<const uint32_t *>(image + header->slotsOffset);
+    spellingStarts = reinterpret_cast<const uint64_t *>(image + header->spellingsOffset);
+    records = reinterpret_cast<const FrozenTrackRecord *>(image + header->recordsOffset);
+    strings = image + header->stringsOffset;
+}
+
+/*
+Check whether the image was accepted
+@return true if the image can be searched, false otherwise
+*/
+bool FrozenCatalogView::isValid() const
+{
+    return header != nullptr;
+}
+
+/*
+Get the number of tracks in the image
+@return the number of tracks
+*/
+size_t FrozenCatalogView::size() const
+{
+    return header ? header->trackCount : 0;
+}
+
+/*
+Get the number of distinct artists in the image, ignoring case
+@return the number of artists
+*/
+size_t FrozenCatalogView::artistCount() const
+{
+    return header ? header->artistCount : 0;
+}
+
+/*
+Get the bytes of an artist name as tracks spell it
+@param spelling the index of the spelling
+@param length the number of bytes of the name
+@return the start of the name, or null if the spelling is outside the image
+*/
+const char *FrozenCatalogView::getSpelling(uint32_t spelling, size_t &length) const
+{
+    uint64_t stringBytes = header->imageSize - header->stringsOffset;
+    if (spelling >= header->spellingCount || spellingStarts[spelling] > spellingStarts[spelling + 1] ||
+        spellingStarts[spelling + 1] > stringBytes)
+    {
+        return nullptr;
+    }
+    length = spellingStarts[spelling + 1] - spellingStarts[spelling];
+    return strings + spellingStarts[spelling];
+}
+
+/*
+Find the records of an artist by reading the one slot the perfect hash gives its name
+Any name is sent to some slot, so the name of the slot's artist is compared once to reject the others
+@param artist the artist name, ignoring case
+@param begin the index of the artist's first record
+@param end the index after the artist's last record
+@return true if the artist is in the image, false otherwise
+*/
+bool FrozenCatalogView::findArtist(const std::string &artist, uint32_t &begin, uint32_t &end) const
+{
+    if (!header || header->artistCount == 0)
+    {
+        return false;
+    }
+
+    uint64_t keyHash = catalogArtistHash(artist.data(), artist.size(), header->seed);
+    uint32_t slot = slotOfKey(keyHash, pilots[bucketOfKey(keyHash, header->bucketCount)], header->artistCount);
+    begin = slotStarts[slot];
+    end = std::min<uint64_t>(slotStarts[slot + 1], header->trackCount);
+    if (begin >= end)
+    {
+        return false;
+    }
+
+    size_t length = 0;
+    const char *name = getSpelling(records[begin].spelling, length);
+    return name && keysEqual<CaseInsensitiveKey>(name, length, artist);
+}
+
+/*
+Count the tracks of an artist without building them
+@param artist the artist name to search for, ignoring case
+@return the number of tracks by the artist
+*/
+size_t FrozenCatalogView::count(const std::string &artist) const
+{
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    return findArtist(artist, begin, end) ? end - begin : 0;
+}
+
+/*
+Search for tracks by artist in the image, ignoring case
+@param artist the artist name to search for
+@return a vector of Track objects that match the given artist, with line number 0
+*/
+std::vector<Track> FrozenCatalogView::search(const std::string &artist) const
+{
+    std::vector<Track> result;
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    if (!findArtist(artist, begin, end))
+    {
+        return result;
+    }
+
+    uint64_t stringBytes = header->imageSize - header->stringsOffset;
+    result.reserve(end - begin);
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const FrozenTrackRecord &record = records[i];
+        size_t length = 0;
+        const char *name = getSpelling(record.spelling, length);
+        if (!name || record.titleOffset + record.titleLength > stringBytes)
+        {
+            continue;
+        }
+        result.emplace_back(0, std::string(strings + record.titleOffset, record.titleLength), std::string(name, length), record.duration);
+    }
+    return result;
+}
+
+// Constructor
+FrozenCatalogFile::FrozenCatalogFile() : image(nullptr), imageSize(0) {}
+
+// Destructor
+FrozenCatalogFile::~FrozenCatalogFile()
+{
+    unmap();
+}
+
+/*
+Unmap the current file
+*/
+void FrozenCatalogFile::unmap()
+{
+    if (image)
+    {
+        munmap(const_cast<char *>(image), imageSize);
+        image = nullptr;
+        imageSize = 0;
+    }
+}
+
+/*
+Map a frozen catalog file, replacing any file mapped before
+Nothing is read or rebuilt, pages of the file are only loaded when a search touches them
+@param fileName the name of the file written by saveFrozenCatalog
+@return true if the file holds a valid image, false otherwise
+*/
+bool FrozenCatalogFile::open(const std::string &fileName)
+{
+    unmap();
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Error: could not open file " << fileName << std::endl;
+        return false;
+    }
+    struct stat status;
+    void *mapping = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Error: could not map file " << fileName << std::endl;
+        return false;
+    }
+    if (!FrozenCatalogView(static_cast<const char *>(mapping), status.st_size).isValid())
+    {
+        munmap(mapping, status.st_size);
+        std::cerr << "Error: file " << fileName << " is not a valid frozen catalog" << std::endl;
+        return false;
+    }
+
+    image = static_cast<const char *>(mapping);
+    imageSize = status.st_size;
+    return true;
+}
+
+/*
+View the image currently mapped, only valid until the next open
+@return a view of the image
+*/
+FrozenCatalogView FrozenCatalogFile::view() const
+{
+    return FrozenCatalogView(image, imageSize);
+}
@@ -0,0 +1,180 @@
+#ifndef __FROZENCATALOG_H_
+#define __FROZENCATALOG_H_
+
+/*
+    frozenCatalog.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "track.h"
+#include "hashTable.h"
+
+/*
+Read-only catalog image for deployments that never change their catalog, found through a minimal perfect hash over artists
+Every distinct artist, ignoring case, owns exactly one slot, so a search reads a single slot and compares a single name
+The hash follows PTHash: artists are spread over buckets of about four, and each bucket stores the pilot number
+that sends all of its artists to free slots
+    header | pilots (bucketCount) | slot starts (artistCount + 1 record indexes) | spelling starts (spellingCount + 1 offsets)
+           | records grouped by slot | string bytes
+Every reference inside the image is an offset from its start, so a file holding it is mapped and searched in place
+Tracks of one artist keep the order HashTable::search returns them in, line numbers are not kept
+*/
+
+// FrozenCatalogHeader struct is the start of an image
+struct FrozenCatalogHeader
+{
+    uint64_t magic;
+    uint32_t formatVersion;
+    uint32_t artistCount;
+    uint64_t trackCount;
+    uint64_t imageSize;
+    uint64_t seed; // Seed of the artist hash that let every bucket find a pilot
+    uint32_t bucketCount;
+    uint32_t spellingCount;
+    uint64_t pilotsOffset;
+    uint64_t slotsOffset;
+    uint64_t spellingsOffset;
+    uint64_t recordsOffset;
+    uint64_t stringsOffset;
+};
+
+// FrozenTrackRecord struct is one track of an image, its title lives in the string bytes
+struct FrozenTrackRecord
+{
+    uint64_t titleOffset : 40; // From the start of the string bytes
+    uint64_t titleLength : 24;
+    uint32_t spelling; // Index of the artist name as the track spells it
+    int32_t duration;
+};
+static_assert(sizeof(FrozenTrackRecord) == 16, "FrozenTrackRecord should stay 16 bytes");
+
+/*
+Build the frozen image of every track of a hash table
+@param hashTable the HashTable object storing the tracks
+@return the bytes of the image
+*/
+std::string buildFrozenCatalog(const HashTable &hashTable);
+
+/*
+Freeze the tracks of a hash table into a file that FrozenCatalogFile maps back
+@param hashTable the HashTable object storing the tracks
+@param fileName the name of the file to write
+@return true if successful, false otherwise
+*/
+bool saveFrozenCatalog(const HashTable &hashTable, const std::string &fileName);
+
+// FrozenCatalogView class definition, searches a frozen image in place without copying it
+class FrozenCatalogView
+{
+private:
+    // Member datas
+    const FrozenCatalogHeader *header;
+    const uint32_t *pilots;
+    const uint32_t *slotStarts;
+    const uint64_t *spellingStarts;
+    const FrozenTrackRecord *records;
+    const char *strings;
+
+    /*
+    Get the bytes of an artist name as tracks spell it
+    @param spelling the index of the spelling
+    @param length the number of bytes of the name
+    @return the start of the name, or null if the spelling is outside the image
+    */
+    const char *getSpelling(uint32_t spelling, size_t &length) const;
+
+    /*
+    Find the records of an artist by reading the one slot the perfect hash gives its name
+    @param artist the artist name, ignoring case
+    @param begin the index of the artist's first record
+    @param end the index after the artist's last record
+    @return true if the artist is in the image, false otherwise
+    */
+    bool findArtist(const std::string &artist, uint32_t &begin, uint32_t &end) const;
+
+public:
+    /*
+    Check an image and view it, the view is invalid if the image is truncated or not a frozen image
+    @param image the start of the image
+    @param size the number of bytes available
+    */
+    FrozenCatalogView(const char *image, size_t size);
+
+    /*
+    Check whether the image was accepted
+    @return true if the image can be searched, false otherwise
+    */
+    bool isValid() const;
+
+    /*
+    Get the number of tracks in the image
+    @return the number of tracks
+    */
+    size_t size() const;
+
+    /*
+    Get the number of distinct artists in the image, ignoring case
+    @return the number of artists
+    */
+    size_t artistCount() const;
+
+    /*
+    Count the tracks of an artist without building them
+    @param artist the artist name to search for, ignoring case
+    @return the number of tracks by the artist
+    */
+    size_t count(const std::string &artist) const;
+
+    /*
+    Search for tracks by artist in the image, ignoring case
+    @param artist the artist name to search for
+    @return a vector of Track objects that match the given artist, with line number 0
+    */
+    std::vector<Track> search(const std::string &artist) const;
+};
+
+// FrozenCatalogFile class definition, maps a frozen catalog file read-only so it is searchable as soon as it is opened
+class FrozenCatalogFile
+{
+private:
+    // Member datas
+    const char *image;
+    size_t imageSize;
+
+    /*
+    Unmap the current file
+    */
+    void unmap();
+
+public:
+    // Constructor
+    FrozenCatalogFile();
+
+    // Destructor
+    ~FrozenCatalogFile();
+
+    FrozenCatalogFile(const FrozenCatalogFile &) = delete;
+    FrozenCatalogFile &operator=(const FrozenCatalogFile &) = delete;
+
+    /*
+    Map a frozen catalog file, replacing any file mapped before
+    @param fileName the name of the file written by saveFrozenCatalog
+    @return true if the file holds a valid image, false otherwise
+    */
+    bool open(const std::string &fileName);
+
+    /*
+    View the image currently mapped, only valid until the next open
+    @return a view of the image
+    */
+    FrozenCatalogView view() const;
+};
+
+#endif
@@ -0,0 +1,167 @@
+/*
+    fuzzyArtistIndex.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <algorithm>
+#include "fuzzyArtistIndex.h"
+#include "textUtils.h"
+
+// Constructor
+FuzzyArtistIndex::FuzzyArtistIndex()
+    : nodes(1, TrieNode{'\0', 0, 0, 0, ArtistDictionary::notFound}) {}
+
+/*
+Find the child of a node with the given label
+@param node the parent node
+@param label the byte to look for
+@return the index of the child, or 0 if there is none
+*/
+uint32_t FuzzyArtistIndex::findChild(uint32_t node, char label) const
+{
+    uint32_t child = nodes[node].firstChild;
+    while (child && nodes[child].label != label)
+    {
+        child = nodes[child].nextSibling;
+    }
+    return child;
+}
+
+/*
+Count one more track by an artist
+@param artist the artist name
+@param artistId the dictionary id of the name, kept as the display name when the artist first appears
+*/
+void FuzzyArtistIndex::add(const std::string &artist, uint32_t artistId)
+{
+    uint32_t node = 0;
+    for (char c : toLowerCase(artist))
+    {
+        uint32_t child = findChild(node, c);
+        if (!child)
+        {
+            // Prepend the new child to the sibling chain
+            child = static_cast<uint32_t>(nodes.size());
+            nodes.push_back(TrieNode{c, 0, nodes[node].firstChild, 0, ArtistDictionary::notFound});
+            nodes[node].firstChild = child;
+        }
+        node = child;
+    }
+
+    // Remember how the artist is spelled when it first appears
+    if (nodes[node].trackCount == 0)
+    {
+        nodes[node].artistId = artistId;
+    }
+    nodes[node].trackCount++;
+}
+
+/*
+Count one less track by an artist
+@param artist the artist name
+*/
+void FuzzyArtistIndex::remove(const std::string &artist)
+{
+    uint32_t node = 0;
+    for (char c : toLowerCase(artist))
+    {
+        node = findChild(node, c);
+        if (!node)
+        {
+            return;
+        }
+    }
+    if (nodes[node].trackCount > 0)
+    {
+        nodes[node].trackCount--;
+    }
+}
+
+/*
+Walk the trie under a node, extending the edit distance rows one byte at a time
+@param node the node whose label extends the prefix
+@param depth the length of the prefix ending at this node
+@param query the lowercase name being matched
+@param maxDistance the largest distance to accept
+@param artists the dictionary resolving the ids of the matches
+@param rows the distance rows for every prefix length, rows[depth - 1] is the parent's row
+@param matches the artists found so far
+*/
+void FuzzyArtistIndex::searchNode(uint32_t node, size_t depth, const std::string &query, size_t maxDistance, const ArtistDictionary &artists,
+                                  std::vector<std::vector<size_t>> &rows, std::vector<ArtistMatch> &matches) const
+{
+    const std::vector<size_t> &previous = rows[depth - 1];
+    std::vector<size_t> &current = rows[depth];
+    const size_t unreachable = maxDistance + 1;
+    const char label = nodes[node].label;
+
+    // Only the cells within maxDistance of the diagonal can stay under the limit
+    size_t first = depth > maxDistance ? depth - maxDistance : 0;
+    size_t last = std::min(query.size(), depth + maxDistance);
+    std::fill(current.begin(), current.end(), unreachable);
+
+    size_t rowMinimum = unreachable;
+    for (size_t i = first; i <= last; ++i)
+    {
+        size_t distance = i == 0 ? depth : previous[i] + 1;
+        if (i > 0)
+        {
+            distance = std::min(distance, current[i - 1] + 1);
+            distance = std::min(distance, previous[i - 1] + (query[i - 1] == label ? 0 : 1));
+        }
+        current[i] = std::min(distance, unreachable);
+        rowMinimum = std::min(rowMinimum, current[i]);
+    }
+
+    if (current[query.size()] <= maxDistance && nodes[node].trackCount > 0)
+    {
+        matches.push_back(ArtistMatch{artists.getName(nodes[node].artistId), current[query.size()]});
+    }
+
+    // Stop descending once every extension of the prefix is too far away
+    if (rowMinimum > maxDistance)
+    {
+        return;
+    }
+    for (uint32_t child = nodes[node].firstChild; child; child = nodes[child].nextSibling)
+    {
+        searchNode(child, depth + 1, query, maxDistance, artists, rows, matches);
+    }
+}
+
+/*
+Find the artists close to a name
+@param artist the artist name to match, compared case insensitively
+@param maxDistance the largest Levenshtein distance to accept
+@param artists the dictionary the ids given to add come from
+@return the matching artists ordered by distance then name
+*/
+std::vector<ArtistMatch> FuzzyArtistIndex::find(const std::string &artist, size_t maxDistance, const ArtistDictionary &artists) const
+{
+    std::string query = toLowerCase(artist);
+    std::vector<ArtistMatch> matches;
+
+    // No prefix longer than the query plus maxDistance can match, which bounds the depth of the walk
+    std::vector<std::vector<size_t>> rows(query.size() + maxDistance + 2, std::vector<size_t>(query.size() + 1));
+
+    // The row of the empty prefix is the distance to every prefix of the query
+    for (size_t i = 0; i <= query.size(); ++i)
+    {
+        rows[0][i] = i;
+    }
+    if (query.size() <= maxDistance && nodes[0].trackCount > 0)
+    {
+        matches.push_back(ArtistMatch{artists.getName(nodes[0].artistId), query.size()});
+    }
+
+    for (uint32_t child = nodes[0].firstChild; child; child = nodes[child].nextSibling)
+    {
+        searchNode(child, 1, query, maxDistance, artists, rows, matches);
+    }
+
+    std::sort(matches.begin(), matches.end(), [](const ArtistMatch &lhs, const ArtistMatch &rhs)
+              { return lhs.distance != rhs.distance ? lhs.distance < rhs.distance : lhs.artist < rhs.artist; });
+    return matches;
+}
@@ -0,0 +1,76 @@
+#ifndef __FUZZYARTISTINDEX_H_
+#define __FUZZYARTISTINDEX_H_
+
+/*
+    fuzzyArtistIndex.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "artistDictionary.h"
+
+// ArtistMatch struct is used to return an approximate artist match with its edit distance
+struct ArtistMatch
+{
+    std::string artist;
+    size_t distance;
+};
+
+// FuzzyArtistIndex class definition, a trie of lowercase artist names searched by edit distance
+// Names are not copied, the node ending an artist keeps its ArtistDictionary id
+class FuzzyArtistIndex
+{
+private:
+    // TrieNode struct stores one byte of an artist name, children are chained as siblings
+    struct TrieNode
+    {
+        char label;
+        uint32_t firstChild;
+        uint32_t nextSibling;
+        uint32_t trackCount; // Number of tracks by the artist ending at this node
+        uint32_t artistId;   // Dictionary id of the artist's display name, or ArtistDictionary::notFound
+    };
+
+    // Member datas
+    std::vector<TrieNode> nodes; // nodes[0] is the root
+
+    // Find the child of a node with the given label, or 0 if there is none
+    uint32_t findChild(uint32_t node, char label) const;
+
+    // Walk the trie under a node, extending the edit distance rows one byte at a time
+    void searchNode(uint32_t node, size_t depth, const std::string &query, size_t maxDistance, const ArtistDictionary &artists,
+                    std::vector<std::vector<size_t>> &rows, std::vector<ArtistMatch> &matches) const;
+
+public:
+    // Constructor
+    FuzzyArtistIndex();
+
+    /*
+    Count one more track by an artist
+    @param artist the artist name
+    @param artistId the dictionary id of the name, kept as the display name when the artist first appears
+    */
+    void add(const std::string &artist, uint32_t artistId);
+
+    /*
+    Count one less track by an artist
+    @param artist the artist name
+    */
+    void remove(const std::string &artist);
+
+    /*
+    Find the artists close to a name
+    @param artist the artist name to match, compared case insensitively
+    @param maxDistance the largest Levenshtein distance to accept
+    @param artists the dictionary the ids given to add come from
+    @return the matching artists ordered by distance then name
+    */
+    std::vector<ArtistMatch> find(const std::string &artist, size_t maxDistance, const ArtistDictionary &artists) const;
+};
+
+#endif
@@ -0,0 +1,129 @@
+/*
+    generateCatalog.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "catalogGenerator.h"
+
+/*
+Print how to use the generator
+@param programName the name of the program
+*/
+void printUsage(const std::string &programName)
+{
+    std::cerr << "Usage: " << programName << " <output file> <track count> [options]\n"
+              << "Options:\n"
+              << "  --artists <count>          number of distinct artists (default: track count / 10)\n"
+              << "  --zipf <exponent>          skew of artist popularity (default: 1.0)\n"
+              << "  --title-words <min> <max>  number of words per title (default: 1 5)\n"
+              << "  --duplicates <rate>        share of rows repeating a recent row (default: 0)\n"
+              << "  --malformed <rate>         share of rows with an invalid duration (default: 0)\n"
+              << "  --unicode <rate>           share of artists and titles with non-ASCII text (default: 0)\n"
+              << "  --no-unique-titles         do not append the row number to titles\n"
+              << "  --seed <number>            seed of the random generator (default: 1)" << std::endl;
+}
+
+/*
+Main function of the generator
+@param argc the number of command-line arguments
+@param argv array of command-line argument strings
+@return 0 upon successful completion
+*/
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string fileName = argv[1];
+    GeneratorOptions options;
+    try
+    {
+        options.trackCount = std::stoull(argv[2]);
+        for (int i = 3; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            // Every option but --no-unique-titles takes at least one value
+            if (option != "--no-unique-titles" && i + 1 >= argc)
+            {
+                throw std::invalid_argument(option);
+            }
+
+            if (option == "--artists")
+            {
+                options.artistCount = std::stoull(argv[++i]);
+            }
+            else if (option == "--zipf")
+            {
+                options.zipfExponent = std::stod(argv[++i]);
+            }
+            else if (option == "--title-words" && i + 2 < argc)
+            {
+                options.minTitleWords = std::stoi(argv[++i]);
+                options.maxTitleWords = std::stoi(argv[++i]);
+            }
+            else if (option == "--duplicates")
+            {
+                options.duplicateRate = std::stod(argv[++i]);
+            }
+            else if (option == "--malformed")
+            {
+                options.malformedRate = std::stod(argv[++i]);
+            }
+            else if (option == "--unicode")
+            {
+                options.unicodeRate = std::stod(argv[++i]);
+            }
+            else if (option == "--no-unique-titles")
+            {
+                options.uniqueTitles = false;
+            }
+            else if (option == "--seed")
+            {
+                options.seed = std::stoull(argv[++i]);
+            }
+            else
+            {
+                throw std::invalid_argument(option);
+            }
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: invalid argument " << ex.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::ofstream outputFile(fileName);
+    if (!outputFile)
+    {
+        std::cerr << "Error: could not open file " << fileName << " for writing" << std::endl;
+        return 1;
+    }
+
+    // Stream the rows through a large buffer, only the duplicate sources are kept in memory
+    std::vector<char> buffer(1 << 20);
+    outputFile.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+
+    CatalogGenerator generator(options);
+    uint64_t written = generator.write(outputFile);
+    outputFile.close();
+    if (!outputFile)
+    {
+        std::cerr << "Error: could not write file " << fileName << std::endl;
+        return 1;
+    }
+
+    std::cout << "Generated " << written << " tracks in " << fileName << "." << std::endl;
+    return 0;
+}
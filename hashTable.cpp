@@ -2,40 +2,48 @@
     hashTable.cpp
     Author: M00826933
     Created: 11/04/23
-    Updated: 16/04/23
+    Updated: 19/10/26
 */
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include "hashTable.h"
+#include "latencyHistogram.h"
 
-// Constructor
-HashTable::HashTable(size_t size)
-    : tableSize(size), table(new TrackNode *[size]()) {}
+/*
+Draw a version number no table has used before
+Every table draws from the same counter, so a version names one state of one table
+@return the new version number
+*/
+static uint64_t nextVersion()
+{
+    static std::atomic<uint64_t> lastVersion(0);
+    return ++lastVersion;
+}
 
-// Destructor
-HashTable::~HashTable()
+// Constructor
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::BasicHashTable(size_t size)
+    : capacity(size), table(capacity.size(), noNode), tails(capacity.size(), noNode),
+      keyTable(capacity.size(), noNode), freedTitleBytes(0), keepLineNumbers(true), filterArtists(true),
+      emptiedArtists(0), numTracks(0), version(nextVersion())
 {
-    // Iterate through the table and delete all nodes
-    for (size_t i = 0; i < tableSize; ++i)
-    {
-        TrackNode *currentNode = table[i];
-        while (currentNode)
-        {
-            TrackNode *nextNode = currentNode->next;
-            delete currentNode;
-            currentNode = nextNode;
-        }
-    }
-    delete[] table;
+    artistFilter.reset(minFilterArtists);
 }
 
+// Destructor, the nodes and titles are held by value
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::~BasicHashTable() {}
+
 /*
 Case insensitive string comparison
 @param str1 the first string to compare
 @param str2 the second string to compare
 @return true if the strings are equal, ignoring case; false otherwise
 */
-bool HashTable::caseInsensitiveStringCompare(const std::string &str1, const std::string &str2) const
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+bool BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::caseInsensitiveStringCompare(const std::string &str1, const std::string &str2) const
 {
     // If the lengths differ, return false
     if (str1.size() != str2.size())
@@ -54,42 +62,453 @@ bool HashTable::caseInsensitiveStringCompare(const std::string &str1, const std:
     return true;
 }
 
+/*
+Compute the fingerprint identifying a track by its artist and title, folded by the key policy
+@param title the title of the track
+@param artist the artist of the track
+@return the 64-bit FNV-1a hash of the folded artist and title
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+uint64_t BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::fingerprint(const std::string &title, const std::string &artist)
+{
+    uint64_t hashValue = 14695981039346656037ULL;
+    auto addByte = [&hashValue](unsigned char c)
+    {
+        hashValue ^= c;
+        hashValue *= 1099511628211ULL;
+    };
+
+    for (char c : artist)
+    {
+        addByte(static_cast<unsigned char>(KeyPolicy::fold(c)));
+    }
+    // 0xFF never appears in UTF-8 text, so it cannot be confused with a character of either field
+    addByte(0xFF);
+    for (char c : title)
+    {
+        addByte(static_cast<unsigned char>(KeyPolicy::fold(c)));
+    }
+    return hashValue;
+}
+
+/*
+Check whether two tracks have the same title and artist under the key policy
+@param track1 the first track
+@param track2 the second track
+@return true if both tracks have the same title and artist, false otherwise
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+bool BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::isSameTrack(const Track &track1, const Track &track2) const
+{
+    return keysEqual<KeyPolicy>(track1.getTitle(), track2.getTitle()) &&
+           keysEqual<KeyPolicy>(track1.getArtist(), track2.getArtist());
+}
+
+/*
+Print the error for a track rejected as a duplicate
+@param existingLineNumber the line number of the track already stored
+@param track the rejected track
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::reportDuplicate(int existingLineNumber, const Track &track) const
+{
+    std::cerr << "Error: Duplicate track found";
+    if (existingLineNumber > 0)
+    {
+        std::cerr << " on line " << existingLineNumber;
+    }
+    std::cerr << ": Track \"" << track.getTitle() << "\" by artist \"" << track.getArtist() << ". Skipping track." << std::endl;
+}
+
+/*
+Check whether a node holds a track under the key policy
+The title is compared in place in the arena, the artist's name is only decoded once the titles agree
+@param id the id of the node to check
+@param title the title of the track
+@param artist the artist of the track
+@return true if the node holds the track, false otherwise
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+bool BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::nodeMatches(uint32_t id, const std::string &title, const std::string &artist) const
+{
+    const TrackRecord &record = nodes[id].record;
+    return keysEqual<KeyPolicy>(titleData.data() + record.titleOffset, record.titleLength, title) &&
+           keysEqual<KeyPolicy>(artists.getName(record.artistId), artist);
+}
+
+/*
+Check that the title of a track fits in a record, so it is never stored cut and then never found again
+@param track the track about to be stored, reported if its title is too long
+@return true if the title fits, false otherwise
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+bool BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::titleFits(const Track &track) const
+{
+    if (track.getTitle().size() <= maxTitleLength)
+    {
+        return true;
+    }
+    std::cerr << "Error: Title of " << track.getTitle().size() << " bytes is longer than " << maxTitleLength
+              << " bytes: Track by artist \"" << track.getArtist() << ". Skipping track." << std::endl;
+    return false;
+}
+
+/*
+Make room for the id of a new node, reclaiming removed nodes when every id is taken
+@param track the track about to be stored, reported if there is no room
+@return true if a node can be created, false otherwise
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+bool BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::makeRoomForNode(const Track &track)
+{
+    if (nodes.size() < maxNodes)
+    {
+        return true;
+    }
+    compactNodes();
+    if (nodes.size() < maxNodes)
+    {
+        return true;
+    }
+    std::cerr << "Error: The hash table already holds " << maxNodes << " tracks: Track \"" << track.getTitle()
+              << "\" by artist \"" << track.getArtist() << ". Skipping track." << std::endl;
+    return false;
+}
+
+/*
+Create a node for a track, adding its title to the arena and its artist to the dictionary
+@param track the track to store
+@param trackFingerprint the fingerprint of the title and artist
+@return the id of the new node, not linked yet
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+uint32_t BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::createNode(const Track &track, uint64_t trackFingerprint)
+{
+    uint32_t id = static_cast<uint32_t>(nodes.size());
+    TrackNode node = {};
+    node.record.titleOffset = titleData.size();
+    node.record.titleLength = track.getTitle().size(); // Checked by titleFits
+    node.record.artistId = artists.intern(track.getArtist(), HashPolicy::template hash<KeyPolicy>(track.getArtist()));
+    node.record.duration = track.getDuration();
+    node.next = node.prev = node.nextInKey = noNode;
+    node.fingerprint = trackFingerprint;
+    titleData.append(track.getTitle());
+    nodes.push_back(node);
+    if (keepLineNumbers)
+    {
+        lineNumbers.push_back(track.getLineNumber());
+    }
+    return id;
+}
+
+/*
+Get the line number a node was loaded from
+@param id the id of the node
+@return the line number, or 0 once line numbers are discarded
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+int BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::lineNumberOf(uint32_t id) const
+{
+    return keepLineNumbers ? lineNumbers[id] : 0;
+}
+
+/*
+Rebuild the track stored in a node
+@param id the id of the node
+@param artist the name of the node's artist, already decoded by the caller
+@return a copy of the track
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+Track BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::makeTrack(uint32_t id, const std::string &artist) const
+{
+    const TrackRecord &record = nodes[id].record;
+    return Track(lineNumberOf(id), titleData.substr(record.titleOffset, record.titleLength), artist, record.duration);
+}
+
+/*
+Rebuild the track stored in a node
+@param id the id of the node
+@return a copy of the track
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+Track BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::makeTrack(uint32_t id) const
+{
+    return makeTrack(id, artists.getName(nodes[id].record.artistId));
+}
+
+/*
+Find the bucket of a node's artist from the hash kept by the dictionary, without decoding the name
+@param id the id of the node
+@return the index of the bucket
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+size_t BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::bucketOf(uint32_t id) const
+{
+    return capacity.bucket(artists.getHash(nodes[id].record.artistId));
+}
+
+/*
+Find the node of a track by its title and artist
+@param title the title of the track
+@param artist the artist of the track
+@param trackFingerprint the fingerprint of the title and artist
+@return the id of the node of the track, or noNode if it is not stored
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+uint32_t BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::findNode(const std::string &title, const std::string &artist, uint64_t trackFingerprint) const
+{
+    counters.keyLookups.add();
+    uint64_t probes = 0;
+    uint32_t current = keyTable[capacity.bucket(trackFingerprint)];
+    while (current != noNode)
+    {
+        probes++;
+        // Compare the strings only when the fingerprints agree
+        if (nodes[current].fingerprint == trackFingerprint && nodeMatches(current, title, artist))
+        {
+            break;
+        }
+        current = nodes[current].nextInKey;
+    }
+    counters.keyProbes.add(probes);
+    return current;
+}
+
+/*
+Append a node to its artist bucket and push it on its key bucket
+@param id the id of the node to place, its next, prev and nextInKey links are overwritten
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::placeNode(uint32_t id)
+{
+    TrackNode &node = nodes[id];
+
+    // Append the node at the end of its artist's list
+    size_t index = bucketOf(id);
+    node.next = noNode;
+    node.prev = tails[index];
+    if (tails[index] != noNode)
+    {
+        nodes[tails[index]].next = id;
+    }
+    else
+    {
+        table[index] = id;
+    }
+    tails[index] = id;
+
+    // Push the node at the front of its key bucket
+    size_t keyIndex = capacity.bucket(node.fingerprint);
+    node.nextInKey = keyTable[keyIndex];
+    keyTable[keyIndex] = id;
+}
+
+/*
+Link a new node into its artist bucket and its key bucket, and register it with the secondary indexes
+The table doubles in size once it holds more tracks than buckets
+@param id the id of the new node
+@param track the track stored in the node, saving a copy of its title and a lookup in the dictionary
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::linkNode(uint32_t id, const Track &track)
+{
+    placeNode(id);
+
+    // An artist getting its first track, or its first again after losing them all, goes into the filter
+    uint32_t artistId = nodes[id].record.artistId;
+    if (artistId >= artistTrackCounts.size())
+    {
+        artistTrackCounts.resize(artistId + 1, 0);
+    }
+    if (artistTrackCounts[artistId]++ == 0 && filterArtists)
+    {
+        artistFilter.add(artists.getHash(artistId));
+        if (artistFilter.isOverloaded())
+        {
+            rebuildArtistFilter();
+        }
+    }
+
+    // A prolific artist is sorted once here, then each of its tracks is added in place
+    invalidateSearch(track.getArtist());
+    if (!artistOrders.isEmpty() || artistTrackCounts[artistId] >= minOrderedTracks)
+    {
+        std::string key = searchKey(track.getArtist());
+        if (artistOrders.contains(key))
+        {
+            artistOrders.add(key, id, track.getDuration(), titleOrder());
+        }
+        else if (artistTrackCounts[artistId] >= minOrderedTracks)
+        {
+            std::vector<uint32_t> ids = collectNodes(track.getArtist());
+            std::vector<std::pair<int, uint32_t>> durations;
+            durations.reserve(ids.size());
+            for (uint32_t artistNode : ids)
+            {
+                durations.emplace_back(nodes[artistNode].record.duration, artistNode);
+            }
+            artistOrders.build(key, std::move(ids), std::move(durations), titleOrder());
+        }
+    }
+    titleIndex.add(id, track.getTitle());
+    artistIndex.add(track.getArtist(), artistId);
+    durationIndex.add(track.getDuration(), id);
+    numTracks++;
+    version = nextVersion();
+    counters.inserts.add();
+
+    // A fixed capacity compiles the check away
+    if (CapacityPolicy::growable && numTracks > capacity.size() * maxLoadFactor)
+    {
+        rehash(capacity.size() * 2);
+    }
+}
+
+/*
+Change the number of buckets, relinking every node
+Tracks by the same artist keep their relative order
+@param newTableSize the new number of buckets
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::rehash(size_t newTableSize)
+{
+    std::vector<uint32_t> oldTable(std::move(table));
+
+    capacity.resize(newTableSize);
+    table.assign(capacity.size(), noNode);
+    tails.assign(capacity.size(), noNode);
+    keyTable.assign(capacity.size(), noNode);
+
+    // Walking the old lists in order keeps each artist's tracks in insertion order
+    for (uint32_t head : oldTable)
+    {
+        uint32_t current = head;
+        while (current != noNode)
+        {
+            uint32_t nextNode = nodes[current].next;
+            placeNode(current);
+            current = nextNode;
+        }
+    }
+    counters.resizes.add();
+}
+
 /*
 Insert track into the hash table
 @param track the track to insert into the hash table
+@param reportDuplicates false to skip a duplicate without printing an error
+@return whether the track was inserted, already stored or refused
 */
-void HashTable::insert(const Track &track)
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+InsertResult BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::insert(const Track &track, bool reportDuplicates)
 {
-    size_t index = hash(track.getArtist());
-    TrackNode *newNode = new TrackNode{track, nullptr};
-    // If the index is empty, insert the new node
-    if (!table[index])
+    ScopedLatencyTimer timer(Operation::Insert);
+    if (!titleFits(track))
     {
-        table[index] = newNode;
+        return InsertResult::Refused;
     }
-    else
+
+    // Check for duplicates through the key index rather than the artist's list
+    uint64_t trackFingerprint = fingerprint(track.getTitle(), track.getArtist());
+    uint32_t existingNode = findNode(track.getTitle(), track.getArtist(), trackFingerprint);
+    if (existingNode != noNode)
+    {
+        if (reportDuplicates)
+        {
+            reportDuplicate(lineNumberOf(existingNode), track);
+        }
+        counters.duplicateRejects.add();
+        return InsertResult::Duplicate;
+    }
+    if (!makeRoomForNode(track))
+    {
+        return InsertResult::Refused;
+    }
+
+    linkNode(createNode(track, trackFingerprint), track);
+    return InsertResult::Inserted;
+}
+
+/*
+Insert many tracks into the hash table, skipping duplicates
+@param tracks the tracks to insert, in order
+@param reportDuplicates false to skip duplicates without printing an error for each
+@return the number of tracks inserted
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+size_t BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::insertMany(const std::vector<Track> &tracks, bool reportDuplicates)
+{
+    ScopedLatencyTimer timer(Operation::InsertMany);
+    std::vector<uint64_t> fingerprints(tracks.size());
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        fingerprints[i] = fingerprint(tracks[i].getTitle(), tracks[i].getArtist());
+    }
+
+    // Sort the batch by fingerprint so duplicates within it end up next to each other
+    std::vector<size_t> order(tracks.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&fingerprints](size_t lhs, size_t rhs)
+              { return fingerprints[lhs] != fingerprints[rhs] ? fingerprints[lhs] < fingerprints[rhs] : lhs < rhs; });
+
+    // Within a run of equal fingerprints keep the first occurrence of every distinct track
+    std::vector<bool> keep(tracks.size(), true);
+    for (size_t runStart = 0; runStart < order.size();)
+    {
+        size_t runEnd = runStart + 1;
+        while (runEnd < order.size() && fingerprints[order[runEnd]] == fingerprints[order[runStart]])
+        {
+            runEnd++;
+        }
+        for (size_t later = runStart + 1; later < runEnd; ++later)
+        {
+            for (size_t earlier = runStart; earlier < later; ++earlier)
+            {
+                if (keep[order[earlier]] && isSameTrack(tracks[order[earlier]], tracks[order[later]]))
+                {
+                    if (reportDuplicates)
+                    {
+                        reportDuplicate(tracks[order[earlier]].getLineNumber(), tracks[order[later]]);
+                    }
+                    counters.duplicateRejects.add();
+                    keep[order[later]] = false;
+                    break;
+                }
+            }
+        }
+        runStart = runEnd;
+    }
+
+    // Insert the rest in order, checking the tracks already stored through the key index
+    nodes.reserve(nodes.size() + std::count(keep.begin(), keep.end(), true));
+    size_t inserted = 0;
+    for (size_t i = 0; i < tracks.size(); ++i)
     {
-        // If the index is not empty, iterate through the linked list and check for duplicates
-        TrackNode *currentNode = table[index];
-        TrackNode *prevNode = nullptr;
-        int lineNumber = 1;
-        while (currentNode)
+        if (!keep[i] || !titleFits(tracks[i]))
         {
-            // Check for duplicates
-            if (caseInsensitiveStringCompare(currentNode->track.getTitle(), track.getTitle()) &&
-                caseInsensitiveStringCompare(currentNode->track.getArtist(), track.getArtist()))
+            continue;
+        }
+        uint32_t existingNode = findNode(tracks[i].getTitle(), tracks[i].getArtist(), fingerprints[i]);
+        if (existingNode != noNode)
+        {
+            if (reportDuplicates)
             {
-                std::cerr << "Error: Duplicate track found on line " << currentNode->track.getLineNumber() << ": Track \"" << track.getTitle() << "\" by artist \"" << track.getArtist() << ". Skipping track." << std::endl;
-                delete newNode;
-                return;
+                reportDuplicate(lineNumberOf(existingNode), tracks[i]);
             }
-            prevNode = currentNode;
-            currentNode = currentNode->next;
-            lineNumber++;
+            counters.duplicateRejects.add();
+            continue;
+        }
+        if (!makeRoomForNode(tracks[i]))
+        {
+            break; // No later track fits either
         }
-        // Insert new node at the end of the list
-        prevNode->next = newNode;
+        linkNode(createNode(tracks[i], fingerprints[i]), tracks[i]);
+        inserted++;
     }
+    return inserted;
 }
 
 /*
@@ -98,35 +517,370 @@ Remove track from the hash table
 @param artist the artist of the track to remove
 @return true if the track was removed, false otherwise
 */
-bool HashTable::remove(const std::string &title, const std::string &artist)
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+bool BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::remove(const std::string &title, const std::string &artist)
 {
-    size_t index = hash(artist);
-    TrackNode *currentNode = table[index];
-    TrackNode *prevNode = nullptr;
+    ScopedLatencyTimer timer(Operation::Remove);
+    // Find the track and its predecessor in its key bucket
+    uint64_t trackFingerprint = fingerprint(title, artist);
+    size_t keyIndex = capacity.bucket(trackFingerprint);
+    uint32_t currentNode = keyTable[keyIndex];
+    uint32_t prevInKey = noNode;
+    uint64_t probes = 0;
+    while (currentNode != noNode && !(nodes[currentNode].fingerprint == trackFingerprint && nodeMatches(currentNode, title, artist)))
+    {
+        probes++;
+        prevInKey = currentNode;
+        currentNode = nodes[currentNode].nextInKey;
+    }
+    counters.keyLookups.add();
+    counters.keyProbes.add(currentNode != noNode ? probes + 1 : probes);
+    if (currentNode == noNode)
+    {
+        counters.removeMisses.add();
+        return false;
+    }
 
-    // Iterate through the linked list and search for the track
-    while (currentNode)
+    unlinkNode(currentNode, prevInKey);
+    reclaimNodes();
+    return true;
+}
+
+/*
+Remove many tracks from the hash table
+Requests falling in the same bucket of the (artist, title) index are grouped so each bucket is walked once
+@param tracks pairs of title and artist of the tracks to remove
+@return for every request, true if the track was removed, false otherwise
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::vector<bool> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::removeMany(const std::vector<std::pair<std::string, std::string>> &tracks)
+{
+    ScopedLatencyTimer timer(Operation::RemoveMany);
+    std::vector<uint64_t> fingerprints(tracks.size());
+    for (size_t i = 0; i < tracks.size(); ++i)
     {
-        // If the track is found, remove it
-        if (caseInsensitiveStringCompare(currentNode->track.getTitle(), title) &&
-            caseInsensitiveStringCompare(currentNode->track.getArtist(), artist))
+        fingerprints[i] = fingerprint(tracks[i].first, tracks[i].second);
+    }
+
+    // Order the requests by key bucket
+    std::vector<size_t> order(tracks.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs)
+              { return capacity.bucket(fingerprints[lhs]) < capacity.bucket(fingerprints[rhs]); });
+
+    std::vector<bool> removed(tracks.size(), false);
+    for (size_t groupStart = 0; groupStart < order.size();)
+    {
+        size_t keyIndex = capacity.bucket(fingerprints[order[groupStart]]);
+        size_t groupEnd = groupStart + 1;
+        while (groupEnd < order.size() && capacity.bucket(fingerprints[order[groupEnd]]) == keyIndex)
         {
-            // Update the previous node's next pointer
-            if (prevNode)
+            groupEnd++;
+        }
+
+        // Walk the bucket once, matching every node against the requests of the group
+        uint32_t prevInKey = noNode;
+        uint32_t currentNode = keyTable[keyIndex];
+        counters.keyLookups.add(groupEnd - groupStart);
+        while (currentNode != noNode)
+        {
+            counters.keyProbes.add();
+            uint32_t nextInKey = nodes[currentNode].nextInKey;
+            bool matched = false;
+            for (size_t k = groupStart; k < groupEnd && !matched; ++k)
+            {
+                size_t request = order[k];
+                if (!removed[request] && nodes[currentNode].fingerprint == fingerprints[request] &&
+                    nodeMatches(currentNode, tracks[request].first, tracks[request].second))
+                {
+                    removed[request] = true;
+                    matched = true;
+                }
+            }
+            if (matched)
             {
-                prevNode->next = currentNode->next;
+                unlinkNode(currentNode, prevInKey);
             }
             else
             {
-                table[index] = currentNode->next;
+                prevInKey = currentNode;
             }
-            delete currentNode;
-            return true;
+            currentNode = nextInKey;
         }
-        prevNode = currentNode;
-        currentNode = currentNode->next;
+        groupStart = groupEnd;
+    }
+    counters.removeMisses.add(std::count(removed.begin(), removed.end(), false));
+    reclaimNodes(); // Only once no bucket is being walked, as ids change
+    return removed;
+}
+
+/*
+Unlink a node from both indexes and the secondary indexes, then free its title
+@param id the id of the node to remove
+@param prevInKey the node before it in its key bucket, or noNode if it is the first
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::unlinkNode(uint32_t id, uint32_t prevInKey)
+{
+    TrackNode &node = nodes[id];
+
+    // Unlink the node from its key bucket
+    if (prevInKey != noNode)
+    {
+        nodes[prevInKey].nextInKey = node.nextInKey;
+    }
+    else
+    {
+        keyTable[capacity.bucket(node.fingerprint)] = node.nextInKey;
+    }
+
+    // Unlink the node from its artist's list using its neighbours
+    size_t index = bucketOf(id);
+    if (node.prev != noNode)
+    {
+        nodes[node.prev].next = node.next;
+    }
+    else
+    {
+        table[index] = node.next;
+    }
+    if (node.next != noNode)
+    {
+        nodes[node.next].prev = node.prev;
+    }
+    else
+    {
+        tails[index] = node.prev;
+    }
+
+    // The artist's name stays in the dictionary, its id is kept for any later track by the artist
+    TrackRecord &record = node.record;
+    std::string artist = artists.getName(record.artistId);
+    invalidateSearch(artist);
+    if (!artistOrders.isEmpty())
+    {
+        artistOrders.remove(searchKey(artist), id, record.duration, titleOrder());
+    }
+    titleIndex.remove(id, titleData.substr(record.titleOffset, record.titleLength));
+    artistIndex.remove(artist);
+    durationIndex.remove(record.duration, id);
+    freedTitleBytes += record.titleLength;
+    record.titleLength = 0;
+
+    // Artists cannot be taken out of the filter, so it is rebuilt once enough of them have no track left
+    if (--artistTrackCounts[record.artistId] == 0 && filterArtists &&
+        ++emptiedArtists > std::max(minFilterArtists, artistFilter.size() / 4))
+    {
+        rebuildArtistFilter();
+    }
+    record.artistId = ArtistDictionary::notFound; // Marks the node as removed until it is reclaimed
+    node.next = node.prev = node.nextInKey = noNode;
+    numTracks--;
+    version = nextVersion();
+    counters.removes.add();
+
+    // Copy the arena once removed titles make up most of it, so its cost stays amortised
+    if (freedTitleBytes > titleData.size() / 2 && freedTitleBytes > (1 << 16))
+    {
+        compactTitles();
+    }
+}
+
+/*
+Copy the titles of the remaining nodes into a new arena, dropping the bytes of removed ones
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::compactTitles()
+{
+    std::string compacted;
+    compacted.reserve(titleData.size() - freedTitleBytes);
+    for (TrackNode &node : nodes)
+    {
+        TrackRecord &record = node.record;
+        uint64_t offset = compacted.size();
+        compacted.append(titleData, record.titleOffset, record.titleLength);
+        record.titleOffset = offset;
+    }
+    titleData.swap(compacted);
+    freedTitleBytes = 0;
+}
+
+/*
+Drop removed nodes and renumber the rest once removed nodes outnumber them, so the cost stays amortised
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::reclaimNodes()
+{
+    size_t removedNodes = nodes.size() - numTracks;
+    if (removedNodes > numTracks && removedNodes >= minReclaimedNodes)
+    {
+        compactNodes();
+    }
+}
+
+/*
+Drop removed nodes and renumber the rest in the same order, then follow the new ids in every index
+Ids only ever decrease and keep their order, so the sorted secondary indexes are renumbered in place
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::compactNodes()
+{
+    std::vector<uint32_t> newIds(nodes.size(), noNode);
+    uint32_t keptNodes = 0;
+    for (uint32_t id = 0; id < nodes.size(); ++id)
+    {
+        if (nodes[id].record.artistId != ArtistDictionary::notFound)
+        {
+            newIds[id] = keptNodes++;
+        }
+    }
+    auto remap = [&newIds](uint32_t id)
+    {
+        return id == noNode ? noNode : newIds[id];
+    };
+
+    for (uint32_t id = 0; id < nodes.size(); ++id)
+    {
+        if (newIds[id] == noNode)
+        {
+            continue;
+        }
+        TrackNode &node = nodes[newIds[id]];
+        node = nodes[id];
+        node.next = remap(node.next);
+        node.prev = remap(node.prev);
+        node.nextInKey = remap(node.nextInKey);
+        if (keepLineNumbers)
+        {
+            lineNumbers[newIds[id]] = lineNumbers[id];
+        }
+    }
+    nodes.resize(keptNodes);
+    nodes.shrink_to_fit();
+    if (keepLineNumbers)
+    {
+        lineNumbers.resize(keptNodes);
+        lineNumbers.shrink_to_fit();
+    }
+    for (std::vector<uint32_t> *heads : {&table, &tails, &keyTable})
+    {
+        for (uint32_t &head : *heads)
+        {
+            head = remap(head);
+        }
+    }
+
+    titleIndex.remapIds(newIds);
+    durationIndex.remapIds(newIds);
+    artistOrders.remapIds(newIds);
+    if (freedTitleBytes > 0)
+    {
+        compactTitles();
+    }
+}
+
+/*
+Refill the artist filter with the artists that still have tracks
+It is sized for twice as many, so artists added later seldom overload it before the next rebuild
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::rebuildArtistFilter()
+{
+    size_t liveArtists = artistTrackCounts.size() - std::count(artistTrackCounts.begin(), artistTrackCounts.end(), 0u);
+    artistFilter.reset(std::max(minFilterArtists, liveArtists * 2));
+    for (uint32_t artistId = 0; artistId < artistTrackCounts.size(); ++artistId)
+    {
+        if (artistTrackCounts[artistId] > 0)
+        {
+            artistFilter.add(artists.getHash(artistId));
+        }
+    }
+    emptiedArtists = 0;
+}
+
+/*
+Turn the filter checked by search before the artist dictionary on or off
+@param enabled true to build the filter from the stored artists, false to free it
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::setArtistFilter(bool enabled)
+{
+    filterArtists = enabled;
+    if (enabled)
+    {
+        rebuildArtistFilter();
+    }
+    else
+    {
+        artistFilter.reset(0);
+    }
+}
+
+/*
+Find a track by its title and artist
+@param title the title of the track
+@param artist the artist of the track
+@return a copy of the stored track, or no value if it is not stored
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::optional<Track> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::find(const std::string &title, const std::string &artist) const
+{
+    uint32_t node = findNode(title, artist, fingerprint(title, artist));
+    if (node == noNode)
+    {
+        return std::nullopt;
+    }
+    return makeTrack(node);
+}
+
+/*
+Get the number of tracks in the hash table
+@return the number of tracks stored
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+size_t BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::size() const
+{
+    return numTracks;
+}
+
+/*
+Get the version of the stored tracks
+@return the version, equal between two calls only if they were made on the same table and no track changed in between
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+uint64_t BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::getVersion() const
+{
+    return version;
+}
+
+/*
+Fold an artist name into the key of its search results, every spelling the key policy treats as equal sharing it
+@param artist the artist name
+@return the key of the artist's search results
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::string BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::searchKey(const std::string &artist)
+{
+    std::string key(artist);
+    std::transform(key.begin(), key.end(), key.begin(), KeyPolicy::fold);
+    return key;
+}
+
+/*
+Drop the cached search results of an artist whose tracks changed
+Bulk loads into a table nobody searched yet skip the folding entirely
+@param artist the artist of the track inserted or removed
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::invalidateSearch(const std::string &artist)
+{
+    if (!searchCache.isEmpty())
+    {
+        searchCache.invalidate(searchKey(artist));
     }
-    return false;
 }
 
 /*
@@ -134,65 +888,482 @@ Search for tracks by artist
 @param artist the artist name to search for
 @return a vector of Track objects that match the given artist
 */
-std::vector<Track> HashTable::search(const std::string &artist) const
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::vector<Track> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::search(const std::string &artist) const
+{
+    ScopedLatencyTimer timer(Operation::Search);
+    if (searchCache.isEnabled())
+    {
+        return *searchThroughCache(artist);
+    }
+    return collectTracks(artist);
+}
+
+/*
+Search for tracks by artist without copying a cached result
+@param artist the artist name to search for
+@return the Track objects that match the given artist, shared with the search cache and never changed
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::shared_ptr<const std::vector<Track>> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::searchShared(const std::string &artist) const
+{
+    ScopedLatencyTimer timer(Operation::Search);
+    if (searchCache.isEnabled())
+    {
+        return searchThroughCache(artist);
+    }
+    return std::make_shared<const std::vector<Track>>(collectTracks(artist));
+}
+
+/*
+Answer a search from the cache, caching the tracks collected on a miss
+Searches finding nothing are left to the artist filter rather than taking room in the cache
+@param artist the artist name to search for
+@return the Track objects that match the given artist
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::shared_ptr<const std::vector<Track>> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::searchThroughCache(const std::string &artist) const
+{
+    std::string key = searchKey(artist);
+    std::shared_ptr<const std::vector<Track>> result = searchCache.find(key);
+    if (result)
+    {
+        counters.searches.add();
+        return result;
+    }
+    result = std::make_shared<const std::vector<Track>>(collectTracks(artist));
+    if (!result->empty())
+    {
+        searchCache.store(key, result);
+    }
+    return result;
+}
+
+/*
+Change the number of tracks the search cache may hold, dropping every cached result
+@param capacity the number of tracks in total, 0 to turn the cache off
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::setSearchCacheCapacity(size_t capacity)
+{
+    searchCache.setCapacity(capacity);
+}
+
+/*
+Search for one page of the tracks of an artist, sorted by title or by duration
+Artists kept by the artist order index are read from it, the tracks of others are collected and sorted up to the end of the page
+Nothing is built here, so pages may be read together between changes
+@param artist the artist name to search for
+@param order the order of the tracks, titles ignoring case as the key policy does
+@param offset the number of tracks to skip
+@param limit the largest number of tracks to return
+@return the tracks of the page and the number of tracks of the artist
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+TrackPage BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::searchPage(const std::string &artist, TrackOrder order, size_t offset, size_t limit) const
+{
+    ScopedLatencyTimer timer(Operation::Search);
+    TrackPage page = {};
+    std::string key = searchKey(artist);
+    counters.searches.add();
+    if (artistOrders.contains(key))
+    {
+        page.totalTracks = artistOrders.count(key);
+        page.tracks = makeTracks(artistOrders.page(key, order, offset, limit));
+        return page;
+    }
+
+    std::vector<uint32_t> ids = collectNodes(artist);
+    page.totalTracks = ids.size();
+    if (offset >= ids.size())
+    {
+        return page;
+    }
+
+    // Rows past the end of the page are left unsorted
+    size_t last = offset + std::min(limit, ids.size() - offset);
+    std::vector<uint32_t> pageIds;
+    if (order == TrackOrder::Title)
+    {
+        std::partial_sort(ids.begin(), ids.begin() + last, ids.end(), [this](uint32_t lhs, uint32_t rhs)
+                          { return titleBefore(lhs, rhs); });
+        pageIds.assign(ids.begin() + offset, ids.begin() + last);
+    }
+    else
+    {
+        std::vector<std::pair<int, uint32_t>> durations;
+        durations.reserve(ids.size());
+        for (uint32_t id : ids)
+        {
+            durations.emplace_back(nodes[id].record.duration, id);
+        }
+        std::partial_sort(durations.begin(), durations.begin() + last, durations.end());
+        for (size_t row = offset; row < last; ++row)
+        {
+            pageIds.push_back(durations[row].second);
+        }
+    }
+    page.tracks = makeTracks(pageIds);
+    return page;
+}
+
+/*
+Order two nodes by title the way the key policy compares them, reading the titles in place in the arena
+@param lhs the id of the first node
+@param rhs the id of the second node
+@return true if the first title comes first, or the titles are equal and the first id is smaller
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+bool BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::titleBefore(uint32_t lhs, uint32_t rhs) const
+{
+    const TrackRecord &lhsRecord = nodes[lhs].record;
+    const TrackRecord &rhsRecord = nodes[rhs].record;
+    const char *lhsTitle = titleData.data() + lhsRecord.titleOffset;
+    const char *rhsTitle = titleData.data() + rhsRecord.titleOffset;
+    if (keyBefore<KeyPolicy>(lhsTitle, lhsRecord.titleLength, rhsTitle, rhsRecord.titleLength))
+    {
+        return true;
+    }
+    if (keyBefore<KeyPolicy>(rhsTitle, rhsRecord.titleLength, lhsTitle, lhsRecord.titleLength))
+    {
+        return false;
+    }
+    return lhs < rhs;
+}
+
+/*
+Get titleBefore as the order the artist order index keeps titles in
+@return the order of node ids by title
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+ArtistOrderIndex::TitleLess BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::titleOrder() const
+{
+    return [this](uint32_t lhs, uint32_t rhs)
+    {
+        return titleBefore(lhs, rhs);
+    };
+}
+
+/*
+Rebuild the tracks of some nodes
+@param ids the ids of the nodes, usually of a single artist
+@return a vector of Track objects in the order of the ids
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::vector<Track> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::makeTracks(const std::vector<uint32_t> &ids) const
 {
-    size_t index = hash(artist);
     std::vector<Track> result;
-    TrackNode *currentNode = table[index];
-    // Iterate through the linked list and add matching tracks to the result vector
-    while (currentNode)
+    result.reserve(ids.size());
+    // Spellings of one artist seldom alternate, so the last name decoded is usually reused
+    uint32_t lastArtistId = ArtistDictionary::notFound;
+    std::string artistName;
+    for (uint32_t id : ids)
     {
-        if (caseInsensitiveStringCompare(currentNode->track.getArtist(), artist))
+        if (nodes[id].record.artistId != lastArtistId)
         {
-            result.push_back(currentNode->track);
+            lastArtistId = nodes[id].record.artistId;
+            artists.getName(lastArtistId, artistName);
         }
-        currentNode = currentNode->next;
+        result.push_back(makeTrack(id, artistName));
     }
     return result;
 }
 
 /*
-Hash function for artist string
-@param key the artist string to hash
-@return the hash value for the given artist string
+Collect the tracks of an artist by walking its bucket
+@param artist the artist name to search for
+@return a vector of Track objects that match the given artist
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::vector<Track> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::collectTracks(const std::string &artist) const
+{
+    counters.searches.add();
+    return makeTracks(collectNodes(artist));
+}
+
+/*
+Collect the ids of an artist's nodes by walking its bucket
+@param artist the artist name to search for
+@return the ids of the nodes that match the given artist, in the order of the bucket
 */
-size_t HashTable::hash(const std::string &key) const
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::vector<uint32_t> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::collectNodes(const std::string &artist) const
 {
-    // Convert the key to lowercase
-    std::string keyLowerCase = key;
-    for (char &c : keyLowerCase)
+    std::vector<uint32_t> result;
+
+    // Most artists without tracks are turned away by the filter, reading a single cache line
+    uint64_t artistHash = HashPolicy::template hash<KeyPolicy>(artist);
+    if (!artistFilter.mayContain(artistHash))
+    {
+        counters.filterRejects.add();
+        return result;
+    }
+
+    // Resolve the name to the ids of its spellings next, an unknown artist never touches the table
+    std::vector<uint32_t> artistIds;
+    if (KeyPolicy::caseSensitive)
+    {
+        uint32_t artistId = artists.find(artist, artistHash);
+        if (artistId != ArtistDictionary::notFound)
+        {
+            artistIds.push_back(artistId);
+        }
+    }
+    else
+    {
+        artistIds = artists.findIgnoringCase(artist, artistHash);
+    }
+    // Spellings whose tracks were all removed stay in the dictionary
+    artistIds.erase(std::remove_if(artistIds.begin(), artistIds.end(), [this](uint32_t artistId)
+                                   { return artistTrackCounts[artistId] == 0; }),
+                    artistIds.end());
+    if (artistIds.empty())
+    {
+        return result;
+    }
+
+    // Every spelling shares the hash, and so the bucket
+    uint32_t currentNode = table[capacity.bucket(artistHash)];
+    uint64_t probes = 0;
+    // Iterate through the linked list and add nodes whose artist id matches to the result vector
+    while (currentNode != noNode)
     {
-        c = tolower(static_cast<unsigned char>(c));
+        probes++;
+        if (std::find(artistIds.begin(), artistIds.end(), nodes[currentNode].record.artistId) != artistIds.end())
+        {
+            result.push_back(currentNode);
+        }
+        currentNode = nodes[currentNode].next;
     }
+    counters.searchProbes.add(probes);
+    return result;
+}
 
-    // Implement the djb2 hash function
-    size_t hashValue = 5381;
-    for (char c : keyLowerCase)
+/*
+Search for tracks by words in their title
+@param query the words to search for
+@param matchAllWords true to require every word, false to require any word
+@return a vector of Track objects whose title matches the query
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::vector<Track> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::searchByTitle(const std::string &query, bool matchAllWords) const
+{
+    std::vector<Track> result;
+    for (uint32_t id : titleIndex.find(query, matchAllWords))
     {
-        hashValue = ((hashValue << 5) + hashValue) + c; // hash * 33 + c
+        result.push_back(makeTrack(id));
     }
+    return result;
+}
 
-    return hashValue % tableSize;
+/*
+Find the artists whose name is close to a possibly misspelled name
+@param artist the artist name to match
+@param maxDistance the largest number of single character edits to accept
+@return the matching artists ordered by distance
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::vector<ArtistMatch> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::findSimilarArtists(const std::string &artist, size_t maxDistance) const
+{
+    return artistIndex.find(artist, maxDistance, artists);
+}
+
+/*
+Count the tracks within a duration range
+@param minDuration the shortest duration in seconds, inclusive
+@param maxDuration the longest duration in seconds, inclusive
+@return the number of tracks within the range
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+size_t BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::countByDuration(int minDuration, int maxDuration) const
+{
+    return durationIndex.count(minDuration, maxDuration);
+}
+
+/*
+Search for tracks within a duration range
+@param minDuration the shortest duration in seconds, inclusive
+@param maxDuration the longest duration in seconds, inclusive
+@return a vector of Track objects within the range, ordered by duration
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::vector<Track> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::searchByDuration(int minDuration, int maxDuration) const
+{
+    std::vector<Track> result;
+    for (uint32_t id : durationIndex.find(minDuration, maxDuration))
+    {
+        result.push_back(makeTrack(id));
+    }
+    return result;
+}
+
+/*
+Find the bucket of an artist string with the hash and capacity policies
+@param key the artist string to hash
+@return the bucket of the given artist string
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+size_t BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::hash(const std::string &key) const
+{
+    return capacity.bucket(HashPolicy::template hash<KeyPolicy>(key));
 }
 
 /*
 Get all tracks in the hash table
 @return a vector of all Track objects in the hash table
 */
-std::vector<Track> HashTable::getAllTracks() const
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+std::vector<Track> BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::getAllTracks() const
 {
     std::vector<Track> allTracks;
+    allTracks.reserve(numTracks);
 
     // Iterate through the table and collect all tracks
-    for (size_t i = 0; i < tableSize; ++i)
+    forEachTrack([&allTracks](const Track &track)
+                 { allTracks.push_back(track); });
+
+    return allTracks;
+}
+
+/*
+Visit every track in the hash table without collecting them
+@param visitor the function called with each track, which only lives for the call
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::forEachTrack(const std::function<void(const Track &)> &visitor) const
+{
+    // Tracks by the same artist follow each other in a bucket, so the last name decoded is usually reused
+    uint32_t lastArtistId = ArtistDictionary::notFound;
+    std::string artistName;
+    for (size_t i = 0; i < capacity.size(); ++i)
     {
-        TrackNode *currentNode = table[i];
-        while (currentNode)
+        for (uint32_t currentNode = table[i]; currentNode != noNode; currentNode = nodes[currentNode].next)
         {
-            allTracks.push_back(currentNode->track);
-            currentNode = currentNode->next;
+            if (nodes[currentNode].record.artistId != lastArtistId)
+            {
+                lastArtistId = nodes[currentNode].record.artistId;
+                artists.getName(lastArtistId, artistName);
+            }
+            visitor(makeTrack(currentNode, artistName));
         }
     }
+}
 
-    return allTracks;
-}
\ No newline at end of file
+/*
+Stop keeping the line number of every track, freeing 4 bytes per track
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::discardLineNumbers()
+{
+    keepLineNumbers = false;
+    std::vector<int>().swap(lineNumbers);
+    version = nextVersion();
+    // Cached results still carry the line numbers
+    searchCache.clear();
+}
+
+/*
+Get the dictionary of artist names
+@return the artist dictionary
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+const ArtistDictionary &BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::getArtists() const
+{
+    return artists;
+}
+
+/*
+Take a snapshot of the counters and measure the shape of the table
+@return the statistics of the hash table
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+HashTableStats BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::getStats() const
+{
+    HashTableStats stats = {};
+    stats.countersEnabled = HASHTABLE_STATS != 0;
+    stats.tableSize = capacity.size();
+    stats.trackCount = numTracks;
+    stats.loadFactor = static_cast<double>(numTracks) / capacity.size();
+    stats.artistCount = artists.size();
+    stats.artistBytes = artists.memoryUsage() + artistTrackCounts.capacity() * sizeof(uint32_t);
+    stats.filterBytes = artistFilter.memoryUsage();
+    stats.trackBytes = nodes.capacity() * sizeof(TrackNode) + titleData.capacity() + lineNumbers.capacity() * sizeof(int);
+
+    // Walk every bucket of both indexes to find the longest lists
+    for (size_t i = 0; i < capacity.size(); ++i)
+    {
+        uint64_t chainLength = 0;
+        for (uint32_t currentNode = table[i]; currentNode != noNode; currentNode = nodes[currentNode].next)
+        {
+            chainLength++;
+        }
+        uint64_t keyChainLength = 0;
+        for (uint32_t currentNode = keyTable[i]; currentNode != noNode; currentNode = nodes[currentNode].nextInKey)
+        {
+            keyChainLength++;
+        }
+        stats.usedBuckets += chainLength > 0;
+        stats.longestChain = std::max(stats.longestChain, chainLength);
+        stats.longestKeyChain = std::max(stats.longestKeyChain, keyChainLength);
+    }
+
+    stats.inserts = counters.inserts.load();
+    stats.duplicateRejects = counters.duplicateRejects.load();
+    stats.searches = counters.searches.load();
+    stats.searchProbes = counters.searchProbes.load();
+    stats.filterRejects = counters.filterRejects.load();
+    stats.keyLookups = counters.keyLookups.load();
+    stats.keyProbes = counters.keyProbes.load();
+    stats.removes = counters.removes.load();
+    stats.removeMisses = counters.removeMisses.load();
+    stats.resizes = counters.resizes.load();
+    searchCache.fillStats(stats);
+    stats.orderedArtists = artistOrders.artistCount();
+    stats.orderedTracks = artistOrders.size();
+    return stats;
+}
+
+/*
+Write the statistics of the hash table as a single line JSON object
+@param output the stream to write to
+*/
+template <typename KeyPolicy, typename HashPolicy, typename CapacityPolicy>
+void BasicHashTable<KeyPolicy, HashPolicy, CapacityPolicy>::writeStats(std::ostream &output) const
+{
+    HashTableStats stats = getStats();
+    output << "{\"countersEnabled\":" << (stats.countersEnabled ? "true" : "false")
+           << ",\"tableSize\":" << stats.tableSize
+           << ",\"trackCount\":" << stats.trackCount
+           << ",\"loadFactor\":" << stats.loadFactor
+           << ",\"usedBuckets\":" << stats.usedBuckets
+           << ",\"longestChain\":" << stats.longestChain
+           << ",\"longestKeyChain\":" << stats.longestKeyChain
+           << ",\"artistCount\":" << stats.artistCount
+           << ",\"artistBytes\":" << stats.artistBytes
+           << ",\"filterBytes\":" << stats.filterBytes
+           << ",\"trackBytes\":" << stats.trackBytes
+           << ",\"inserts\":" << stats.inserts
+           << ",\"duplicateRejects\":" << stats.duplicateRejects
+           << ",\"searches\":" << stats.searches
+           << ",\"searchProbes\":" << stats.searchProbes
+           << ",\"filterRejects\":" << stats.filterRejects
+           << ",\"keyLookups\":" << stats.keyLookups
+           << ",\"keyProbes\":" << stats.keyProbes
+           << ",\"removes\":" << stats.removes
+           << ",\"removeMisses\":" << stats.removeMisses
+           << ",\"resizes\":" << stats.resizes
+           << ",\"cacheHits\":" << stats.cacheHits
+           << ",\"cacheMisses\":" << stats.cacheMisses
+           << ",\"cacheInvalidations\":" << stats.cacheInvalidations
+           << ",\"cacheEvictions\":" << stats.cacheEvictions
+           << ",\"cachedResults\":" << stats.cachedResults
+           << ",\"cachedTracks\":" << stats.cachedTracks
+           << ",\"orderedArtists\":" << stats.orderedArtists
+           << ",\"orderedTracks\":" << stats.orderedTracks << "}" << std::endl;
+}
+
+// Compile the configurations named in hashTable.h
+template class BasicHashTable<CaseInsensitiveKey, Djb2Hash, ModuloCapacity>;
+template class BasicHashTable<CaseInsensitiveKey, Djb2Hash, PowerOfTwoCapacity>;
+template class BasicHashTable<CaseSensitiveKey, Fnv1aHash, PowerOfTwoCapacity>;
+template class BasicHashTable<CaseInsensitiveKey, Djb2Hash, FixedCapacity<16>>;
@@ -5,41 +5,187 @@
     hashtable.h
     Author: M00826933
     Created: 11/04/23
-    Updated:
+    Updated: 19/10/26
 */
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "track.h"
+#include "artistDictionary.h"
+#include "artistFilter.h"
+#include "titleIndex.h"
+#include "fuzzyArtistIndex.h"
+#include "durationIndex.h"
+#include "artistOrderIndex.h"
+#include "hashTableStats.h"
+#include "searchCache.h"
+#include "hashTablePolicies.h"
 
-// TrackNode struct is used to store individual tracks in the HashTable
+// TrackRecord struct is the compact form of a stored track, its title lives in the table's title arena
+struct TrackRecord
+{
+    uint64_t titleOffset : 40; // Start of the title in the title arena
+    uint64_t titleLength : 24; // Longer titles are refused by the table
+    uint32_t artistId;         // Id of the artist's name in the artist dictionary
+    int32_t duration;
+};
+static_assert(sizeof(TrackRecord) == 16, "TrackRecord should stay 16 bytes");
+
+// TrackNode struct is used to store individual tracks in the HashTable, nodes refer to each other by id
 struct TrackNode
 {
-    Track track;
-    TrackNode *next;
+    TrackRecord record;
+    uint32_t next;        // Next track in the same bucket of table
+    uint32_t prev;        // Previous track in the same bucket of table
+    uint32_t nextInKey;   // Next track in the same bucket of the (artist, title) index
+    uint64_t fingerprint; // Hash of the folded artist and title, compared before the strings
+};
+
+// InsertResult enum tells what became of a track given to insert
+enum class InsertResult
+{
+    Inserted,
+    Duplicate, // A track with the same title and artist is already stored
+    Refused    // The track cannot be stored, its title is too long or every node id is taken
+};
+
+// TrackPage struct is one page of the tracks of an artist and the number of tracks it was taken from
+struct TrackPage
+{
+    std::vector<Track> tracks;
+    size_t totalTracks;
 };
 
-// HashTable class definition
-class HashTable
+// BasicHashTable class definition, configured at compile time
+// KeyPolicy decides how artist and title keys are folded and compared (CaseInsensitiveKey or CaseSensitiveKey)
+// HashPolicy hashes the artist key into its bucket (Djb2Hash or Fnv1aHash)
+// CapacityPolicy sizes the buckets and finds one from a hash (ModuloCapacity, PowerOfTwoCapacity or FixedCapacity<Bits>)
+// The member functions are defined in hashTable.cpp and instantiated there for the configurations named at the end of this file
+template <typename KeyPolicy = CaseInsensitiveKey, typename HashPolicy = Djb2Hash, typename CapacityPolicy = ModuloCapacity>
+class BasicHashTable
 {
 private:
     // Member datas
-    size_t tableSize;
-    TrackNode **table; // Pointer to an array of pointers to linked list nodes (TrackNode)
-    // Method to compute the hash value for a given key
+    CapacityPolicy capacity;
+    std::vector<uint32_t> table;    // First node of every artist bucket, noNode when empty
+    std::vector<uint32_t> tails;    // Last node of every list in table, for constant time appends
+    std::vector<uint32_t> keyTable; // Buckets of the (artist, title) index, chained through nextInKey
+    std::vector<TrackNode> nodes;   // Nodes by id, removed ones are dropped and the rest renumbered once they outnumber them
+    std::string titleData;          // Titles of the nodes back to back
+    size_t freedTitleBytes;         // Bytes of titleData belonging to removed nodes
+    std::vector<int> lineNumbers;   // Line numbers by id, only while they are kept
+    bool keepLineNumbers;
+    ArtistDictionary artists; // Every artist name stored once, nodes keep its id
+    std::vector<uint32_t> artistTrackCounts; // By artist id, the number of tracks stored
+    ArtistFilter artistFilter;               // Artists with tracks, checked before the dictionary by search
+    bool filterArtists;
+    size_t emptiedArtists; // Artists left without tracks by removals since the filter was last rebuilt
+    TitleIndex titleIndex;
+    FuzzyArtistIndex artistIndex;
+    DurationIndex durationIndex;
+    ArtistOrderIndex artistOrders; // Tracks of prolific artists kept sorted, built by the insert that makes them prolific
+    size_t numTracks;
+    uint64_t version; // Drawn anew on every change to the stored tracks, for copies to tell whether they are stale
+    mutable SearchCache searchCache; // Recent results by artist key, invalidated when the artist's tracks change
+    mutable HashTableCounters counters;
+    // The table doubles in size once it holds more tracks per bucket than this
+    static constexpr double maxLoadFactor = 1.0;
+    // Method to compute the bucket of a given key
     size_t hash(const std::string &key) const;
+    // Method to compute the fingerprint of a track's artist and title
+    static uint64_t fingerprint(const std::string &title, const std::string &artist);
+    // Method to check whether two tracks have the same title and artist
+    bool isSameTrack(const Track &track1, const Track &track2) const;
+    // Method to report a track rejected as a duplicate
+    void reportDuplicate(int existingLineNumber, const Track &track) const;
+    // Method to check whether a node holds a track, ignoring case
+    bool nodeMatches(uint32_t id, const std::string &title, const std::string &artist) const;
+    // Method to check that a title fits in a record, reporting the track otherwise
+    bool titleFits(const Track &track) const;
+    // Method to make room for a new node id, reporting the track otherwise
+    bool makeRoomForNode(const Track &track);
+    // Method to create a node for a track, adding its artist to the dictionary
+    uint32_t createNode(const Track &track, uint64_t trackFingerprint);
+    // Method to get the line number a node was loaded from, 0 once line numbers are discarded
+    int lineNumberOf(uint32_t id) const;
+    // Method to rebuild the track stored in a node
+    Track makeTrack(uint32_t id, const std::string &artist) const;
+    Track makeTrack(uint32_t id) const;
+    // Method to find the bucket of a node's artist
+    size_t bucketOf(uint32_t id) const;
+    // Method to find the node of a track through the (artist, title) index
+    uint32_t findNode(const std::string &title, const std::string &artist, uint64_t trackFingerprint) const;
+    // Method to place a node in its artist bucket and its key bucket
+    void placeNode(uint32_t id);
+    // Method to link a new node into both indexes and the secondary indexes
+    void linkNode(uint32_t id, const Track &track);
+    // Method to unlink a node from every index and free its title
+    void unlinkNode(uint32_t id, uint32_t prevInKey);
+    // Method to copy the titles of the remaining nodes into a new arena
+    void compactTitles();
+    // Method to drop removed nodes and renumber the rest once they are outnumbered
+    void reclaimNodes();
+    // Method to drop removed nodes and renumber the rest in the same order
+    void compactNodes();
+    // Method to refill the artist filter with the artists that still have tracks
+    void rebuildArtistFilter();
+    // Method to fold an artist name into the key of its search results
+    static std::string searchKey(const std::string &artist);
+    // Method to drop the cached search results of an artist whose tracks changed
+    void invalidateSearch(const std::string &artist);
+    // Method to collect the ids of an artist's nodes by walking its bucket
+    std::vector<uint32_t> collectNodes(const std::string &artist) const;
+    // Method to collect the tracks of an artist by walking its bucket
+    std::vector<Track> collectTracks(const std::string &artist) const;
+    // Method to order two nodes by title as the key policy folds it, then by id
+    bool titleBefore(uint32_t lhs, uint32_t rhs) const;
+    // Method to get titleBefore as the order of the artist order index
+    ArtistOrderIndex::TitleLess titleOrder() const;
+    // Method to rebuild the tracks of some nodes, decoding each artist name once per run
+    std::vector<Track> makeTracks(const std::vector<uint32_t> &ids) const;
+    // Method to answer a search from the cache, caching the tracks collected on a miss
+    std::shared_ptr<const std::vector<Track>> searchThroughCache(const std::string &artist) const;
 
 public:
+    static constexpr uint32_t noNode = UINT32_MAX;
+    // Node ids stay below noNode, so at most this many tracks are stored
+    static constexpr size_t maxNodes = noNode;
+    // Titles are stored with a 24-bit length, so longer ones are refused
+    static constexpr size_t maxTitleLength = (1 << 24) - 1;
+    // Removed nodes are only reclaimed once there are at least this many
+    static constexpr size_t minReclaimedNodes = 1 << 10;
+    // The artist filter is never sized for fewer artists than this
+    static constexpr size_t minFilterArtists = 64;
+    // An artist is kept sorted from the insert giving one spelling of its name this many tracks, others are sorted for each page
+    static constexpr size_t minOrderedTracks = 256;
+
     // Constructor and destructor
-    HashTable(size_t size);
-    ~HashTable();
+    BasicHashTable(size_t size);
+    ~BasicHashTable();
 
     /*
     Insert track into the hash table
     @param track the track to insert into the hash table
+    @param reportDuplicates false to skip a duplicate without printing an error
+    @return whether the track was inserted, already stored or refused
     */
-    void insert(const Track &track);
+    InsertResult insert(const Track &track, bool reportDuplicates = true);
+
+    /*
+    Insert many tracks into the hash table, skipping duplicates
+    Duplicates within the batch are found by sorting fingerprints before any insertion
+    @param tracks the tracks to insert, in order
+    @param reportDuplicates false to skip duplicates without printing an error for each
+    @return the number of tracks inserted
+    */
+    size_t insertMany(const std::vector<Track> &tracks, bool reportDuplicates = true);
 
     /*
    Remove track from the hash table
@@ -49,6 +195,13 @@ public:
    */
     bool remove(const std::string &title, const std::string &artist);
 
+    /*
+    Remove many tracks from the hash table, walking each affected bucket once
+    @param tracks pairs of title and artist of the tracks to remove
+    @return for every request, true if the track was removed, false otherwise
+    */
+    std::vector<bool> removeMany(const std::vector<std::pair<std::string, std::string>> &tracks);
+
     /*
   Search for tracks by artist
   @param artist the artist name to search for
@@ -56,6 +209,84 @@ public:
   */
     std::vector<Track> search(const std::string &artist) const;
 
+    /*
+    Search for tracks by artist without copying a cached result
+    @param artist the artist name to search for
+    @return the Track objects that match the given artist, shared with the search cache and never changed
+    */
+    std::shared_ptr<const std::vector<Track>> searchShared(const std::string &artist) const;
+
+    /*
+    Search for one page of the tracks of an artist, sorted by title or by duration
+    Prolific artists are sorted once and kept sorted as tracks come and go, so their pages cost the page size
+    @param artist the artist name to search for
+    @param order the order of the tracks, titles ignoring case as the key policy does
+    @param offset the number of tracks to skip
+    @param limit the largest number of tracks to return
+    @return the tracks of the page and the number of tracks of the artist
+    */
+    TrackPage searchPage(const std::string &artist, TrackOrder order, size_t offset, size_t limit) const;
+
+    /*
+    Change the number of tracks the search cache may hold, dropping every cached result
+    Results are cached by default, up to SearchCache::defaultCapacity tracks
+    @param capacity the number of tracks in total, 0 to turn the cache off
+    */
+    void setSearchCacheCapacity(size_t capacity);
+
+    /*
+    Find a track by its title and artist in constant expected time
+    @param title the title of the track
+    @param artist the artist of the track
+    @return a copy of the stored track, or no value if it is not stored
+    */
+    std::optional<Track> find(const std::string &title, const std::string &artist) const;
+
+    /*
+    Get the number of tracks in the hash table
+    @return the number of tracks stored
+    */
+    size_t size() const;
+
+    /*
+    Get the version of the stored tracks, drawn anew by every insert, removal and line number discard
+    No two tables ever share a version, even one built where another was destroyed
+    @return the version, equal between two calls only if they were made on the same table and no track changed in between
+    */
+    uint64_t getVersion() const;
+
+    /*
+    Search for tracks by words in their title
+    @param query the words to search for
+    @param matchAllWords true to require every word, false to require any word
+    @return a vector of Track objects whose title matches the query
+    */
+    std::vector<Track> searchByTitle(const std::string &query, bool matchAllWords) const;
+
+    /*
+    Find the artists whose name is close to a possibly misspelled name
+    @param artist the artist name to match
+    @param maxDistance the largest number of single character edits to accept
+    @return the matching artists ordered by distance
+    */
+    std::vector<ArtistMatch> findSimilarArtists(const std::string &artist, size_t maxDistance) const;
+
+    /*
+    Count the tracks within a duration range
+    @param minDuration the shortest duration in seconds, inclusive
+    @param maxDuration the longest duration in seconds, inclusive
+    @return the number of tracks within the range
+    */
+    size_t countByDuration(int minDuration, int maxDuration) const;
+
+    /*
+    Search for tracks within a duration range
+    @param minDuration the shortest duration in seconds, inclusive
+    @param maxDuration the longest duration in seconds, inclusive
+    @return a vector of Track objects within the range, ordered by duration
+    */
+    std::vector<Track> searchByDuration(int minDuration, int maxDuration) const;
+
     /*
    Case insensitive string comparison
    @param str1 the first string to compare
@@ -69,6 +300,64 @@ public:
     @return a vector of all Track objects in the hash table
     */
     std::vector<Track> getAllTracks() const;
+
+    /*
+    Visit every track in the hash table without collecting them
+    @param visitor the function called with each track, which only lives for the call
+    */
+    void forEachTrack(const std::function<void(const Track &)> &visitor) const;
+
+    /*
+    Change the number of buckets, relinking every node
+    @param newTableSize the new number of buckets
+    */
+    void rehash(size_t newTableSize);
+
+    /*
+    Stop keeping the line number of every track, freeing 4 bytes per track
+    Tracks found afterwards report line 0, and duplicates are reported without the line of the stored track
+    */
+    void discardLineNumbers();
+
+    /*
+    Turn the filter checked by search before the artist dictionary on or off, it is on by default
+    Searches for absent artists mostly stop at the filter, at a cost of 2 bytes per artist
+    @param enabled true to build the filter from the stored artists, false to free it
+    */
+    void setArtistFilter(bool enabled);
+
+    /*
+    Get the dictionary of artist names
+    @return the artist dictionary
+    */
+    const ArtistDictionary &getArtists() const;
+
+    /*
+    Take a snapshot of the counters and measure the shape of the table
+    @return the statistics of the hash table
+    */
+    HashTableStats getStats() const;
+
+    /*
+    Write the statistics of the hash table as a single line JSON object
+    @param output the stream to write to
+    */
+    void writeStats(std::ostream &output) const;
 };
 
+// The behaviour the library has always had: any number of buckets, djb2 over the artist, case ignored
+using HashTable = BasicHashTable<CaseInsensitiveKey, Djb2Hash, ModuloCapacity>;
+// Case ignored, but power of two buckets found with a multiply and a shift instead of a division
+using FastHashTable = BasicHashTable<CaseInsensitiveKey, Djb2Hash, PowerOfTwoCapacity>;
+// Artists and titles compared byte for byte, hashed with FNV-1a into power of two buckets
+using CaseSensitiveHashTable = BasicHashTable<CaseSensitiveKey, Fnv1aHash, PowerOfTwoCapacity>;
+// 65536 buckets known at compile time that never grow, for catalogs of a known size
+using FixedHashTable = BasicHashTable<CaseInsensitiveKey, Djb2Hash, FixedCapacity<16>>;
+
+// These configurations are compiled once in hashTable.cpp rather than in every file using them
+extern template class BasicHashTable<CaseInsensitiveKey, Djb2Hash, ModuloCapacity>;
+extern template class BasicHashTable<CaseInsensitiveKey, Djb2Hash, PowerOfTwoCapacity>;
+extern template class BasicHashTable<CaseSensitiveKey, Fnv1aHash, PowerOfTwoCapacity>;
+extern template class BasicHashTable<CaseInsensitiveKey, Djb2Hash, FixedCapacity<16>>;
+
 #endif
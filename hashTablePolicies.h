@@ -0,0 +1,193 @@
+#ifndef __HASHTABLEPOLICIES_H_
+#define __HASHTABLEPOLICIES_H_
+
+/*
+    hashTablePolicies.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated: 19/10/26
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// The policies below are chosen at compile time by BasicHashTable, so every call is inlined into the table
+
+// CaseInsensitiveKey struct compares artist and title keys ignoring ASCII case, as the library always has
+struct CaseInsensitiveKey
+{
+    static constexpr bool caseSensitive = false;
+
+    // Lowercase an ASCII letter without a branch, the same as tolower in the "C" locale the program runs in
+    static char fold(char c)
+    {
+        unsigned char uc = static_cast<unsigned char>(c);
+        return static_cast<char>(uc + (static_cast<unsigned char>(uc - 'A') < 26) * ('a' - 'A'));
+    }
+};
+
+// CaseSensitiveKey struct compares artist and title keys byte for byte
+struct CaseSensitiveKey
+{
+    static constexpr bool caseSensitive = true;
+
+    static char fold(char c)
+    {
+        return c;
+    }
+};
+
+/*
+Compare two keys under a key policy
+@param lhs the first key
+@param rhs the second key
+@return true if the keys are equal once folded, false otherwise
+*/
+template <typename KeyPolicy>
+inline bool keysEqual(const char *lhs, size_t lhsSize, const std::string &rhs)
+{
+    if (lhsSize != rhs.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < lhsSize; ++i)
+    {
+        if (KeyPolicy::fold(lhs[i]) != KeyPolicy::fold(rhs[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename KeyPolicy>
+inline bool keysEqual(const std::string &lhs, const std::string &rhs)
+{
+    return keysEqual<KeyPolicy>(lhs.data(), lhs.size(), rhs);
+}
+
+/*
+Order two keys under a key policy, byte by byte as unsigned characters like std::string compares them
+@param lhs the first key
+@param lhsSize the length of the first key
+@param rhs the second key
+@param rhsSize the length of the second key
+@return true if the first key comes before the second once folded, false otherwise
+*/
+template <typename KeyPolicy>
+inline bool keyBefore(const char *lhs, size_t lhsSize, const char *rhs, size_t rhsSize)
+{
+    size_t common = std::min(lhsSize, rhsSize);
+    for (size_t i = 0; i < common; ++i)
+    {
+        unsigned char lhsChar = static_cast<unsigned char>(KeyPolicy::fold(lhs[i]));
+        unsigned char rhsChar = static_cast<unsigned char>(KeyPolicy::fold(rhs[i]));
+        if (lhsChar != rhsChar)
+        {
+            return lhsChar < rhsChar;
+        }
+    }
+    return lhsSize < rhsSize;
+}
+
+// Djb2Hash struct hashes a key with djb2, the hash the library has always placed artists with
+struct Djb2Hash
+{
+    template <typename KeyPolicy>
+    static uint64_t hash(const std::string &key)
+    {
+        uint64_t hashValue = 5381;
+        for (char c : key)
+        {
+            hashValue = ((hashValue << 5) + hashValue) + KeyPolicy::fold(c); // hash * 33 + c
+        }
+        return hashValue;
+    }
+};
+
+// Fnv1aHash struct hashes a key with 64-bit FNV-1a, which mixes every byte into the low bits too
+struct Fnv1aHash
+{
+    template <typename KeyPolicy>
+    static uint64_t hash(const std::string &key)
+    {
+        uint64_t hashValue = 14695981039346656037ULL;
+        for (char c : key)
+        {
+            hashValue ^= static_cast<unsigned char>(KeyPolicy::fold(c));
+            hashValue *= 1099511628211ULL;
+        }
+        return hashValue;
+    }
+};
+
+// ModuloCapacity class allows any number of buckets and finds a bucket by modulo, as the library always has
+class ModuloCapacity
+{
+private:
+    size_t buckets;
+
+public:
+    static constexpr bool growable = true;
+
+    explicit ModuloCapacity(size_t requested) : buckets(std::max<size_t>(requested, 1)) {}
+    size_t size() const { return buckets; }
+    size_t bucket(uint64_t hashValue) const { return hashValue % buckets; }
+    void resize(size_t requested) { buckets = std::max<size_t>(requested, 1); }
+};
+
+/*
+Scramble the bits of a number, with the finaliser of splitmix64
+@param value the number to scramble
+@return the scrambled number
+*/
+inline uint64_t mixBits(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+// Multiplier spreading a hash over the top bits, from which power of two capacities take the bucket
+static constexpr uint64_t fibonacciMultiplier = 0x9E3779B97F4A7C15ULL;
+
+// PowerOfTwoCapacity class rounds the number of buckets up to a power of two and finds a bucket with a multiply and a shift
+class PowerOfTwoCapacity
+{
+private:
+    unsigned bits;
+
+public:
+    static constexpr bool growable = true;
+
+    explicit PowerOfTwoCapacity(size_t requested) : bits(1) { resize(requested); }
+    size_t size() const { return size_t(1) << bits; }
+    size_t bucket(uint64_t hashValue) const { return (hashValue * fibonacciMultiplier) >> (64 - bits); }
+    void resize(size_t requested)
+    {
+        bits = 1;
+        while ((size_t(1) << bits) < requested)
+        {
+            bits++;
+        }
+    }
+};
+
+// FixedCapacity class has 2^Bits buckets known at compile time and never grows, for catalogs of a known size
+template <unsigned Bits>
+class FixedCapacity
+{
+    static_assert(Bits >= 1 && Bits < 32, "FixedCapacity needs between 1 and 31 bits");
+
+public:
+    static constexpr bool growable = false;
+
+    explicit FixedCapacity(size_t) {}
+    static constexpr size_t size() { return size_t(1) << Bits; }
+    static size_t bucket(uint64_t hashValue) { return (hashValue * fibonacciMultiplier) >> (64 - Bits); }
+    void resize(size_t) {}
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef __HASHTABLESTATS_H_
+#define __HASHTABLESTATS_H_
+
+/*
+    hashTableStats.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated: 19/10/26
+*/
+
+#include <atomic>
+#include <cstdint>
+
+// Compile with -DHASHTABLE_STATS=0 to turn every counter into a no-op
+#ifndef HASHTABLE_STATS
+#define HASHTABLE_STATS 1
+#endif
+
+// StatCounter class definition, an event counter updated with relaxed atomics
+class StatCounter
+{
+#if HASHTABLE_STATS
+private:
+    std::atomic<uint64_t> value{0};
+
+public:
+    void add(uint64_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t load() const { return value.load(std::memory_order_relaxed); }
+#else
+public:
+    void add(uint64_t = 1) {}
+    uint64_t load() const { return 0; }
+#endif
+};
+
+// HashTableCounters struct groups the counters updated on the hot paths of the HashTable
+struct HashTableCounters
+{
+    StatCounter inserts;          // Tracks inserted
+    StatCounter duplicateRejects; // Tracks rejected as duplicates
+    StatCounter searches;         // Searches by artist
+    StatCounter searchProbes;     // Nodes visited by searches by artist
+    StatCounter filterRejects;    // Searches by artist stopped by the artist filter
+    StatCounter keyLookups;       // Lookups in the (artist, title) index
+    StatCounter keyProbes;        // Nodes visited by lookups in the (artist, title) index
+    StatCounter removes;          // Tracks removed
+    StatCounter removeMisses;     // Removals of tracks that were not stored
+    StatCounter resizes;          // Times the table grew
+};
+
+// HashTableStats struct is a snapshot of the counters and of the shape of the HashTable
+struct HashTableStats
+{
+    bool countersEnabled;
+    uint64_t tableSize;
+    uint64_t trackCount;
+    double loadFactor;
+    uint64_t usedBuckets;
+    uint64_t longestChain;    // Longest list in the artist buckets
+    uint64_t longestKeyChain; // Longest list in the (artist, title) buckets
+    uint64_t artistCount;     // Distinct artist names in the dictionary
+    uint64_t artistBytes;     // Memory held by the artist dictionary and the track count of every artist
+    uint64_t filterBytes;     // Memory held by the artist filter
+    uint64_t trackBytes;      // Memory held by the nodes, the title arena and the line numbers
+    uint64_t inserts;
+    uint64_t duplicateRejects;
+    uint64_t searches;
+    uint64_t searchProbes;
+    uint64_t filterRejects;
+    uint64_t keyLookups;
+    uint64_t keyProbes;
+    uint64_t removes;
+    uint64_t removeMisses;
+    uint64_t resizes;
+    uint64_t cacheHits;          // Searches answered from the search cache
+    uint64_t cacheMisses;        // Searches the search cache had no result for
+    uint64_t cacheInvalidations; // Cached results dropped because the tracks of their artist changed
+    uint64_t cacheEvictions;     // Cached results dropped to make room
+    uint64_t cachedResults;
+    uint64_t cachedTracks;
+    uint64_t orderedArtists; // Artists whose tracks are kept sorted for paging
+    uint64_t orderedTracks;
+};
+
+#endif
@@ -0,0 +1,241 @@
+/*
+    ioUring.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cerrno>
+#include <cstring>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "ioUring.h"
+
+// Constructor
+IoUring::IoUring()
+    : ringFd(-1), submissionEntries(0), pendingSubmissions(0),
+      submissionRing(MAP_FAILED), submissionRingSize(0), submissionHead(nullptr), submissionTail(nullptr),
+      submissionMask(nullptr), submissionArray(nullptr), submissionQueue(nullptr), submissionQueueSize(0),
+      completionRing(MAP_FAILED), completionRingSize(0), completionHead(nullptr), completionTail(nullptr),
+      completionMask(nullptr), completionQueue(nullptr) {}
+
+// Destructor
+IoUring::~IoUring()
+{
+    if (submissionQueue)
+    {
+        munmap(submissionQueue, submissionQueueSize);
+    }
+    if (completionRing != MAP_FAILED && completionRing != submissionRing)
+    {
+        munmap(completionRing, completionRingSize);
+    }
+    if (submissionRing != MAP_FAILED)
+    {
+        munmap(submissionRing, submissionRingSize);
+    }
+    if (ringFd >= 0)
+    {
+        close(ringFd);
+    }
+}
+
+/*
+Create the ring, which fails on kernels without io_uring or where it is blocked
+@param entries the number of submission entries, rounded up to a power of two by the kernel
+@return true if successful, false otherwise
+*/
+bool IoUring::setup(unsigned entries)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ringFd < 0)
+    {
+        return false;
+    }
+    submissionEntries = params.sq_entries;
+
+    // Map the rings, kernels with IORING_FEAT_SINGLE_MMAP share one mapping for both
+    submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMapping && completionRingSize > submissionRingSize)
+    {
+        submissionRingSize = completionRingSize;
+    }
+    submissionRing = mmap(nullptr, submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (submissionRing == MAP_FAILED)
+    {
+        return false;
+    }
+    completionRing = singleMapping ? submissionRing
+                                   : mmap(nullptr, completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+    if (completionRing == MAP_FAILED)
+    {
+        return false;
+    }
+    submissionQueueSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *queue = mmap(nullptr, submissionQueueSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (queue == MAP_FAILED)
+    {
+        return false;
+    }
+    submissionQueue = static_cast<io_uring_sqe *>(queue);
+
+    char *submissionBase = static_cast<char *>(submissionRing);
+    submissionHead = reinterpret_cast<unsigned *>(submissionBase + params.sq_off.head);
+    submissionTail = reinterpret_cast<unsigned *>(submissionBase + params.sq_off.tail);
+    submissionMask = reinterpret_cast<unsigned *>(submissionBase + params.sq_off.ring_mask);
+    submissionArray = reinterpret_cast<unsigned *>(submissionBase + params.sq_off.array);
+    char *completionBase = static_cast<char *>(completionRing);
+    completionHead = reinterpret_cast<unsigned *>(completionBase + params.cq_off.head);
+    completionTail = reinterpret_cast<unsigned *>(completionBase + params.cq_off.tail);
+    completionMask = reinterpret_cast<unsigned *>(completionBase + params.cq_off.ring_mask);
+    completionQueue = reinterpret_cast<io_uring_cqe *>(completionBase + params.cq_off.cqes);
+    return true;
+}
+
+/*
+Queue a read, it is only passed to the kernel by submitAndWait
+@param fd the file to read from
+@param buffer the buffer to read into
+@param length the number of bytes to read
+@param offset the position in the file to read from
+@param userData the value returned with the completion
+@return true if queued, false if the submission ring is full
+*/
+bool IoUring::queueRead(int fd, void *buffer, unsigned length, uint64_t offset, uint64_t userData)
+{
+    io_uring_sqe *entry = nextEntry();
+    if (!entry)
+    {
+        return false;
+    }
+    entry->opcode = IORING_OP_READ;
+    entry->fd = fd;
+    entry->addr = reinterpret_cast<uint64_t>(buffer);
+    entry->len = length;
+    entry->off = offset;
+    entry->user_data = userData;
+    commitEntry();
+    return true;
+}
+
+/*
+Queue the cancellation of a request already passed to the kernel, which then completes early or as usual
+@param target the user data of the request to cancel
+@param userData the value returned with the completion of the cancellation itself
+@return true if queued, false if the submission ring is full
+*/
+bool IoUring::queueCancel(uint64_t target, uint64_t userData)
+{
+    io_uring_sqe *entry = nextEntry();
+    if (!entry)
+    {
+        return false;
+    }
+    entry->opcode = IORING_OP_ASYNC_CANCEL;
+    entry->fd = -1;
+    entry->addr = target;
+    entry->user_data = userData;
+    commitEntry();
+    return true;
+}
+
+/*
+Take back every request queued but not yet passed to the kernel, none of them will complete
+@return the user data of the requests taken back, oldest first
+*/
+std::vector<uint64_t> IoUring::withdrawQueued()
+{
+    // The kernel only reads the tail inside io_uring_enter, so the entries past its head are still ours
+    std::vector<uint64_t> withdrawn;
+    unsigned head = __atomic_load_n(submissionHead, __ATOMIC_ACQUIRE);
+    unsigned tail = *submissionTail;
+    for (unsigned position = head; position != tail; ++position)
+    {
+        withdrawn.push_back(submissionQueue[submissionArray[position & *submissionMask]].user_data);
+    }
+    __atomic_store_n(submissionTail, head, __ATOMIC_RELEASE);
+    pendingSubmissions = 0;
+    return withdrawn;
+}
+
+/*
+Take the next free submission entry, cleared
+@return the entry to fill before committing it, nullptr if the submission ring is full
+*/
+io_uring_sqe *IoUring::nextEntry()
+{
+    unsigned tail = *submissionTail;
+    if (tail - __atomic_load_n(submissionHead, __ATOMIC_ACQUIRE) >= submissionEntries)
+    {
+        return nullptr;
+    }
+    unsigned index = tail & *submissionMask;
+    io_uring_sqe &entry = submissionQueue[index];
+    std::memset(&entry, 0, sizeof(entry));
+    submissionArray[index] = index;
+    return &entry;
+}
+
+/*
+Make the entry taken by nextEntry visible to the kernel
+*/
+void IoUring::commitEntry()
+{
+    // The kernel must see the entry before the new tail
+    __atomic_store_n(submissionTail, *submissionTail + 1, __ATOMIC_RELEASE);
+    pendingSubmissions++;
+}
+
+/*
+Pass the queued reads to the kernel and wait for completions
+@param minCompletions the number of completions to wait for
+@return true if successful, false otherwise
+*/
+bool IoUring::submitAndWait(unsigned minCompletions)
+{
+    while (true)
+    {
+        long submitted = syscall(__NR_io_uring_enter, ringFd, pendingSubmissions, minCompletions,
+                                 minCompletions ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        if (submitted >= 0)
+        {
+            pendingSubmissions -= static_cast<unsigned>(submitted);
+            return true;
+        }
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+}
+
+/*
+Take the oldest completion
+@param userData the value given to queueRead
+@param result the number of bytes read, or a negated errno
+@return true if a completion was taken, false if there was none
+*/
+bool IoUring::popCompletion(uint64_t &userData, int &result)
+{
+    unsigned head = *completionHead;
+    if (head == __atomic_load_n(completionTail, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+
+    const io_uring_cqe &entry = completionQueue[head & *completionMask];
+    userData = entry.user_data;
+    result = entry.res;
+
+    // Hand the slot back only once it has been read
+    __atomic_store_n(completionHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
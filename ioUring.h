@@ -0,0 +1,114 @@
+#ifndef __IOURING_H_
+#define __IOURING_H_
+
+/*
+    ioUring.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+// IoUring class definition, a minimal io_uring read queue driven through the raw system calls
+class IoUring
+{
+private:
+    // Member datas
+    int ringFd;
+    unsigned submissionEntries;
+    unsigned pendingSubmissions; // Queued but not yet passed to the kernel
+
+    // Submission ring, shared with the kernel
+    void *submissionRing;
+    size_t submissionRingSize;
+    unsigned *submissionHead;
+    unsigned *submissionTail;
+    unsigned *submissionMask;
+    unsigned *submissionArray;
+    io_uring_sqe *submissionQueue;
+    size_t submissionQueueSize;
+
+    // Completion ring, shared with the kernel, may be the same mapping as the submission ring
+    void *completionRing;
+    size_t completionRingSize;
+    unsigned *completionHead;
+    unsigned *completionTail;
+    unsigned *completionMask;
+    io_uring_cqe *completionQueue;
+
+    /*
+    Take the next free submission entry, cleared
+    @return the entry to fill before committing it, nullptr if the submission ring is full
+    */
+    io_uring_sqe *nextEntry();
+
+    /*
+    Make the entry taken by nextEntry visible to the kernel
+    */
+    void commitEntry();
+
+public:
+    // Constructor
+    IoUring();
+
+    // Destructor
+    ~IoUring();
+
+    IoUring(const IoUring &) = delete;
+    IoUring &operator=(const IoUring &) = delete;
+
+    /*
+    Create the ring, which fails on kernels without io_uring or where it is blocked
+    @param entries the number of submission entries, rounded up to a power of two by the kernel
+    @return true if successful, false otherwise
+    */
+    bool setup(unsigned entries);
+
+    /*
+    Queue a read, it is only passed to the kernel by submitAndWait
+    @param fd the file to read from
+    @param buffer the buffer to read into
+    @param length the number of bytes to read
+    @param offset the position in the file to read from
+    @param userData the value returned with the completion
+    @return true if queued, false if the submission ring is full
+    */
+    bool queueRead(int fd, void *buffer, unsigned length, uint64_t offset, uint64_t userData);
+
+    /*
+    Queue the cancellation of a request already passed to the kernel, which then completes early or as usual
+    @param target the user data of the request to cancel
+    @param userData the value returned with the completion of the cancellation itself
+    @return true if queued, false if the submission ring is full
+    */
+    bool queueCancel(uint64_t target, uint64_t userData);
+
+    /*
+    Take back every request queued but not yet passed to the kernel, none of them will complete
+    @return the user data of the requests taken back, oldest first
+    */
+    std::vector<uint64_t> withdrawQueued();
+
+    /*
+    Pass the queued reads to the kernel and wait for completions
+    @param minCompletions the number of completions to wait for
+    @return true if successful, false otherwise
+    */
+    bool submitAndWait(unsigned minCompletions);
+
+    /*
+    Take the oldest completion
+    @param userData the value given to queueRead
+    @param result the number of bytes read, or a negated errno
+    @return true if a completion was taken, false if there was none
+    */
+    bool popCompletion(uint64_t &userData, int &result);
+};
+
+#endif
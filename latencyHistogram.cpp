@@ -0,0 +1,258 @@
+/*
+    latencyHistogram.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include "latencyHistogram.h"
+
+// ThreadHistograms struct holds the histograms of one thread at a time, linked into a list that only grows
+// A thread hands its block back when it exits, and the next thread to record claims it, counts included,
+// so the list holds as many blocks as threads ever recorded at the same time
+struct ThreadHistograms
+{
+    LatencyHistogram histograms[static_cast<size_t>(Operation::Count)];
+    ThreadHistograms *next;
+    std::atomic<bool> inUse;
+};
+
+// Head of the list of every block of histograms, blocks are pushed with a compare and swap
+static std::atomic<ThreadHistograms *> allThreadHistograms{nullptr};
+
+// HistogramOwner struct is the calling thread's claim on a block, given up when the thread exits
+struct HistogramOwner
+{
+    ThreadHistograms *histograms = nullptr;
+
+    ~HistogramOwner()
+    {
+        if (histograms)
+        {
+            // Publish the last counts to whichever thread claims the block next
+            histograms->inUse.store(false, std::memory_order_release);
+        }
+    }
+};
+
+/*
+Find the bucket of a value
+@param value the value, larger values share the last bucket
+@return the index of the bucket
+*/
+size_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+    if (value < subBucketCount)
+    {
+        return value;
+    }
+    int highestBit = 63 - __builtin_clzll(value);
+    if (highestBit >= maxValueBits)
+    {
+        return bucketCount - 1;
+    }
+    // Keep the top subBucketBits bits of the value, the first of which is always set
+    int shift = highestBit - (subBucketBits - 1);
+    uint64_t mantissa = value >> shift;
+    return subBucketCount + (shift - 1) * (subBucketCount / 2) + (mantissa - subBucketCount / 2);
+}
+
+/*
+Find the largest value counted in a bucket
+@param index the index of the bucket
+@return the largest value of the bucket
+*/
+uint64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+    if (index < subBucketCount)
+    {
+        return index;
+    }
+    size_t offset = index - subBucketCount;
+    int shift = static_cast<int>(offset / (subBucketCount / 2)) + 1;
+    uint64_t mantissa = offset % (subBucketCount / 2) + subBucketCount / 2;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+/*
+Count a value, only the owning thread may call this
+@param value the value to count
+*/
+void LatencyHistogram::record(uint64_t value)
+{
+    // A single writer does not need an atomic read-modify-write, readers only need untorn values
+    std::atomic<uint64_t> &count = counts[bucketIndex(value)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/*
+Add the counts of this histogram to running totals, safe to call from any thread
+@param totals the totals, one per bucket
+*/
+void LatencyHistogram::addTo(std::vector<uint64_t> &totals) const
+{
+    totals.resize(bucketCount, 0);
+    for (size_t i = 0; i < bucketCount; ++i)
+    {
+        totals[i] += counts[i].load(std::memory_order_relaxed);
+    }
+}
+
+/*
+Compute the percentiles of merged counts
+@param totals the counts, one per bucket
+@return the percentiles of the counts
+*/
+LatencySummary LatencyHistogram::summarize(const std::vector<uint64_t> &totals)
+{
+    LatencySummary summary = {};
+    for (uint64_t count : totals)
+    {
+        summary.count += count;
+    }
+    if (summary.count == 0)
+    {
+        return summary;
+    }
+
+    // Walk the buckets once, filling each percentile when the running count reaches its rank
+    const double quantiles[] = {0.5, 0.99, 0.999};
+    uint64_t *targets[] = {&summary.p50, &summary.p99, &summary.p999};
+    size_t nextQuantile = 0;
+    uint64_t runningCount = 0;
+    for (size_t i = 0; i < totals.size(); ++i)
+    {
+        if (totals[i] == 0)
+        {
+            continue;
+        }
+        runningCount += totals[i];
+        while (nextQuantile < 3 && runningCount >= quantiles[nextQuantile] * summary.count)
+        {
+            *targets[nextQuantile] = bucketUpperBound(i);
+            nextQuantile++;
+        }
+        summary.max = bucketUpperBound(i);
+    }
+    return summary;
+}
+
+/*
+Get the histograms of the calling thread, claiming a block left by an exited thread or adding one on first use
+Histograms outlive their thread so its measurements stay in the reports
+@return the histograms of the calling thread
+*/
+static ThreadHistograms &threadHistograms()
+{
+    thread_local HistogramOwner owner;
+    if (!owner.histograms)
+    {
+        for (ThreadHistograms *block = allThreadHistograms.load(std::memory_order_acquire); block; block = block->next)
+        {
+            bool inUse = false;
+            if (block->inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                owner.histograms = block;
+                return *block;
+            }
+        }
+
+        ThreadHistograms *histograms = new ThreadHistograms();
+        histograms->inUse.store(true, std::memory_order_relaxed);
+        histograms->next = allThreadHistograms.load(std::memory_order_relaxed);
+        while (!allThreadHistograms.compare_exchange_weak(histograms->next, histograms,
+                                                          std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+        owner.histograms = histograms;
+    }
+    return *owner.histograms;
+}
+
+/*
+Record the latency of an operation in the histogram of the calling thread
+@param operation the operation
+@param nanoseconds the latency in nanoseconds
+*/
+void recordLatency(Operation operation, uint64_t nanoseconds)
+{
+    threadHistograms().histograms[static_cast<size_t>(operation)].record(nanoseconds);
+}
+
+/*
+Merge the histograms of every thread and compute the percentiles of an operation
+@param operation the operation
+@return the percentiles of the operation
+*/
+LatencySummary summarizeLatency(Operation operation)
+{
+    std::vector<uint64_t> totals(LatencyHistogram::bucketCount, 0);
+    for (ThreadHistograms *histograms = allThreadHistograms.load(std::memory_order_acquire); histograms; histograms = histograms->next)
+    {
+        histograms->histograms[static_cast<size_t>(operation)].addTo(totals);
+    }
+
+    return LatencyHistogram::summarize(totals);
+}
+
+/*
+Count the blocks of histograms allocated so far
+@return the number of blocks, at most the number of threads that ever recorded at the same time
+*/
+size_t countLatencyHistogramBlocks()
+{
+    size_t blocks = 0;
+    for (ThreadHistograms *histograms = allThreadHistograms.load(std::memory_order_acquire); histograms; histograms = histograms->next)
+    {
+        blocks++;
+    }
+    return blocks;
+}
+
+/*
+Get the name of an operation
+@param operation the operation
+@return the name of the operation
+*/
+const char *operationName(Operation operation)
+{
+    switch (operation)
+    {
+    case Operation::Insert:
+        return "insert";
+    case Operation::InsertMany:
+        return "insertMany";
+    case Operation::Search:
+        return "search";
+    case Operation::Remove:
+        return "remove";
+    case Operation::RemoveMany:
+        return "removeMany";
+    case Operation::Load:
+        return "load";
+    case Operation::Save:
+        return "save";
+    default:
+        return "unknown";
+    }
+}
+
+/*
+Write the percentiles of every operation as one line of JSON
+@param output the stream to write to
+*/
+void writeLatencyReport(std::ostream &output)
+{
+    output << "{\"latencyEnabled\":" << (LATENCY_STATS ? "true" : "false");
+    for (size_t i = 0; i < static_cast<size_t>(Operation::Count); ++i)
+    {
+        Operation operation = static_cast<Operation>(i);
+        LatencySummary summary = summarizeLatency(operation);
+        output << ",\"" << operationName(operation) << "\":{\"count\":" << summary.count
+               << ",\"p50\":" << summary.p50
+               << ",\"p99\":" << summary.p99
+               << ",\"p999\":" << summary.p999
+               << ",\"max\":" << summary.max << "}";
+    }
+    output << "}" << std::endl;
+}
@@ -0,0 +1,148 @@
+#ifndef __LATENCYHISTOGRAM_H_
+#define __LATENCYHISTOGRAM_H_
+
+/*
+    latencyHistogram.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Compile with -DLATENCY_STATS=0 to turn every timer into a no-op
+#ifndef LATENCY_STATS
+#define LATENCY_STATS 1
+#endif
+
+// Operation enum lists the library operations whose latency is recorded
+enum class Operation
+{
+    Insert,
+    InsertMany,
+    Search,
+    Remove,
+    RemoveMany,
+    Load,
+    Save,
+    Count // Number of operations, not an operation
+};
+
+// LatencySummary struct holds the percentiles of one operation, in nanoseconds
+struct LatencySummary
+{
+    uint64_t count;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+};
+
+// LatencyHistogram class definition, log-linear buckets with about 3% precision (HDR histogram layout)
+class LatencyHistogram
+{
+public:
+    // Values below subBucketCount get one bucket each, every following power of two gets subBucketCount / 2
+    static const int subBucketBits = 6;
+    static const uint64_t subBucketCount = 1 << subBucketBits;
+    static const int maxValueBits = 48;
+    static const size_t bucketCount = subBucketCount + (maxValueBits - subBucketBits) * (subBucketCount / 2);
+
+    /*
+    Find the bucket of a value
+    @param value the value, larger values share the last bucket
+    @return the index of the bucket
+    */
+    static size_t bucketIndex(uint64_t value);
+
+    /*
+    Find the largest value counted in a bucket
+    @param index the index of the bucket
+    @return the largest value of the bucket
+    */
+    static uint64_t bucketUpperBound(size_t index);
+
+    /*
+    Count a value, only the owning thread may call this
+    @param value the value to count
+    */
+    void record(uint64_t value);
+
+    /*
+    Add the counts of this histogram to running totals, safe to call from any thread
+    @param totals the totals, one per bucket
+    */
+    void addTo(std::vector<uint64_t> &totals) const;
+
+    /*
+    Compute the percentiles of merged counts
+    @param totals the counts, one per bucket
+    @return the percentiles of the counts
+    */
+    static LatencySummary summarize(const std::vector<uint64_t> &totals);
+
+private:
+    std::atomic<uint64_t> counts[bucketCount] = {};
+};
+
+/*
+Record the latency of an operation in the histogram of the calling thread
+@param operation the operation
+@param nanoseconds the latency in nanoseconds
+*/
+void recordLatency(Operation operation, uint64_t nanoseconds);
+
+/*
+Merge the histograms of every thread and compute the percentiles of an operation
+@param operation the operation
+@return the percentiles of the operation
+*/
+LatencySummary summarizeLatency(Operation operation);
+
+/*
+Count the blocks of histograms allocated so far
+A thread's block is reused by a later thread once it exits, so threads started one after another share one
+@return the number of blocks, at most the number of threads that ever recorded at the same time
+*/
+size_t countLatencyHistogramBlocks();
+
+/*
+Get the name of an operation
+@param operation the operation
+@return the name of the operation
+*/
+const char *operationName(Operation operation);
+
+/*
+Write the percentiles of every operation as one line of JSON
+@param output the stream to write to
+*/
+void writeLatencyReport(std::ostream &output);
+
+// ScopedLatencyTimer class definition, records the time between its construction and destruction
+class ScopedLatencyTimer
+{
+#if LATENCY_STATS
+private:
+    Operation operation;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ScopedLatencyTimer(Operation operation)
+        : operation(operation), start(std::chrono::steady_clock::now()) {}
+    ~ScopedLatencyTimer()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        recordLatency(operation, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+#else
+public:
+    ScopedLatencyTimer(Operation) {}
+#endif
+};
+
+#endif
@@ -0,0 +1,402 @@
+/*
+    libraryServer.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "libraryServer.h"
+
+// Reading from a client pauses while this much output waits to be sent
+static const size_t maxPendingOutput = 4 << 20;
+
+// Size of a single read from a client
+static const size_t readChunkSize = 64 << 10;
+
+// Constructor
+LibraryServer::LibraryServer(HashTable &hashTable, const std::string &socketPath)
+    : hashTable(hashTable), socketPath(socketPath), listenFd(-1), epollFd(-1), wakeFd(-1), requestsServed(0) {}
+
+// Destructor
+LibraryServer::~LibraryServer()
+{
+    for (auto &entry : connections)
+    {
+        close(entry.first);
+    }
+    if (listenFd >= 0)
+    {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+    if (epollFd >= 0)
+    {
+        close(epollFd);
+    }
+    if (wakeFd >= 0)
+    {
+        close(wakeFd);
+    }
+}
+
+/*
+Create the listening socket and the event loop, replacing a stale socket file
+@return true if successful, false otherwise
+*/
+bool LibraryServer::start()
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Error: invalid socket path " << socketPath << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+
+    // A socket file left behind by a previous server would make bind fail
+    struct stat status;
+    if (stat(socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+    {
+        unlink(socketPath.c_str());
+    }
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || listen(listenFd, SOMAXCONN) < 0)
+    {
+        std::cerr << "Error: could not listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        if (listenFd >= 0)
+        {
+            close(listenFd);
+            listenFd = -1;
+        }
+        return false;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0)
+    {
+        std::cerr << "Error: could not create the event loop: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    return true;
+}
+
+/*
+Serve requests until stop is called
+*/
+void LibraryServer::run()
+{
+    std::vector<epoll_event> events(256);
+    bool running = true;
+    while (running)
+    {
+        int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            std::cerr << "Error: epoll_wait failed: " << std::strerror(errno) << std::endl;
+            return;
+        }
+
+        for (int i = 0; i < ready; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd)
+            {
+                running = false;
+                continue;
+            }
+            if (fd == listenFd)
+            {
+                acceptConnections();
+                continue;
+            }
+
+            auto found = connections.find(fd);
+            if (found == connections.end())
+            {
+                continue;
+            }
+            Connection &connection = found->second;
+            bool keep = !(events[i].events & (EPOLLERR | EPOLLHUP)) || (events[i].events & EPOLLIN);
+            if (keep && (events[i].events & EPOLLIN))
+            {
+                keep = readRequests(connection);
+            }
+            if (keep && !connection.output.empty())
+            {
+                keep = writeResponses(connection);
+            }
+            if (keep && connection.closing && connection.output.empty())
+            {
+                keep = false;
+            }
+
+            if (keep)
+            {
+                updateEvents(connection);
+            }
+            else
+            {
+                closeConnection(fd);
+            }
+        }
+    }
+}
+
+/*
+Make run return, safe to call from another thread or a signal handler
+*/
+void LibraryServer::stop()
+{
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written;
+}
+
+/*
+Get the number of requests answered so far
+@return the number of requests answered
+*/
+uint64_t LibraryServer::getRequestsServed() const
+{
+    return requestsServed;
+}
+
+/*
+Accept every pending connection
+*/
+void LibraryServer::acceptConnections()
+{
+    while (true)
+    {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                std::cerr << "Warning: accept failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            close(fd);
+            continue;
+        }
+        connections[fd] = Connection{fd, std::string(), std::string(), 0, EPOLLIN, false};
+    }
+}
+
+/*
+Read what a client sent and answer every complete request
+@param connection the connection to read from
+@return false if the connection must be closed, true otherwise
+*/
+bool LibraryServer::readRequests(Connection &connection)
+{
+    // Read until the socket is drained or enough output is waiting, nothing more once the client is done
+    while (!connection.closing && connection.output.size() - connection.outputOffset < maxPendingOutput)
+    {
+        size_t oldSize = connection.input.size();
+        connection.input.resize(oldSize + readChunkSize);
+        ssize_t received = read(connection.fd, &connection.input[oldSize], readChunkSize);
+        connection.input.resize(oldSize + (received > 0 ? received : 0));
+        if (received == 0)
+        {
+            // The client shut down its side, the answers already encoded are still sent before hanging up
+            connection.closing = true;
+            connection.input.clear();
+            break;
+        }
+        if (received < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                return false;
+            }
+            break;
+        }
+
+        // Answer every complete request in order, the rest waits for more bytes
+        size_t offset = 0;
+        Request request;
+        size_t frameSize;
+        while (!connection.closing && offset < connection.input.size())
+        {
+            DecodeResult result = decodeRequest(connection.input.data() + offset, connection.input.size() - offset, request, frameSize);
+            if (result == DecodeResult::Incomplete)
+            {
+                break;
+            }
+            if (result == DecodeResult::Invalid)
+            {
+                // The stream cannot be resynchronised, so answer and hang up
+                encodeResponse(Status::BadRequest, 0, nullptr, connection.output);
+                connection.closing = true;
+                break;
+            }
+            handleRequest(request, connection.output);
+            offset += frameSize;
+        }
+        connection.input.erase(0, offset);
+        if (connection.closing)
+        {
+            connection.input.clear();
+            break;
+        }
+    }
+    return true;
+}
+
+/*
+Answer one request
+@param request the request to answer
+@param output the buffer to append the response to
+*/
+void LibraryServer::handleRequest(const Request &request, std::string &output)
+{
+    requestsServed++;
+    switch (request.opcode)
+    {
+    case Opcode::Search:
+    {
+        // Popular artists are encoded straight from the cached result
+        std::shared_ptr<const std::vector<Track>> foundTracks = hashTable.searchShared(request.artist);
+        encodeResponse(foundTracks->empty() ? Status::NotFound : Status::Ok, static_cast<uint32_t>(foundTracks->size()), foundTracks.get(), output);
+        break;
+    }
+    case Opcode::Count:
+    {
+        std::shared_ptr<const std::vector<Track>> foundTracks = hashTable.searchShared(request.artist);
+        encodeResponse(foundTracks->empty() ? Status::NotFound : Status::Ok, static_cast<uint32_t>(foundTracks->size()), nullptr, output);
+        break;
+    }
+    case Opcode::Insert:
+    {
+        // Tracks sent by clients have no line, and a duplicate is answered to the client rather than logged
+        InsertResult result = hashTable.insert(Track(0, request.title, request.artist, request.duration), false);
+        Status status = Status::Ok;
+        if (result == InsertResult::Duplicate)
+        {
+            status = Status::Duplicate;
+        }
+        else if (result == InsertResult::Refused)
+        {
+            status = Status::Refused;
+        }
+        encodeResponse(status, 0, nullptr, output);
+        break;
+    }
+    case Opcode::Remove:
+        encodeResponse(hashTable.remove(request.title, request.artist) ? Status::Ok : Status::NotFound, 0, nullptr, output);
+        break;
+    }
+}
+
+/*
+Send as much pending output as the socket accepts
+@param connection the connection to write to
+@return false if the connection must be closed, true otherwise
+*/
+bool LibraryServer::writeResponses(Connection &connection)
+{
+    while (connection.outputOffset < connection.output.size())
+    {
+        ssize_t sent = send(connection.fd, connection.output.data() + connection.outputOffset,
+                            connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                return false;
+            }
+
+            // Drop the bytes sent once they make up most of the buffer, so reading on does not grow it without end
+            if (connection.outputOffset > connection.output.size() / 2)
+            {
+                connection.output.erase(0, connection.outputOffset);
+                connection.outputOffset = 0;
+            }
+            return true;
+        }
+        connection.outputOffset += sent;
+    }
+    connection.output.clear();
+    connection.outputOffset = 0;
+    return true;
+}
+
+/*
+Register the events a connection waits for, reading stops while too much output is pending
+@param connection the connection to update
+*/
+void LibraryServer::updateEvents(Connection &connection)
+{
+    uint32_t wanted = 0;
+    if (!connection.closing && connection.output.size() - connection.outputOffset < maxPendingOutput)
+    {
+        wanted |= EPOLLIN;
+    }
+    if (!connection.output.empty())
+    {
+        wanted |= EPOLLOUT;
+    }
+    if (wanted != connection.events)
+    {
+        epoll_event event = {};
+        event.events = wanted;
+        event.data.fd = connection.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.events = wanted;
+    }
+}
+
+/*
+Close a connection and forget it
+@param fd the socket of the connection
+*/
+void LibraryServer::closeConnection(int fd)
+{
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
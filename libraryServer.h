@@ -0,0 +1,110 @@
+#ifndef __LIBRARYSERVER_H_
+#define __LIBRARYSERVER_H_
+
+/*
+    libraryServer.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "hashTable.h"
+#include "protocol.h"
+
+// LibraryServer class definition, serves the binary protocol over a Unix domain socket from one epoll loop
+class LibraryServer
+{
+private:
+    // Connection struct holds the unparsed input and the unsent output of a client
+    struct Connection
+    {
+        int fd;
+        std::string input;
+        std::string output;
+        size_t outputOffset; // Bytes of output already sent
+        uint32_t events;     // Events currently registered with epoll
+        bool closing;        // Close once the output is sent, after a bad request or the end of the input
+    };
+
+    // Member datas
+    HashTable &hashTable;
+    std::string socketPath;
+    int listenFd;
+    int epollFd;
+    int wakeFd; // eventfd written by stop()
+    std::unordered_map<int, Connection> connections;
+    uint64_t requestsServed;
+
+    /*
+    Accept every pending connection
+    */
+    void acceptConnections();
+
+    /*
+    Read what a client sent and answer every complete request
+    @param connection the connection to read from
+    @return false if the connection must be closed, true otherwise
+    */
+    bool readRequests(Connection &connection);
+
+    /*
+    Answer one request
+    @param request the request to answer
+    @param output the buffer to append the response to
+    */
+    void handleRequest(const Request &request, std::string &output);
+
+    /*
+    Send as much pending output as the socket accepts
+    @param connection the connection to write to
+    @return false if the connection must be closed, true otherwise
+    */
+    bool writeResponses(Connection &connection);
+
+    /*
+    Register the events a connection waits for, reading stops while too much output is pending
+    @param connection the connection to update
+    */
+    void updateEvents(Connection &connection);
+
+    /*
+    Close a connection and forget it
+    @param fd the socket of the connection
+    */
+    void closeConnection(int fd);
+
+public:
+    // Constructor
+    LibraryServer(HashTable &hashTable, const std::string &socketPath);
+
+    // Destructor
+    ~LibraryServer();
+
+    /*
+    Create the listening socket and the event loop, replacing a stale socket file
+    @return true if successful, false otherwise
+    */
+    bool start();
+
+    /*
+    Serve requests until stop is called
+    */
+    void run();
+
+    /*
+    Make run return, safe to call from another thread or a signal handler
+    */
+    void stop();
+
+    /*
+    Get the number of requests answered so far
+    @return the number of requests answered
+    */
+    uint64_t getRequestsServed() const;
+};
+
+#endif
@@ -0,0 +1,321 @@
+/*
+    lineReader.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstring>
+#include <vector>
+#include <zlib.h>
+
+#include "lineReader.h"
+
+// Size of each read of compressed bytes from the file
+static const size_t compressedChunkSize = 256 << 10;
+
+// GzipInflater class inflates a gzip stream piece by piece, continuing across concatenated members
+class GzipInflater
+{
+private:
+    // Member datas
+    z_stream stream;
+    bool memberComplete; // The last byte consumed ended a member
+    bool failed;
+
+public:
+    // Constructor, windowBits of 15 + 16 only accepts gzip headers
+    GzipInflater() : stream(), memberComplete(false), failed(false)
+    {
+        failed = inflateInit2(&stream, 15 + 16) != Z_OK;
+    }
+
+    // Destructor
+    ~GzipInflater()
+    {
+        inflateEnd(&stream);
+    }
+
+    void setInput(const char *data, size_t size)
+    {
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        stream.avail_in = static_cast<uInt>(size);
+    }
+
+    bool needsInput() const
+    {
+        return stream.avail_in == 0;
+    }
+
+    // True when every member seen so far was complete and valid
+    bool isComplete() const
+    {
+        return memberComplete && !failed;
+    }
+
+    bool hasFailed() const
+    {
+        return failed;
+    }
+
+    /*
+    Inflate input until the output is full or the input is used up
+    @param output the buffer to inflate into
+    @param capacity the size of the buffer
+    @return the number of bytes written to the buffer
+    */
+    size_t inflateInto(char *output, size_t capacity)
+    {
+        size_t produced = 0;
+        while (produced < capacity && stream.avail_in > 0 && !failed)
+        {
+            stream.next_out = reinterpret_cast<Bytef *>(output + produced);
+            stream.avail_out = static_cast<uInt>(capacity - produced);
+            int status = inflate(&stream, Z_NO_FLUSH);
+            produced = capacity - stream.avail_out;
+            if (status == Z_STREAM_END)
+            {
+                // Another member may follow, as in files written by several compressing threads
+                memberComplete = true;
+                inflateReset(&stream);
+            }
+            else if (status == Z_OK)
+            {
+                memberComplete = false;
+            }
+            else
+            {
+                // Z_BUF_ERROR here means no progress despite input and room, so the data is damaged too
+                failed = true;
+            }
+        }
+        return produced;
+    }
+};
+
+/*
+Recognise the compression of data from its first bytes
+@param data the first bytes of the data
+@param size the number of bytes available
+@return the compression of the data
+*/
+Compression detectCompression(const char *data, size_t size)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    if (size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b)
+    {
+        return Compression::Gzip;
+    }
+    if (size >= 4 && bytes[0] == 0x28 && bytes[1] == 0xb5 && bytes[2] == 0x2f && bytes[3] == 0xfd)
+    {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+/*
+Decompress gzip data held in memory, including several concatenated members
+@param compressed the compressed bytes
+@param output the string receiving the decompressed bytes
+@return true if the data was complete and valid, false otherwise, output keeps what could be decompressed
+*/
+bool decompressGzip(const std::string &compressed, std::string &output)
+{
+    GzipInflater inflater;
+    inflater.setInput(compressed.data(), compressed.size());
+    output.clear();
+    size_t filled = 0;
+    while (!inflater.needsInput() && !inflater.hasFailed())
+    {
+        // Grow geometrically, text usually inflates to a few times its compressed size
+        output.resize(std::max(output.size() * 2, compressed.size() * 4 + 4096));
+        filled += inflater.inflateInto(&output[filled], output.size() - filled);
+    }
+    output.resize(filled);
+    return inflater.isComplete();
+}
+
+/*
+Constructor, opens the file and starts decompressing it if its magic bytes say so
+@param fileName the name of the file
+*/
+LineReader::LineReader(const std::string &fileName)
+    : file(fileName, std::ios::binary), compression(Compression::None), opened(false),
+      finished(false), stopRequested(false), corrupt(false), position(0)
+{
+    if (!file)
+    {
+        return;
+    }
+
+    char magic[4];
+    file.read(magic, sizeof(magic));
+    compression = detectCompression(magic, file.gcount());
+    file.clear();
+    file.seekg(0);
+
+    opened = compression != Compression::Zstd;
+    if (compression == Compression::Gzip)
+    {
+        decompressor = std::thread(&LineReader::decompress, this);
+    }
+}
+
+// Destructor, stops the decompression thread
+LineReader::~LineReader()
+{
+    if (decompressor.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopRequested = true;
+        }
+        changed.notify_all();
+        decompressor.join();
+    }
+}
+
+/*
+Check whether the file can be read, zstd files are opened but not readable
+@return true if the lines can be read, false otherwise
+*/
+bool LineReader::isOpen() const
+{
+    return opened;
+}
+
+/*
+Get the compression recognised from the magic bytes
+@return the compression of the file
+*/
+Compression LineReader::getCompression() const
+{
+    return compression;
+}
+
+/*
+Read the next line without its newline, like std::getline
+@param line the string receiving the line
+@return true if a line was read, false at the end of the file
+*/
+bool LineReader::readLine(std::string &line)
+{
+    if (compression == Compression::None)
+    {
+        return static_cast<bool>(std::getline(file, line));
+    }
+
+    // A line may span several blocks
+    line.clear();
+    bool readAny = false;
+    while (true)
+    {
+        if (position < current.size())
+        {
+            readAny = true;
+            const char *start = current.data() + position;
+            const char *newline = static_cast<const char *>(std::memchr(start, '\n', current.size() - position));
+            if (newline)
+            {
+                line.append(start, newline - start);
+                position = newline - current.data() + 1;
+                return true;
+            }
+            line.append(start, current.size() - position);
+            position = current.size();
+        }
+        if (!nextBlock())
+        {
+            return readAny;
+        }
+    }
+}
+
+/*
+Check, once every line is read, whether the compressed data was damaged
+@return true if the compressed data was invalid or truncated, false otherwise
+*/
+bool LineReader::isCorrupt()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return finished && corrupt;
+}
+
+/*
+Wait for the next decompressed block and make it current
+@return true if there was one, false at the end of the data
+*/
+bool LineReader::nextBlock()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]()
+                 { return !blocks.empty() || finished; });
+    if (blocks.empty())
+    {
+        return false;
+    }
+    current = std::move(blocks.front());
+    blocks.pop_front();
+    position = 0;
+    lock.unlock();
+    changed.notify_all();
+    return true;
+}
+
+/*
+Inflate the whole file into blocks, run by the decompression thread
+*/
+void LineReader::decompress()
+{
+    GzipInflater inflater;
+    std::vector<char> input(compressedChunkSize);
+    std::string block(blockSize, '\0');
+    size_t filled = 0;
+    bool stopped = false;
+
+    // Hand a block over, waiting while the reader is maxQueuedBlocks behind
+    auto pushBlock = [&]()
+    {
+        block.resize(filled);
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]()
+                     { return blocks.size() < maxQueuedBlocks || stopRequested; });
+        if (stopRequested)
+        {
+            stopped = true;
+            return;
+        }
+        blocks.push_back(std::move(block));
+        lock.unlock();
+        changed.notify_all();
+        block.assign(blockSize, '\0');
+        filled = 0;
+    };
+
+    while (!inflater.hasFailed() && !stopped)
+    {
+        if (inflater.needsInput())
+        {
+            file.read(input.data(), input.size());
+            if (file.gcount() == 0)
+            {
+                break;
+            }
+            inflater.setInput(input.data(), file.gcount());
+        }
+        filled += inflater.inflateInto(&block[filled], blockSize - filled);
+        if (filled == blockSize)
+        {
+            pushBlock();
+        }
+    }
+    if (filled > 0 && !stopped)
+    {
+        pushBlock();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+    corrupt = !inflater.isComplete();
+    changed.notify_all();
+}
@@ -0,0 +1,116 @@
+#ifndef __LINEREADER_H_
+#define __LINEREADER_H_
+
+/*
+    lineReader.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Compression enum lists the formats recognised by their magic bytes
+enum class Compression
+{
+    None,
+    Gzip,
+    Zstd // Recognised so it can be reported, this build cannot decompress it
+};
+
+/*
+Recognise the compression of data from its first bytes
+@param data the first bytes of the data
+@param size the number of bytes available
+@return the compression of the data
+*/
+Compression detectCompression(const char *data, size_t size);
+
+/*
+Decompress gzip data held in memory, including several concatenated members
+@param compressed the compressed bytes
+@param output the string receiving the decompressed bytes
+@return true if the data was complete and valid, false otherwise, output keeps what could be decompressed
+*/
+bool decompressGzip(const std::string &compressed, std::string &output);
+
+// LineReader class definition, reads the lines of a plain or gzip compressed file
+// Compressed files are inflated on a separate thread a few blocks ahead of the lines being read
+class LineReader
+{
+private:
+    // Member datas
+    std::ifstream file;
+    Compression compression;
+    bool opened;
+
+    // Blocks of decompressed bytes passed from the decompression thread to readLine
+    std::thread decompressor;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::string> blocks;
+    bool finished;      // The decompression thread produced its last block
+    bool stopRequested; // The reader is being destroyed
+    bool corrupt;       // The compressed data was invalid or truncated
+    std::string current;
+    size_t position;
+
+    /*
+    Inflate the whole file into blocks, run by the decompression thread
+    */
+    void decompress();
+
+    /*
+    Wait for the next decompressed block and make it current
+    @return true if there was one, false at the end of the data
+    */
+    bool nextBlock();
+
+public:
+    static const size_t blockSize = 1 << 20;
+    static const size_t maxQueuedBlocks = 4;
+
+    /*
+    Constructor, opens the file and starts decompressing it if its magic bytes say so
+    @param fileName the name of the file
+    */
+    LineReader(const std::string &fileName);
+
+    // Destructor, stops the decompression thread
+    ~LineReader();
+
+    LineReader(const LineReader &) = delete;
+    LineReader &operator=(const LineReader &) = delete;
+
+    /*
+    Check whether the file can be read, zstd files are opened but not readable
+    @return true if the lines can be read, false otherwise
+    */
+    bool isOpen() const;
+
+    /*
+    Get the compression recognised from the magic bytes
+    @return the compression of the file
+    */
+    Compression getCompression() const;
+
+    /*
+    Read the next line without its newline, like std::getline
+    @param line the string receiving the line
+    @return true if a line was read, false at the end of the file
+    */
+    bool readLine(std::string &line);
+
+    /*
+    Check, once every line is read, whether the compressed data was damaged
+    @return true if the compressed data was invalid or truncated, false otherwise
+    */
+    bool isCorrupt();
+};
+
+#endif
@@ -0,0 +1,266 @@
+/*
+    loadGenerator.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "latencyHistogram.h"
+#include "protocol.h"
+#include "trackIO.h"
+
+// LoadOptions struct holds the shape of the generated load
+struct LoadOptions
+{
+    size_t connections = 4;
+    size_t requests = 100000; // Per connection
+    size_t pipeline = 16;     // Requests sent before waiting for their responses
+    Opcode opcode = Opcode::Count;
+};
+
+/*
+Print how to use the load generator
+@param programName the name of the program
+*/
+void printUsage(const std::string &programName)
+{
+    std::cerr << "Usage: " << programName << " <socket path> <catalog file> [options]\n"
+              << "Options:\n"
+              << "  --connections <count>  number of concurrent connections (default: 4)\n"
+              << "  --requests <count>     requests sent on each connection (default: 100000)\n"
+              << "  --pipeline <depth>     requests in flight on each connection (default: 16)\n"
+              << "  --search               fetch the tracks instead of only counting them" << std::endl;
+}
+
+/*
+Connect to the server
+@param socketPath the path of the server socket
+@return the connected socket, or -1 on failure
+*/
+int connectToServer(const std::string &socketPath)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+        return -1;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/*
+Send requests in pipelined rounds and record the round trip of each round
+@param fd the connected socket
+@param artists the artists to query, cycled through
+@param firstArtist the artist of the first request, so connections do not query in lockstep
+@param options the shape of the load
+@param histogram the histogram receiving the round trip of each round in nanoseconds
+@return the number of requests answered
+*/
+size_t runConnection(int fd, const std::vector<std::string> &artists, size_t firstArtist,
+                     const LoadOptions &options, LatencyHistogram &histogram)
+{
+    std::string output, input;
+    std::vector<char> chunk(64 << 10);
+    size_t answered = 0;
+    size_t nextArtist = firstArtist;
+    Request request{options.opcode, "", "", 0};
+    Response response;
+
+    while (answered < options.requests)
+    {
+        size_t round = std::min(options.pipeline, options.requests - answered);
+        output.clear();
+        for (size_t i = 0; i < round; ++i)
+        {
+            request.artist = artists[nextArtist++ % artists.size()];
+            encodeRequest(request, output);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t sent = 0; sent < output.size();)
+        {
+            ssize_t written = send(fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL);
+            if (written <= 0)
+            {
+                return answered;
+            }
+            sent += written;
+        }
+
+        // Read until every response of the round has arrived
+        size_t received = 0;
+        while (received < round)
+        {
+            size_t offset = 0;
+            size_t frameSize;
+            DecodeResult result = DecodeResult::Incomplete;
+            while (received < round &&
+                   (result = decodeResponse(input.data() + offset, input.size() - offset, response, frameSize)) == DecodeResult::Complete)
+            {
+                offset += frameSize;
+                received++;
+            }
+            input.erase(0, offset);
+            if (received == round)
+            {
+                break;
+            }
+            if (result == DecodeResult::Invalid)
+            {
+                std::cerr << "Error: invalid response from the server" << std::endl;
+                return answered;
+            }
+
+            ssize_t bytes = read(fd, chunk.data(), chunk.size());
+            if (bytes <= 0)
+            {
+                return answered;
+            }
+            input.append(chunk.data(), bytes);
+        }
+        histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        answered += round;
+    }
+    return answered;
+}
+
+/*
+Main function of the load generator
+@param argc the number of command-line arguments
+@param argv array of command-line argument strings
+@return 0 upon successful completion
+*/
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string socketPath = argv[1];
+    LoadOptions options;
+    try
+    {
+        for (int i = 3; i < argc; ++i)
+        {
+            std::string option = argv[i];
+            if (option == "--search")
+            {
+                options.opcode = Opcode::Search;
+            }
+            else if (option == "--connections" && i + 1 < argc)
+            {
+                options.connections = std::stoull(argv[++i]);
+            }
+            else if (option == "--requests" && i + 1 < argc)
+            {
+                options.requests = std::stoull(argv[++i]);
+            }
+            else if (option == "--pipeline" && i + 1 < argc)
+            {
+                options.pipeline = std::stoull(argv[++i]);
+            }
+            else
+            {
+                throw std::invalid_argument(option);
+            }
+        }
+        if (options.connections == 0 || options.pipeline == 0)
+        {
+            throw std::invalid_argument("connections and pipeline must be positive");
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: invalid argument " << ex.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Query the artists of the catalog, most of which the server should know
+    std::vector<std::string> artists;
+    for (const Track &track : loadTracksFromFile(argv[2]))
+    {
+        artists.push_back(track.getArtist());
+    }
+    if (artists.empty())
+    {
+        std::cerr << "Exiting due to empty or invalid file." << std::endl;
+        return 1;
+    }
+
+    std::vector<int> sockets;
+    for (size_t i = 0; i < options.connections; ++i)
+    {
+        int fd = connectToServer(socketPath);
+        if (fd < 0)
+        {
+            std::cerr << "Error: could not connect to " << socketPath << ": " << std::strerror(errno) << std::endl;
+            for (int openFd : sockets)
+            {
+                close(openFd);
+            }
+            return 1;
+        }
+        sockets.push_back(fd);
+    }
+
+    std::vector<std::unique_ptr<LatencyHistogram>> histograms;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> answered{0};
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < options.connections; ++i)
+    {
+        histograms.emplace_back(new LatencyHistogram());
+        LatencyHistogram &histogram = *histograms.back();
+        size_t firstArtist = i * artists.size() / options.connections;
+        threads.emplace_back([&, fd = sockets[i], firstArtist]()
+                             { answered += runConnection(fd, artists, firstArtist, options, histogram); });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (int fd : sockets)
+    {
+        close(fd);
+    }
+
+    std::vector<uint64_t> totals;
+    for (const std::unique_ptr<LatencyHistogram> &histogram : histograms)
+    {
+        histogram->addTo(totals);
+    }
+    LatencySummary summary = LatencyHistogram::summarize(totals);
+
+    std::cout << "Requests:          " << answered << " of " << options.connections * options.requests << "\n"
+              << "Seconds:           " << seconds << "\n"
+              << "Requests/second:   " << static_cast<uint64_t>(answered / seconds) << "\n"
+              << "Round trip of " << options.pipeline << " pipelined requests (ns): p50 " << summary.p50
+              << ", p99 " << summary.p99 << ", p99.9 " << summary.p999 << ", max " << summary.max << std::endl;
+    return answered == options.connections * options.requests ? 0 : 1;
+}
@@ -2,7 +2,7 @@
 main.cpp
 Author: M00826933
 Created: 11/04/23
-Updated: 16/04/23
+Updated: 19/10/26
 */
 
 #include <iostream>
@@ -11,75 +11,165 @@ Updated: 16/04/23
 #include <string>
 #include <vector>
 #include <iomanip>
+#include <csignal>
+#include <mutex>
 
 #include "main.h"
 #include "track.h"
 #include "hashTable.h"
+#include "trackIO.h"
+#include "trackColumns.h"
 
 /*
-Check the number of arguments passed to the program
-@param programName the name of the program
+Parse the arguments passed to the program, printing the usage if they are invalid
 @param argc the number of command-line arguments
+@param argv the command-line arguments
+@param options the options to fill
+@return true if the arguments are valid, false otherwise
 */
-void checkNumberOfArguments(std::string programName, int argc)
+bool parseArguments(int argc, char *argv[], CommandLineOptions &options)
 {
-    if (argc != 2)
+    bool valid = argc >= 2;
+    for (int i = 1; valid && i < argc; ++i)
     {
-        std::cerr << "Usage: " << programName << " <filename>" << std::endl;
-        exit(1);
+        std::string argument = argv[i];
+        if (argument == "--remove" && i + 1 < argc)
+        {
+            options.removalFile = argv[++i];
+        }
+        else if (argument == "--script" && i + 1 < argc)
+        {
+            options.scriptFile = argv[++i];
+        }
+        else if (argument == "--serve" && i + 1 < argc)
+        {
+            options.socketPath = argv[++i];
+        }
+        else if (argument == "--publish" && i + 1 < argc)
+        {
+            options.sharedName = argv[++i];
+        }
+        else if (argument == "--freeze" && i + 1 < argc)
+        {
+            options.frozenFile = argv[++i];
+        }
+        else if (argument == "--ingest" && i + 1 < argc)
+        {
+            // Every following argument up to the next option is a file to ingest
+            while (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0)
+            {
+                options.ingestFiles.push_back(argv[++i]);
+            }
+        }
+        else if (options.catalogFile.empty() && argument.compare(0, 2, "--") != 0)
+        {
+            options.catalogFile = argument;
+        }
+        else
+        {
+            valid = false;
+        }
+    }
+
+    // Batch mode and server mode both replace the menu, so only one of them can be asked for
+    if (!valid || options.catalogFile.empty() || (!options.scriptFile.empty() && !options.socketPath.empty()))
+    {
+        std::cerr << "Usage: " << argv[0] << " <filename> [--ingest <file>...] [--remove <removal file>] [--publish <shared catalog name>] [--freeze <frozen catalog file>] [--script <command file> | --script - | --serve <socket path>]" << std::endl;
+        return false;
     }
+    return true;
 }
 
 /*
-Load tracks from a file
-@param fileName the name of the file containing the tracks
-@return a vector of Track objects loaded from the file
+Ingest many track files concurrently and report how many tracks each added
+@param hashTable the HashTable object storing the tracks
+@param fileNames the names of the files to ingest
+@param output the stream to write the report to
+@return the number of tracks added
 */
-std::vector<Track> loadTracksFromFile(const std::string &fileName)
+size_t ingestTrackFiles(HashTable &hashTable, const std::vector<std::string> &fileNames, std::ostream &output)
 {
-    std::vector<Track> tracks;
-    std::ifstream inputFile(fileName);
-
-    // Open input file
-    if (!inputFile)
+    IngestSummary summary = ingestFiles(hashTable, fileNames);
+    for (const FileIngestResult &file : summary.files)
     {
-        std::cerr << "Error: could not open file " << fileName << std::endl;
-        return tracks;
+        if (file.opened)
+        {
+            output << "Added " << file.inserted << " of " << file.rows << " rows from " << file.fileName << "." << std::endl;
+        }
     }
+    output << "Ingested " << summary.inserted << " tracks from " << fileNames.size() << " files using "
+           << (summary.usedIoUring ? "io_uring" : "reader threads") << "." << std::endl;
+    return summary.inserted;
+}
+
+// Server stopped by SIGINT and SIGTERM
+static LibraryServer *runningServer = nullptr;
 
-    // Check if file is empty
-    if (inputFile.peek() == std::ifstream::traits_type::eof())
+/*
+Stop the running server when the process is asked to terminate
+*/
+static void stopServer(int)
+{
+    if (runningServer)
     {
-        std::cerr << "Error: file " << fileName << " is empty" << std::endl;
-        inputFile.close();
-        return tracks;
+        runningServer->stop();
     }
+}
 
-    std::string line;
-    int lineNumber = 0;
-    while (std::getline(inputFile, line))
+/*
+Serve queries on a Unix socket until SIGINT or SIGTERM is received
+@param hashTable the HashTable object storing the tracks
+@param socketPath the path of the socket to listen on
+@return true if the server ran, false if it could not start
+*/
+bool serveLibrary(HashTable &hashTable, const std::string &socketPath)
+{
+    LibraryServer server(hashTable, socketPath);
+    if (!server.start())
     {
-        lineNumber++;
-        std::istringstream lineStream(line);
-        std::string title, artist, durationStr;
-        std::getline(lineStream, title, '\t');
-        std::getline(lineStream, artist, '\t');
-        std::getline(lineStream, durationStr, '\t');
+        return false;
+    }
+
+    // Responses never carry line numbers, so a long running server does not keep them
+    hashTable.discardLineNumbers();
+    runningServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    std::cout << "Serving " << hashTable.size() << " tracks on " << socketPath << ", press Ctrl+C to stop." << std::endl;
+    server.run();
+    runningServer = nullptr;
+
+    std::cout << "Served " << server.getRequestsServed() << " requests." << std::endl;
+    return true;
+}
+
+/*
+Remove every track listed in a removal file from the hash table and report the ones not found
+@param hashTable the HashTable object storing the tracks
+@param fileName the name of the file containing the tracks to remove
+@param output the stream to write the report to
+@return the number of tracks removed
+*/
+size_t removeTracksFromFile(HashTable &hashTable, const std::string &fileName, std::ostream &output)
+{
+    std::vector<std::pair<std::string, std::string>> removals = loadRemovalsFromFile(fileName);
+    std::vector<bool> removed = hashTable.removeMany(removals);
 
-        try
+    size_t removedCount = 0;
+    for (size_t i = 0; i < removals.size(); ++i)
+    {
+        if (removed[i])
         {
-            int duration = std::stoi(durationStr);
-            tracks.emplace_back(lineNumber, title, artist, duration);
+            removedCount++;
         }
-        catch (const std::invalid_argument &ex)
+        else
         {
-            std::cerr << "Warning: Invalid duration value on line " << lineNumber << ": Track \"" << title << "\" by artist \"" << artist << ". Skipping track." << std::endl;
-            continue;
+            output << "Track \"" << removals[i].first << "\" by " << removals[i].second << " could not be found and therefore not removed." << std::endl;
         }
     }
 
-    inputFile.close();
-    return tracks;
+    output << "Removed " << removedCount << " of " << removals.size() << " tracks listed in " << fileName << "." << std::endl;
+    return removedCount;
 }
 
 // Print a message to prompt the user to press any key to continue
@@ -97,19 +187,29 @@ void cleanScreen()
 
 /*
 Display the main menu and handle user inputs
+Tracks added from a file load in the background, so every use of the table holds tableMutex
 @param hashTable the HashTable object storing the tracks
 */
 void mainMenu(HashTable &hashTable)
 {
+    std::mutex tableMutex;
+    BackgroundLoader loader(hashTable, tableMutex);
+    std::unique_ptr<TrackColumns> analyticsColumns; // Lives no longer than the menu, and so than the table
     std::string choice;
     do
     {
+        showLoadProgress(loader.getProgress());
         std::cout << "---------- MAIN MENU ----------\n"
                   << "[1] Add tracks from a file\n"
                   << "[2] Save tracks in the library to a file\n"
                   << "[3] Search for tracks by artist\n"
                   << "[4] Remove a track\n"
-                  << "[5] Exit\n"
+                  << "[5] Search for tracks by title words\n"
+                  << "[6] Search for tracks by duration range\n"
+                  << "[7] Show catalog analytics\n"
+                  << "[8] Show hash table statistics\n"
+                  << "[9] Show operation latencies\n"
+                  << "[10] Exit\n"
                   << "\n"
                   << "Enter your choice: ";
 
@@ -118,36 +218,81 @@ void mainMenu(HashTable &hashTable)
 
         if (choice == "1")
         {
-            addTracksFromFile(hashTable);
+            addTracksFromFile(loader);
 
             drawPressAnyKeys();
             cleanScreen();
         }
         else if (choice == "2")
         {
+            // Ask whether to compress the snapshot, compressed files load back like plain ones
+            std::string compressAnswer;
+            std::cout << std::endl
+                      << "Compress the file with gzip? (y/n): ";
+            std::cin >> compressAnswer;
+            std::cin.ignore();
+            Compression compression = compressAnswer == "y" || compressAnswer == "Y" ? Compression::Gzip : Compression::None;
+
             // Generate file name with current timestamp
             std::time_t now = std::time(nullptr);
             std::stringstream ss;
             ss << "tracks_" << std::put_time(std::localtime(&now), "%Y-%m-%d_%H-%M-%S") << ".txt";
+            if (compression == Compression::Gzip)
+            {
+                ss << ".gz";
+            }
             std::string fileName = ss.str();
 
             // Save tracks to file
             std::cout << "Saving tracks to file: " << fileName << std::endl;
-            saveTracksToFile(hashTable, fileName);
+            saveTracksToFile(hashTable, fileName, tableMutex, compression);
             std::cout << std::endl;
         }
         else if (choice == "3")
         {
             std::string artistToSearch = getArtistToSearch();
-            searchTracksByArtist(hashTable, artistToSearch);
+            searchTracksByArtist(hashTable, artistToSearch, tableMutex);
         }
         else if (choice == "4")
         {
             std::pair<std::string, std::string> trackToRemove = getTrackToRemove();
+            std::lock_guard<std::mutex> lock(tableMutex);
             removeTrack(hashTable, trackToRemove.first, trackToRemove.second);
         }
         else if (choice == "5")
         {
+            std::pair<std::string, bool> titleQuery = getTitleQueryToSearch();
+            std::lock_guard<std::mutex> lock(tableMutex);
+            searchTracksByTitle(hashTable, titleQuery.first, titleQuery.second);
+        }
+        else if (choice == "6")
+        {
+            int minDuration, maxDuration;
+            if (getDurationRangeToSearch(minDuration, maxDuration))
+            {
+                std::lock_guard<std::mutex> lock(tableMutex);
+                searchTracksByDuration(hashTable, minDuration, maxDuration);
+            }
+        }
+        else if (choice == "7")
+        {
+            std::lock_guard<std::mutex> lock(tableMutex);
+            showCatalogAnalytics(hashTable, analyticsColumns);
+        }
+        else if (choice == "8")
+        {
+            std::lock_guard<std::mutex> lock(tableMutex);
+            showHashTableStatistics(hashTable);
+        }
+        else if (choice == "9")
+        {
+            showOperationLatencies();
+        }
+        else if (choice == "10")
+        {
+            // Stop a running load before exit skips the destructors
+            loader.cancel();
+            loader.wait();
             std::cout << "Exiting..." << std::endl;
             exit(0);
         }
@@ -157,40 +302,69 @@ void mainMenu(HashTable &hashTable)
                       << "Invalid choice. Please try again." << std::endl
                       << std::endl;
         }
-    } while (choice != "5");
+    } while (choice != "10");
 }
 
 /*
-Add tracks from a file to the hash table
-@param hashTable the HashTable object storing the tracks
-@return true if successful, false otherwise
+Display one line about the running or last background load, nothing if there was none
+@param progress the progress of the load
 */
-bool addTracksFromFile(HashTable &hashTable)
+void showLoadProgress(const LoadProgress &progress)
 {
-    std::string fileName;
-    std::cout << std::endl
-              << "Enter the file name containing new tracks: ";
-    std::getline(std::cin, fileName);
+    const char *stateNames[] = {"idle", "running", "finished", "cancelled", "failed to open the file"};
+    if (progress.state == LoadState::Idle)
+    {
+        return;
+    }
+    std::cout << "Loading " << progress.fileName << " (" << stateNames[static_cast<int>(progress.state)] << "): "
+              << progress.rowsParsed << " rows parsed, " << progress.rowsInserted << " tracks added, "
+              << progress.warnings << " invalid durations, " << progress.duplicates << " duplicates\n"
+              << std::endl;
+}
 
-    std::vector<Track> newTracks = loadTracksFromFile(fileName);
-    for (const auto &track : newTracks)
+/*
+Start adding tracks from a file in the background, or offer to cancel the load already running
+@param loader the BackgroundLoader object adding tracks to the hash table
+@return true if a load was started or cancelled, false otherwise
+*/
+bool addTracksFromFile(BackgroundLoader &loader)
+{
+    std::string answer;
+    if (loader.isRunning())
     {
-        hashTable.insert(track);
+        std::cout << std::endl
+                  << "A file is still loading. Cancel it? (y/n): ";
+        std::getline(std::cin, answer);
+        if (answer != "y" && answer != "Y")
+        {
+            return false;
+        }
+        loader.cancel();
+        std::cout << "The load stops after its current chunk, tracks already added are kept.\n"
+                  << std::endl;
+        return true;
     }
 
     std::cout << std::endl
-              << "Successfully added " << newTracks.size() << " tracks from the file.\n"
+              << "Enter the file name containing new tracks: ";
+    std::getline(std::cin, answer);
+    loader.start(answer);
+
+    std::cout << std::endl
+              << "Loading tracks in the background, the library stays usable meanwhile.\n"
               << std::endl;
-    return 0;
+    return true;
 }
 
 /*
 Save tracks from the hash table to a file
 @param hashTable the HashTable object storing the tracks
 @param fileName the name of the file to save the tracks to
+@param tableMutex the mutex guarding the hash table, held while writing
+@param compression the compression of the file
 @return true if successful, false otherwise
 */
-bool saveTracksToFile(const HashTable &hashTable, const std::string &fileName)
+bool saveTracksToFile(const HashTable &hashTable, const std::string &fileName, std::mutex &tableMutex, Compression compression)
 {
     // Request user confirmation
     std::string userConfirmation;
@@ -206,23 +380,13 @@ bool saveTracksToFile(const HashTable &hashTable, const std::string &fileName)
         return 1;
     }
 
-    std::ofstream outputFile(fileName);
-
-    if (!outputFile)
+    std::lock_guard<std::mutex> lock(tableMutex);
+    if (!writeTracksToFile(hashTable, fileName, compression))
     {
-        std::cerr << "Error: could not open file " << fileName << " for writing" << std::endl;
         return 1;
     }
 
-    std::vector<Track> tracks = hashTable.getAllTracks();
-
-    for (const auto &track : tracks)
-    {
-        outputFile << track.getTitle() << "\t" << track.getArtist() << "\t" << track.getDuration() << std::endl;
-    }
-
-    outputFile.close();
-    std::cout << "Successfully saved " << tracks.size() << " tracks to the file " << fileName << "." << std::endl;
+    std::cout << "Successfully saved " << hashTable.size() << " tracks to the file " << fileName << "." << std::endl;
     return 0;
 }
 
@@ -240,38 +404,345 @@ std::string getArtistToSearch()
 }
 
 /*
-Search for tracks by an artist and display the results
+Search for tracks by an artist and display the results a page at a time, sorted by title or duration
 @param hashTable the HashTable object storing the tracks
 @param artist the artist's name to search for
+@param tableMutex the mutex guarding the hash table, held while reading each page but not while prompting
 */
-void searchTracksByArtist(const HashTable &hashTable, const std::string &artist)
+void searchTracksByArtist(const HashTable &hashTable, const std::string &artist, std::mutex &tableMutex)
 {
-    std::vector<Track> foundTracks = hashTable.search(artist);
+    const size_t pageSize = 20;
+    TrackOrder order = TrackOrder::Title;
+    size_t offset = 0;
+    TrackPage page;
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        page = hashTable.searchPage(artist, order, offset, pageSize);
+        if (page.totalTracks == 0)
+        {
+            std::cerr << "No tracks found for artist \"" << artist << "\".\n";
+
+            // Suggest the closest artists in case the name was mistyped
+            std::vector<ArtistMatch> similarArtists = hashTable.findSimilarArtists(artist, 2);
+            if (!similarArtists.empty())
+            {
+                std::cout << "Did you mean:\n";
+                for (size_t i = 0; i < similarArtists.size() && i < 5; ++i)
+                {
+                    std::cout << "  " << similarArtists[i].artist << "\n";
+                }
+            }
+            std::cout << "\n";
+            return;
+        }
+    }
+
+    std::cout << "Tracks found for artist " << artist << ":\n\n";
+    while (true)
+    {
+        // Print table header
+        std::cout << std::left << std::setw(35) << "Title" << std::setw(20) << "Duration (seconds)"
+                  << "\n";
+        std::cout << std::setfill('-') << std::setw(57) << ""
+                  << "\n";
+        std::cout << std::setfill(' ');
+
+        // Print table rows
+        for (const auto &track : page.tracks)
+        {
+            std::cout << std::left << std::setw(35) << track.getTitle() << std::setw(20) << track.getDuration() << "\n";
+        }
+        std::cout << "\nTracks " << offset + 1 << " to " << offset + page.tracks.size() << " of " << page.totalTracks << "\n\n";
+
+        // A single page needs no prompt
+        if (page.totalTracks <= pageSize)
+        {
+            return;
+        }
+        std::string answer;
+        std::cout << "Enter n for the next page, p for the previous one, t or d to sort by title or duration, anything else to stop: ";
+        std::getline(std::cin, answer);
+        std::cout << std::endl;
+        if (answer == "n" && offset + pageSize < page.totalTracks)
+        {
+            offset += pageSize;
+        }
+        else if (answer == "p" && offset >= pageSize)
+        {
+            offset -= pageSize;
+        }
+        else if (answer == "t" || answer == "d")
+        {
+            order = answer == "t" ? TrackOrder::Title : TrackOrder::Duration;
+            offset = 0;
+        }
+        else if (answer != "n" && answer != "p")
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(tableMutex);
+        page = hashTable.searchPage(artist, order, offset, pageSize);
+        // Tracks removed meanwhile may leave the page past the end
+        if (page.tracks.empty())
+        {
+            return;
+        }
+    }
+}
+
+/*
+Get the title words to search for and whether all of them must match
+@return a pair containing the title words and true if every word must match
+*/
+std::pair<std::string, bool> getTitleQueryToSearch()
+{
+    std::string titleQuery, matchMode;
+    std::cout << "Enter the words to search for in track titles: ";
+    std::getline(std::cin, titleQuery);
+    std::cout << "Match all words? (y/n): ";
+    std::getline(std::cin, matchMode);
+    std::cout << std::endl;
+    return std::make_pair(titleQuery, matchMode != "n" && matchMode != "N");
+}
+
+/*
+Search for tracks by words in their title and display the results
+@param hashTable the HashTable object storing the tracks
+@param query the title words to search for
+@param matchAllWords true if every word must match, false if any word may match
+*/
+void searchTracksByTitle(const HashTable &hashTable, const std::string &query, bool matchAllWords)
+{
+    std::vector<Track> foundTracks = hashTable.searchByTitle(query, matchAllWords);
 
     if (foundTracks.empty())
     {
-        std::cerr << "No tracks found for artist \"" << artist << "\".\n";
+        std::cerr << "No tracks found with title words \"" << query << "\".\n";
         return;
     }
 
-    std::cout << "Tracks found for artist " << artist << ":\n\n";
+    std::cout << "Tracks found with title words " << query << ":\n\n";
 
     // Print table header
-    std::cout << std::left << std::setw(35) << "Title" << std::setw(20) << "Duration (seconds)"
+    std::cout << std::left << std::setw(35) << "Title" << std::setw(25) << "Artist" << std::setw(20) << "Duration (seconds)"
               << "\n";
-    std::cout << std::setfill('-') << std::setw(57) << ""
+    std::cout << std::setfill('-') << std::setw(82) << ""
               << "\n";
     std::cout << std::setfill(' ');
 
     // Print table rows
     for (const auto &track : foundTracks)
     {
-        std::cout << std::left << std::setw(35) << track.getTitle() << std::setw(20) << track.getDuration() << "\n";
+        std::cout << std::left << std::setw(35) << track.getTitle() << std::setw(25) << track.getArtist() << std::setw(20) << track.getDuration() << "\n";
     }
 
     std::cout << "\n";
 }
 
+/*
+Get the shortest and longest durations to search for
+@param minDuration set to the shortest duration in seconds
+@param maxDuration set to the longest duration in seconds
+@return true if both durations are valid numbers, false otherwise
+*/
+bool getDurationRangeToSearch(int &minDuration, int &maxDuration)
+{
+    std::string minInput, maxInput;
+    std::cout << "Enter the shortest duration in seconds: ";
+    std::getline(std::cin, minInput);
+    std::cout << "Enter the longest duration in seconds: ";
+    std::getline(std::cin, maxInput);
+    std::cout << std::endl;
+
+    try
+    {
+        minDuration = std::stoi(minInput);
+        maxDuration = std::stoi(maxInput);
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Invalid duration. Please enter a number of seconds.\n"
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+Search for tracks within a duration range and display the results
+@param hashTable the HashTable object storing the tracks
+@param minDuration the shortest duration in seconds, inclusive
+@param maxDuration the longest duration in seconds, inclusive
+*/
+void searchTracksByDuration(const HashTable &hashTable, int minDuration, int maxDuration)
+{
+    std::vector<Track> foundTracks = hashTable.searchByDuration(minDuration, maxDuration);
+
+    if (foundTracks.empty())
+    {
+        std::cerr << "No tracks found between " << minDuration << " and " << maxDuration << " seconds.\n";
+        return;
+    }
+
+    std::cout << foundTracks.size() << " tracks found between " << minDuration << " and " << maxDuration << " seconds:\n\n";
+
+    // Print table header
+    std::cout << std::left << std::setw(35) << "Title" << std::setw(25) << "Artist" << std::setw(20) << "Duration (seconds)"
+              << "\n";
+    std::cout << std::setfill('-') << std::setw(82) << ""
+              << "\n";
+    std::cout << std::setfill(' ');
+
+    // Print table rows
+    for (const auto &track : foundTracks)
+    {
+        std::cout << std::left << std::setw(35) << track.getTitle() << std::setw(25) << track.getArtist() << std::setw(20) << track.getDuration() << "\n";
+    }
+
+    std::cout << "\n";
+}
+
+/*
+Display duration aggregates, the most prolific artists and a duration histogram of the library
+@param hashTable the HashTable object storing the tracks
+@param cachedColumns the columnar copy of the table kept between calls, replaced once a track changed
+*/
+void showCatalogAnalytics(const HashTable &hashTable, std::unique_ptr<TrackColumns> &cachedColumns)
+{
+    // Scan a column oriented copy rather than the linked lists, copied again only once a track changed
+    if (!cachedColumns || !cachedColumns->isCurrent(hashTable))
+    {
+        cachedColumns.reset(new TrackColumns(hashTable));
+    }
+    const TrackColumns &columns = *cachedColumns;
+    if (columns.size() == 0)
+    {
+        std::cerr << "The library is empty.\n"
+                  << std::endl;
+        return;
+    }
+
+    std::cout << "Tracks: " << columns.size() << "\n"
+              << "Artists: " << columns.artistCount() << "\n"
+              << "Total duration (seconds): " << columns.totalDuration() << "\n"
+              << "Shortest duration (seconds): " << columns.minDuration() << "\n"
+              << "Longest duration (seconds): " << columns.maxDuration() << "\n"
+              << "Average duration (seconds): " << std::fixed << std::setprecision(1) << columns.averageDuration() << "\n\n";
+    std::cout.unsetf(std::ios::floatfield);
+
+    // Print the artists with the most tracks
+    std::vector<std::pair<std::string, size_t>> artistCounts = columns.countPerArtist();
+    std::cout << std::left << std::setw(35) << "Artist" << std::setw(20) << "Tracks"
+              << "\n";
+    std::cout << std::setfill('-') << std::setw(57) << ""
+              << "\n";
+    std::cout << std::setfill(' ');
+    for (size_t i = 0; i < artistCounts.size() && i < 10; ++i)
+    {
+        std::cout << std::left << std::setw(35) << artistCounts[i].first << std::setw(20) << artistCounts[i].second << "\n";
+    }
+    std::cout << "\n";
+
+    // Print the number of tracks per minute of duration
+    std::vector<size_t> histogram = columns.durationHistogram(60);
+    std::cout << std::left << std::setw(35) << "Duration (minutes)" << std::setw(20) << "Tracks"
+              << "\n";
+    std::cout << std::setfill('-') << std::setw(57) << ""
+              << "\n";
+    std::cout << std::setfill(' ');
+    for (size_t minute = 0; minute < histogram.size(); ++minute)
+    {
+        if (histogram[minute] > 0)
+        {
+            std::string range = std::to_string(minute) + "-" + std::to_string(minute + 1);
+            if (minute + 1 == TrackColumns::maxHistogramBuckets)
+            {
+                range = std::to_string(minute) + "+";
+            }
+            std::cout << std::left << std::setw(35) << range << std::setw(20) << histogram[minute] << "\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+/*
+Display the shape and the operation counters of the hash table, followed by the same data as JSON
+@param hashTable the HashTable object storing the tracks
+*/
+void showHashTableStatistics(const HashTable &hashTable)
+{
+    HashTableStats stats = hashTable.getStats();
+
+    std::cout << std::left << std::setw(35) << "Buckets" << stats.tableSize << "\n"
+              << std::setw(35) << "Tracks" << stats.trackCount << "\n"
+              << std::setw(35) << "Load factor" << stats.loadFactor << "\n"
+              << std::setw(35) << "Used buckets" << stats.usedBuckets << "\n"
+              << std::setw(35) << "Longest artist chain" << stats.longestChain << "\n"
+              << std::setw(35) << "Longest (artist, title) chain" << stats.longestKeyChain << "\n"
+              << std::setw(35) << "Distinct artists" << stats.artistCount << "\n"
+              << std::setw(35) << "Artist dictionary bytes" << stats.artistBytes << "\n"
+              << std::setw(35) << "Artist filter bytes" << stats.filterBytes << "\n"
+              << std::setw(35) << "Track record bytes" << stats.trackBytes << "\n"
+              << std::setw(35) << "Cached search results" << stats.cachedResults << " (" << stats.cachedTracks << " tracks)\n"
+              << std::setw(35) << "Artists kept sorted for paging" << stats.orderedArtists << " (" << stats.orderedTracks << " tracks)\n"
+              << std::setw(35) << "Resizes" << stats.resizes << "\n";
+
+    if (stats.countersEnabled)
+    {
+        std::cout << std::setw(35) << "Inserts" << stats.inserts << "\n"
+                  << std::setw(35) << "Duplicate rejects" << stats.duplicateRejects << "\n"
+                  << std::setw(35) << "Artist searches" << stats.searches << "\n"
+                  << std::setw(35) << "Probes per artist search"
+                  << (stats.searches ? static_cast<double>(stats.searchProbes) / stats.searches : 0) << "\n"
+                  << std::setw(35) << "Searches stopped by the filter" << stats.filterRejects << "\n"
+                  << std::setw(35) << "Search cache hit rate"
+                  << (stats.cacheHits + stats.cacheMisses ? static_cast<double>(stats.cacheHits) / (stats.cacheHits + stats.cacheMisses) : 0) << "\n"
+                  << std::setw(35) << "Search cache invalidations" << stats.cacheInvalidations << "\n"
+                  << std::setw(35) << "Search cache evictions" << stats.cacheEvictions << "\n"
+                  << std::setw(35) << "Key lookups" << stats.keyLookups << "\n"
+                  << std::setw(35) << "Probes per key lookup"
+                  << (stats.keyLookups ? static_cast<double>(stats.keyProbes) / stats.keyLookups : 0) << "\n"
+                  << std::setw(35) << "Removes" << stats.removes << "\n"
+                  << std::setw(35) << "Removes of missing tracks" << stats.removeMisses << "\n";
+    }
+    else
+    {
+        std::cout << "Operation counters are disabled in this build.\n";
+    }
+
+    std::cout << "\n";
+    hashTable.writeStats(std::cout);
+    std::cout << std::endl;
+}
+
+/*
+Display the latency percentiles of every library operation, followed by the same data as JSON
+*/
+void showOperationLatencies()
+{
+    if (!LATENCY_STATS)
+    {
+        std::cout << "Latency histograms are disabled in this build.\n\n";
+        return;
+    }
+
+    std::cout << std::left << std::setw(15) << "Operation" << std::setw(12) << "Count" << std::setw(12) << "p50 (ns)"
+              << std::setw(12) << "p99 (ns)" << std::setw(12) << "p99.9 (ns)" << "max (ns)\n";
+    for (size_t i = 0; i < static_cast<size_t>(Operation::Count); ++i)
+    {
+        Operation operation = static_cast<Operation>(i);
+        LatencySummary summary = summarizeLatency(operation);
+        std::cout << std::setw(15) << operationName(operation) << std::setw(12) << summary.count
+                  << std::setw(12) << summary.p50 << std::setw(12) << summary.p99
+                  << std::setw(12) << summary.p999 << summary.max << "\n";
+    }
+
+    std::cout << "\n";
+    writeLatencyReport(std::cout);
+    std::cout << std::endl;
+}
+
 /*
 Get the track title and artist name to remove from the hash table
 @return a pair containing the track title and artist name
@@ -316,16 +787,27 @@ Main function of the program
 */
 int main(int argc, char *argv[])
 {
-    std::cout << "New Audio Streaming service for linux using c++" << std::endl
-              << "Copyright (c) 2023, M00826933" << std::endl
-              << std::endl;
+    // Parse the command-line arguments and exit the program with an error message if incorrect
+    CommandLineOptions options;
+    if (!parseArguments(argc, argv, options))
+    {
+        return 1;
+    }
+
+    // In batch mode stdout only carries command results, so reports go to stderr
+    bool batchMode = !options.scriptFile.empty();
+    std::ostream &report = batchMode ? std::cerr : std::cout;
+    if (batchMode)
+    {
+        std::ios::sync_with_stdio(false);
+    }
 
-    // Check the number of command-line arguments and exit the program with an error message if incorrect
-    checkNumberOfArguments(argv[0], argc);
+    report << "New Audio Streaming service for linux using c++" << std::endl
+           << "Copyright (c) 2023, M00826933" << std::endl
+           << std::endl;
 
     // Load tracks from the specified file
-    std::string fileName = argv[1];
-    std::vector<Track> tracks = loadTracksFromFile(fileName);
+    std::vector<Track> tracks = loadTracksFromFile(options.catalogFile);
 
     // If the file is not found or is empty, exit the program
     if (tracks.size() == 0)
@@ -336,11 +818,73 @@ int main(int argc, char *argv[])
 
     // Create a hash table and insert the loaded tracks
     HashTable hashTable(tracks.size());
-    for (const auto &track : tracks)
+    hashTable.insertMany(tracks);
+    report << std::endl;
+
+    // Add the files to ingest before any removal so takedowns apply to them too
+    if (!options.ingestFiles.empty())
     {
-        hashTable.insert(track);
+        ingestTrackFiles(hashTable, options.ingestFiles, report);
+        report << std::endl;
+    }
+
+    // Apply a removal file given on the command line before running any command
+    if (!options.removalFile.empty())
+    {
+        removeTracksFromFile(hashTable, options.removalFile, report);
+        report << std::endl;
+    }
+
+    // Let other processes map the catalog read-only
+    if (!options.sharedName.empty())
+    {
+        uint64_t version = publishSharedCatalog(hashTable, options.sharedName);
+        if (version == 0)
+        {
+            return 1;
+        }
+        report << "Published " << hashTable.size() << " tracks as version " << version << " of " << options.sharedName << "." << std::endl
+               << std::endl;
+    }
+
+    // Write the catalog as a perfect hash image that read-only deployments map instead of loading
+    if (!options.frozenFile.empty())
+    {
+        if (!saveFrozenCatalog(hashTable, options.frozenFile))
+        {
+            return 1;
+        }
+        report << "Froze " << hashTable.size() << " tracks into " << options.frozenFile << "." << std::endl
+               << std::endl;
+    }
+
+    // Run the commands of the script, or of stdin, with no prompt
+    if (batchMode)
+    {
+        BatchSummary summary;
+        if (options.scriptFile == "-")
+        {
+            summary = runBatch(hashTable, std::cin, std::cout);
+        }
+        else
+        {
+            std::ifstream scriptFile(options.scriptFile);
+            if (!scriptFile)
+            {
+                std::cerr << "Error: could not open file " << options.scriptFile << std::endl;
+                return 1;
+            }
+            summary = runBatch(hashTable, scriptFile, std::cout);
+        }
+        std::cerr << "Ran " << summary.commands << " commands, " << summary.failures << " failed." << std::endl;
+        return summary.failures == 0 ? 0 : 2;
+    }
+
+    // Serve queries on the socket until interrupted
+    if (!options.socketPath.empty())
+    {
+        return serveLibrary(hashTable, options.socketPath) ? 0 : 1;
     }
-    std::cout << std::endl;
 
     // Wait for user input before clearing the screen and displaying the main menu
     drawPressAnyKeys();
@@ -5,7 +5,7 @@
 main.h
 Author: M00826933
 Created: 11/04/23
-Updated: 16/04/23
+Updated: 19/10/26
 */
 
 #include <iostream>
@@ -13,22 +13,66 @@ Updated: 16/04/23
 #include <sstream>
 #include <string>
 #include <vector>
+#include <memory>
+#include <mutex>
 #include "track.h"
 #include "hashTable.h"
+#include "trackColumns.h"
+#include "latencyHistogram.h"
+#include "trackIO.h"
+#include "batchMode.h"
+#include "libraryServer.h"
+#include "sharedCatalog.h"
+#include "frozenCatalog.h"
+#include "backgroundLoader.h"
+#include "fileIngest.h"
+
+// CommandLineOptions struct holds the options given on the command line
+struct CommandLineOptions
+{
+    std::string catalogFile;
+    std::string removalFile; // Empty when no --remove option is given
+    std::string scriptFile;  // Empty for the interactive menu, "-" for commands on stdin
+    std::string socketPath;  // Serve queries on this Unix socket instead of showing the menu
+    std::string sharedName;  // Publish the loaded catalog as this shared memory catalog
+    std::string frozenFile;  // Freeze the loaded catalog into this file for read-only deployments
+    std::vector<std::string> ingestFiles; // More track files loaded concurrently after the catalog
+};
 
 /*
-Check the number of arguments passed to the program
-@param programName the name of the program
+Parse the arguments passed to the program, printing the usage if they are invalid
 @param argc the number of command-line arguments
+@param argv the command-line arguments
+@param options the options to fill
+@return true if the arguments are valid, false otherwise
+*/
+bool parseArguments(int argc, char *argv[], CommandLineOptions &options);
+
+/*
+Remove every track listed in a removal file from the hash table and report the ones not found
+@param hashTable the HashTable object storing the tracks
+@param fileName the name of the file containing the tracks to remove
+@param output the stream to write the report to
+@return the number of tracks removed
 */
-void checkNumberOfArguments(std::string programName, int argc);
+size_t removeTracksFromFile(HashTable &hashTable, const std::string &fileName, std::ostream &output = std::cout);
 
 /*
-Load tracks from a file
-@param fileName the name of the file containing the tracks
-@return a vector of Track objects loaded from the file
+Ingest many track files concurrently and report how many tracks each added
+@param hashTable the HashTable object storing the tracks
+@param fileNames the names of the files to ingest
+@param output the stream to write the report to
+@return the number of tracks added
+*/
+size_t ingestTrackFiles(HashTable &hashTable, const std::vector<std::string> &fileNames, std::ostream &output = std::cout);
+
+/*
+Serve queries on a Unix socket until SIGINT or SIGTERM is received
+@param hashTable the HashTable object storing the tracks
+@param socketPath the path of the socket to listen on
+@return true if the server ran, false if it could not start
 */
-std::vector<Track> loadTracksFromFile(const std::string &fileName);
+bool serveLibrary(HashTable &hashTable, const std::string &socketPath);
 
 // Print a message to prompt the user to press any key to continue
 void drawPressAnyKeys();
@@ -38,24 +82,33 @@ void cleanScreen();
 
 /*
 Display the main menu and handle user inputs
+Tracks added from a file load in the background, so every use of the table holds tableMutex
 @param hashTable the HashTable object storing the tracks
 */
 void mainMenu(HashTable &hashTable);
 
 /*
-Add tracks from a file to the hash table
-@param hashTable the HashTable object storing the tracks
-@return true if successful, false otherwise
+Display one line about the running or last background load, nothing if there was none
+@param progress the progress of the load
+*/
+void showLoadProgress(const LoadProgress &progress);
+
+/*
+Start adding tracks from a file in the background, or offer to cancel the load already running
+@param loader the BackgroundLoader object adding tracks to the hash table
+@return true if a load was started or cancelled, false otherwise
 */
-bool addTracksFromFile(HashTable &hashTable);
+bool addTracksFromFile(BackgroundLoader &loader);
 
 /*
 Save tracks from the hash table to a file
 @param hashTable the HashTable object storing the tracks
 @param fileName the name of the file to save the tracks to
+@param tableMutex the mutex guarding the hash table, held while writing
+@param compression the compression of the file
 @return true if successful, false otherwise
 */
-bool saveTracksToFile(const HashTable &hashTable, const std::string &fileName);
+bool saveTracksToFile(const HashTable &hashTable, const std::string &fileName, std::mutex &tableMutex, Compression compression);
 
 /*
 Get the artist's name to search for their tracks
@@ -64,11 +117,60 @@ Get the artist's name to search for their tracks
 std::string getArtistToSearch();
 
 /*
-Search for tracks by an artist and display the results
+Search for tracks by an artist and display the results a page at a time, sorted by title or duration
 @param hashTable the HashTable object storing the tracks
 @param artist the artist's name to search for
+@param tableMutex the mutex guarding the hash table, held while reading each page but not while prompting
+*/
+void searchTracksByArtist(const HashTable &hashTable, const std::string &artist, std::mutex &tableMutex);
+
+/*
+Get the title words to search for and whether all of them must match
+@return a pair containing the title words and true if every word must match
+*/
+std::pair<std::string, bool> getTitleQueryToSearch();
+
+/*
+Search for tracks by words in their title and display the results
+@param hashTable the HashTable object storing the tracks
+@param query the title words to search for
+@param matchAllWords true if every word must match, false if any word may match
+*/
+void searchTracksByTitle(const HashTable &hashTable, const std::string &query, bool matchAllWords);
+
+/*
+Get the shortest and longest durations to search for
+@param minDuration set to the shortest duration in seconds
+@param maxDuration set to the longest duration in seconds
+@return true if both durations are valid numbers, false otherwise
+*/
+bool getDurationRangeToSearch(int &minDuration, int &maxDuration);
+
+/*
+Search for tracks within a duration range and display the results
+@param hashTable the HashTable object storing the tracks
+@param minDuration the shortest duration in seconds, inclusive
+@param maxDuration the longest duration in seconds, inclusive
+*/
+void searchTracksByDuration(const HashTable &hashTable, int minDuration, int maxDuration);
+
+/*
+Display duration aggregates, the most prolific artists and a duration histogram of the library
+@param hashTable the HashTable object storing the tracks
+@param cachedColumns the columnar copy of the table kept between calls, replaced once a track changed
+*/
+void showCatalogAnalytics(const HashTable &hashTable, std::unique_ptr<TrackColumns> &cachedColumns);
+
+/*
+Display the shape and the operation counters of the hash table, followed by the same data as JSON
+@param hashTable the HashTable object storing the tracks
+*/
+void showHashTableStatistics(const HashTable &hashTable);
+
+/*
+Display the latency percentiles of every library operation, followed by the same data as JSON
 */
-void searchTracksByArtist(const HashTable &hashTable, const std::string &artist);
+void showOperationLatencies();
 
 /*
 Get the track title and artist name to remove from the hash table
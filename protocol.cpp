@@ -0,0 +1,258 @@
+/*
+    protocol.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstring>
+#include "protocol.h"
+
+/*
+Append a fixed size value to a buffer
+@param buffer the buffer to append to
+@param value the value to append
+*/
+template <typename T>
+static void appendValue(std::string &buffer, T value)
+{
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+/*
+Append a length prefixed string to a buffer
+@param buffer the buffer to append to
+@param text the string to append, shorter than any frame so its length always fits
+*/
+static void appendString(std::string &buffer, const std::string &text)
+{
+    appendValue(buffer, static_cast<uint32_t>(text.size()));
+    buffer.append(text);
+}
+
+// FrameReader class reads the fields of a frame body, failing once a field runs past its end
+class FrameReader
+{
+private:
+    // Member datas
+    const char *position;
+    const char *end;
+    bool valid;
+
+public:
+    // Constructor
+    FrameReader(const char *data, size_t size) : position(data), end(data + size), valid(true) {}
+
+    template <typename T>
+    T readValue()
+    {
+        T value = T();
+        if (static_cast<size_t>(end - position) < sizeof(T))
+        {
+            valid = false;
+            return value;
+        }
+        std::memcpy(&value, position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    std::string readString()
+    {
+        uint32_t length = readValue<uint32_t>();
+        if (!valid || static_cast<size_t>(end - position) < length)
+        {
+            valid = false;
+            return std::string();
+        }
+        std::string text(position, length);
+        position += length;
+        return text;
+    }
+
+    // True while every field read so far was complete
+    bool good() const
+    {
+        return valid;
+    }
+
+    // True when every field was read and nothing is left over
+    bool finished() const
+    {
+        return valid && position == end;
+    }
+};
+
+/*
+Find the frame at the start of a buffer
+@param data the start of the buffer
+@param size the number of bytes in the buffer
+@param maxBodySize the largest frame body accepted
+@param bodySize the size of the frame body, set when Complete
+@return whether the frame was complete, incomplete or invalid
+*/
+static DecodeResult findFrame(const char *data, size_t size, uint32_t maxBodySize, uint32_t &bodySize)
+{
+    if (size < sizeof(uint32_t))
+    {
+        return DecodeResult::Incomplete;
+    }
+    std::memcpy(&bodySize, data, sizeof(uint32_t));
+    if (bodySize == 0 || bodySize > maxBodySize)
+    {
+        return DecodeResult::Invalid;
+    }
+    return size - sizeof(uint32_t) < bodySize ? DecodeResult::Incomplete : DecodeResult::Complete;
+}
+
+/*
+Write the body length of a frame once its body has been appended
+@param buffer the buffer holding the frame
+@param frameStart the offset of the frame in the buffer
+*/
+static void finishFrame(std::string &buffer, size_t frameStart)
+{
+    uint32_t bodySize = static_cast<uint32_t>(buffer.size() - frameStart - sizeof(uint32_t));
+    std::memcpy(&buffer[frameStart], &bodySize, sizeof(uint32_t));
+}
+
+/*
+Append an encoded request to a buffer
+@param request the request to encode
+@param buffer the buffer to append to
+*/
+void encodeRequest(const Request &request, std::string &buffer)
+{
+    size_t frameStart = buffer.size();
+    appendValue<uint32_t>(buffer, 0);
+    appendValue(buffer, static_cast<uint8_t>(request.opcode));
+    if (request.opcode == Opcode::Insert || request.opcode == Opcode::Remove)
+    {
+        appendString(buffer, request.title);
+    }
+    appendString(buffer, request.artist);
+    if (request.opcode == Opcode::Insert)
+    {
+        appendValue(buffer, request.duration);
+    }
+    finishFrame(buffer, frameStart);
+}
+
+/*
+Decode the request at the start of a buffer
+@param data the start of the buffer
+@param size the number of bytes in the buffer
+@param request the request to fill
+@param frameSize the number of bytes taken by the request, set when Complete
+@return whether the request was complete, incomplete or invalid
+*/
+DecodeResult decodeRequest(const char *data, size_t size, Request &request, size_t &frameSize)
+{
+    uint32_t bodySize;
+    DecodeResult result = findFrame(data, size, maxRequestSize, bodySize);
+    if (result != DecodeResult::Complete)
+    {
+        return result;
+    }
+    frameSize = sizeof(uint32_t) + bodySize;
+
+    FrameReader reader(data + sizeof(uint32_t), bodySize);
+    request.opcode = static_cast<Opcode>(reader.readValue<uint8_t>());
+    request.title.clear();
+    request.duration = 0;
+    switch (request.opcode)
+    {
+    case Opcode::Search:
+    case Opcode::Count:
+        request.artist = reader.readString();
+        break;
+    case Opcode::Insert:
+        request.title = reader.readString();
+        request.artist = reader.readString();
+        request.duration = reader.readValue<int32_t>();
+        break;
+    case Opcode::Remove:
+        request.title = reader.readString();
+        request.artist = reader.readString();
+        break;
+    default:
+        return DecodeResult::Invalid;
+    }
+    return reader.finished() ? DecodeResult::Complete : DecodeResult::Invalid;
+}
+
+/*
+Append an encoded response to a buffer
+@param status the outcome of the request
+@param count the number of tracks for Search and Count, ignored otherwise
+@param tracks the tracks found by Search, may be null otherwise
+@param buffer the buffer to append to, a response too large to decode is sent as TooLarge without tracks
+*/
+void encodeResponse(Status status, uint32_t count, const std::vector<Track> *tracks, std::string &buffer)
+{
+    // Measure the tracks first, so a frame the client would reject is never built
+    if (tracks)
+    {
+        uint64_t bodySize = sizeof(uint8_t) + sizeof(uint32_t);
+        for (const Track &track : *tracks)
+        {
+            bodySize += 2 * sizeof(uint32_t) + track.getTitle().size() + track.getArtist().size() + sizeof(int32_t);
+        }
+        if (bodySize > maxResponseSize)
+        {
+            status = Status::TooLarge;
+            tracks = nullptr;
+        }
+    }
+
+    size_t frameStart = buffer.size();
+    appendValue<uint32_t>(buffer, 0);
+    appendValue(buffer, static_cast<uint8_t>(status));
+    appendValue(buffer, count);
+    if (tracks)
+    {
+        for (const Track &track : *tracks)
+        {
+            appendString(buffer, track.getTitle());
+            appendString(buffer, track.getArtist());
+            appendValue<int32_t>(buffer, track.getDuration());
+        }
+    }
+    finishFrame(buffer, frameStart);
+}
+
+/*
+Decode the response at the start of a buffer
+@param data the start of the buffer
+@param size the number of bytes in the buffer
+@param response the response to fill
+@param frameSize the number of bytes taken by the response, set when Complete
+@return whether the response was complete, incomplete or invalid
+*/
+DecodeResult decodeResponse(const char *data, size_t size, Response &response, size_t &frameSize)
+{
+    uint32_t bodySize;
+    DecodeResult result = findFrame(data, size, maxResponseSize, bodySize);
+    if (result != DecodeResult::Complete)
+    {
+        return result;
+    }
+    frameSize = sizeof(uint32_t) + bodySize;
+
+    FrameReader reader(data + sizeof(uint32_t), bodySize);
+    response.status = static_cast<Status>(reader.readValue<uint8_t>());
+    response.count = reader.readValue<uint32_t>();
+    response.tracks.clear();
+    // Only Search responses carry tracks, so anything after the count is a track list
+    if (bodySize > sizeof(uint8_t) + sizeof(uint32_t))
+    {
+        for (uint32_t i = 0; i < response.count && reader.good(); ++i)
+        {
+            std::string title = reader.readString();
+            std::string artist = reader.readString();
+            int32_t duration = reader.readValue<int32_t>();
+            response.tracks.emplace_back(static_cast<int>(i + 1), title, artist, duration);
+        }
+    }
+    return reader.finished() ? DecodeResult::Complete : DecodeResult::Invalid;
+}
@@ -0,0 +1,110 @@
+#ifndef __PROTOCOL_H_
+#define __PROTOCOL_H_
+
+/*
+    protocol.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "track.h"
+
+/*
+Binary protocol of the query server, in host byte order since it only runs over a local socket
+Every frame is a 4 byte body length followed by the body, whose first byte is an opcode or a status
+Strings are a 4 byte length followed by their bytes, so a title of any length stored goes through unchanged, durations and counts are 4 bytes
+Requests on one connection may be pipelined, responses come back in the same order
+*/
+
+// Opcode enum lists the requests understood by the server
+enum class Opcode : uint8_t
+{
+    Search = 1, // artist -> tracks
+    Count = 2,  // artist -> number of tracks
+    Insert = 3, // title, artist, duration -> Ok, Duplicate or Refused
+    Remove = 4  // title, artist -> Ok or NotFound
+};
+
+// Status enum lists the outcomes of a request
+enum class Status : uint8_t
+{
+    Ok = 0,
+    NotFound = 1,
+    Duplicate = 2,
+    BadRequest = 3,
+    Refused = 4, // The library cannot store the track
+    TooLarge = 5 // The tracks found do not fit in maxResponseSize, only their number is sent
+};
+
+// Larger frames are rejected so a broken peer cannot exhaust memory, responses may list a whole artist
+const uint32_t maxRequestSize = 1 << 20;
+const uint32_t maxResponseSize = 1 << 30;
+
+// Request struct holds a decoded request, unused fields stay empty
+struct Request
+{
+    Opcode opcode;
+    std::string title;
+    std::string artist;
+    int32_t duration;
+};
+
+// Response struct holds a decoded response, tracks are only filled for Search
+struct Response
+{
+    Status status;
+    uint32_t count;
+    std::vector<Track> tracks;
+};
+
+// DecodeResult enum tells whether a buffer started with a complete frame
+enum class DecodeResult
+{
+    Complete,
+    Incomplete,
+    Invalid
+};
+
+/*
+Append an encoded request to a buffer
+@param request the request to encode
+@param buffer the buffer to append to
+*/
+void encodeRequest(const Request &request, std::string &buffer);
+
+/*
+Decode the request at the start of a buffer
+@param data the start of the buffer
+@param size the number of bytes in the buffer
+@param request the request to fill
+@param frameSize the number of bytes taken by the request, set when Complete
+@return whether the request was complete, incomplete or invalid
+*/
+DecodeResult decodeRequest(const char *data, size_t size, Request &request, size_t &frameSize);
+
+/*
+Append an encoded response to a buffer
+@param status the outcome of the request
+@param count the number of tracks for Search and Count, ignored otherwise
+@param tracks the tracks found by Search, may be null otherwise
+@param buffer the buffer to append to, a response too large to decode is sent as TooLarge without tracks
+*/
+void encodeResponse(Status status, uint32_t count, const std::vector<Track> *tracks, std::string &buffer);
+
+/*
+Decode the response at the start of a buffer
+@param data the start of the buffer
+@param size the number of bytes in the buffer
+@param response the response to fill
+@param frameSize the number of bytes taken by the response, set when Complete
+@return whether the response was complete, incomplete or invalid
+*/
+DecodeResult decodeResponse(const char *data, size_t size, Response &response, size_t &frameSize);
+
+#endif
@@ -0,0 +1,197 @@
+/*
+    searchCache.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <functional>
+
+#include "searchCache.h"
+
+/*
+Constructor
+@param capacity the number of tracks the cached results may hold in total, 0 to cache nothing
+*/
+SearchCache::SearchCache(size_t capacity)
+    : shards(new CacheShard[shardCount]), shardCapacity(0), entryCount(0)
+{
+    setCapacity(capacity);
+}
+
+/*
+Find the shard of a key
+@param key the folded artist name
+@return the shard holding the key if it is cached
+*/
+SearchCache::CacheShard &SearchCache::shardOf(const std::string &key) const
+{
+    return shards[std::hash<std::string>()(key) % shardCount];
+}
+
+/*
+Take an entry out of its shard, moving the last entry in its place
+@param shard the shard holding the entry, locked by the caller
+@param position the index of the entry
+*/
+void SearchCache::removeEntry(CacheShard &shard, size_t position)
+{
+    shard.trackCount -= shard.entries[position].result->size();
+    shard.positions.erase(shard.entries[position].key);
+    if (position + 1 != shard.entries.size())
+    {
+        shard.entries[position] = std::move(shard.entries.back());
+        shard.positions[shard.entries[position].key] = position;
+    }
+    shard.entries.pop_back();
+    if (shard.hand >= shard.entries.size())
+    {
+        shard.hand = 0;
+    }
+    entryCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/*
+Find the cached result of a key, marking it as recently used
+@param key the folded artist name
+@return the cached result, or null if there is none
+*/
+std::shared_ptr<const std::vector<Track>> SearchCache::find(const std::string &key)
+{
+    CacheShard &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::unordered_map<std::string, size_t>::iterator found = shard.positions.find(key);
+    if (found == shard.positions.end())
+    {
+        misses.add();
+        return nullptr;
+    }
+    hits.add();
+    CacheEntry &entry = shard.entries[found->second];
+    entry.referenced = true;
+    return entry.result;
+}
+
+/*
+Cache the result of a key, evicting results not used since the hand last passed them if the shard is full
+Results larger than a shard are not cached
+@param key the folded artist name
+@param result the tracks found for the key
+*/
+void SearchCache::store(const std::string &key, const std::shared_ptr<const std::vector<Track>> &result)
+{
+    if (result->size() > shardCapacity)
+    {
+        return;
+    }
+    CacheShard &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Another search may have stored the key meanwhile, the newer result replaces it
+    std::unordered_map<std::string, size_t>::iterator found = shard.positions.find(key);
+    if (found != shard.positions.end())
+    {
+        removeEntry(shard, found->second);
+    }
+
+    // Sweep the hand, giving every referenced result a second chance before evicting it
+    while (shard.trackCount + result->size() > shardCapacity)
+    {
+        CacheEntry &entry = shard.entries[shard.hand];
+        if (entry.referenced)
+        {
+            entry.referenced = false;
+            shard.hand = (shard.hand + 1) % shard.entries.size();
+        }
+        else
+        {
+            removeEntry(shard, shard.hand);
+            evictions.add();
+        }
+    }
+
+    shard.positions.emplace(key, shard.entries.size());
+    shard.entries.push_back(CacheEntry{key, result, false});
+    shard.trackCount += result->size();
+    entryCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*
+Drop the cached result of a key, if any
+@param key the folded artist name whose tracks changed
+*/
+void SearchCache::invalidate(const std::string &key)
+{
+    CacheShard &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::unordered_map<std::string, size_t>::iterator found = shard.positions.find(key);
+    if (found != shard.positions.end())
+    {
+        removeEntry(shard, found->second);
+        invalidations.add();
+    }
+}
+
+/*
+Drop every cached result
+*/
+void SearchCache::clear()
+{
+    for (size_t i = 0; i < shardCount; ++i)
+    {
+        CacheShard &shard = shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        entryCount.fetch_sub(shard.entries.size(), std::memory_order_relaxed);
+        shard.positions.clear();
+        shard.entries.clear();
+        shard.hand = 0;
+        shard.trackCount = 0;
+    }
+}
+
+/*
+Change the number of tracks the cached results may hold, dropping every cached result
+@param capacity the number of tracks in total, 0 to cache nothing
+*/
+void SearchCache::setCapacity(size_t capacity)
+{
+    clear();
+    shardCapacity = (capacity + shardCount - 1) / shardCount;
+}
+
+/*
+Check whether results are cached at all
+@return true if the capacity is not 0, false otherwise
+*/
+bool SearchCache::isEnabled() const
+{
+    return shardCapacity > 0;
+}
+
+/*
+Check whether no result is cached, so that invalidating can be skipped
+@return true if no result is cached, false otherwise
+*/
+bool SearchCache::isEmpty() const
+{
+    return entryCount.load(std::memory_order_relaxed) == 0;
+}
+
+/*
+Add the counters and the size of the cache to the statistics of a hash table
+@param stats the statistics to fill
+*/
+void SearchCache::fillStats(HashTableStats &stats) const
+{
+    stats.cacheHits = hits.load();
+    stats.cacheMisses = misses.load();
+    stats.cacheInvalidations = invalidations.load();
+    stats.cacheEvictions = evictions.load();
+    stats.cachedResults = entryCount.load(std::memory_order_relaxed);
+    stats.cachedTracks = 0;
+    for (size_t i = 0; i < shardCount; ++i)
+    {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        stats.cachedTracks += shards[i].trackCount;
+    }
+}
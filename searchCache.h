@@ -0,0 +1,127 @@
+#ifndef __SEARCHCACHE_H_
+#define __SEARCHCACHE_H_
+
+/*
+    searchCache.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "track.h"
+#include "hashTableStats.h"
+
+// SearchCache class definition, a bounded cache of search results by artist key with CLOCK eviction
+// Keys are spread over shards that each have their own lock, so concurrent searches seldom wait on each other
+// Results are shared, an evicted or invalidated result stays alive for the searches still holding it
+// Storing and invalidating may run alongside finding, the owner invalidates a key whenever the tracks of its artist change
+class SearchCache
+{
+private:
+    // CacheEntry struct is one cached result and its CLOCK reference bit
+    struct CacheEntry
+    {
+        std::string key;
+        std::shared_ptr<const std::vector<Track>> result;
+        bool referenced;
+    };
+
+    // CacheShard struct holds the entries of the keys hashed to it and the hand sweeping them
+    struct CacheShard
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, size_t> positions; // Index in entries by key
+        std::vector<CacheEntry> entries;
+        size_t hand = 0;
+        size_t trackCount = 0; // Tracks held by the results of the shard
+    };
+
+    // Member datas
+    std::unique_ptr<CacheShard[]> shards;
+    size_t shardCapacity;                // Tracks each shard may hold
+    std::atomic<size_t> entryCount;      // Results cached over every shard
+    StatCounter hits;
+    StatCounter misses;
+    StatCounter invalidations; // Results dropped because the tracks of their artist changed
+    StatCounter evictions;     // Results dropped to make room
+
+    // Method to find the shard of a key
+    CacheShard &shardOf(const std::string &key) const;
+    // Method to take an entry out of its shard, moving the last entry in its place
+    void removeEntry(CacheShard &shard, size_t position);
+
+public:
+    static constexpr size_t shardCount = 16;
+    static constexpr size_t defaultCapacity = 1 << 16;
+
+    /*
+    Constructor
+    @param capacity the number of tracks the cached results may hold in total, 0 to cache nothing
+    */
+    SearchCache(size_t capacity = defaultCapacity);
+
+    SearchCache(const SearchCache &) = delete;
+    SearchCache &operator=(const SearchCache &) = delete;
+
+    /*
+    Find the cached result of a key, marking it as recently used
+    @param key the folded artist name
+    @return the cached result, or null if there is none
+    */
+    std::shared_ptr<const std::vector<Track>> find(const std::string &key);
+
+    /*
+    Cache the result of a key, evicting results not used since the hand last passed them if the shard is full
+    Results larger than a shard are not cached
+    @param key the folded artist name
+    @param result the tracks found for the key
+    */
+    void store(const std::string &key, const std::shared_ptr<const std::vector<Track>> &result);
+
+    /*
+    Drop the cached result of a key, if any
+    @param key the folded artist name whose tracks changed
+    */
+    void invalidate(const std::string &key);
+
+    /*
+    Drop every cached result
+    */
+    void clear();
+
+    /*
+    Change the number of tracks the cached results may hold, dropping every cached result
+    Not safe to call while other threads use the cache
+    @param capacity the number of tracks in total, 0 to cache nothing
+    */
+    void setCapacity(size_t capacity);
+
+    /*
+    Check whether results are cached at all
+    @return true if the capacity is not 0, false otherwise
+    */
+    bool isEnabled() const;
+
+    /*
+    Check whether no result is cached, so that invalidating can be skipped
+    @return true if no result is cached, false otherwise
+    */
+    bool isEmpty() const;
+
+    /*
+    Add the counters and the size of the cache to the statistics of a hash table
+    @param stats the statistics to fill
+    */
+    void fillStats(HashTableStats &stats) const;
+};
+
+#endif
@@ -0,0 +1,429 @@
+/*
+    sharedCatalog.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sharedCatalog.h"
+#include "catalogImage.h"
+
+// "MUSICCAT" in little endian, followed by the layout version
+static const uint64_t catalogMagic = 0x544143434953554DULL;
+static const uint32_t catalogFormatVersion = 2;
+
+// Buckets and records are numbered with 32 bits, and the bucket count is the next power of two above the track count
+static const uint64_t maxCatalogTracks = 1ULL << 31;
+
+// The version word is shared between processes, so it must not fall back to a lock
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the version word needs lock-free 64 bit atomics");
+
+/*
+Build the image of every track of a hash table
+@param hashTable the HashTable object storing the tracks
+@return the bytes of the image, empty if the catalog is too large to be numbered with 32 bits
+*/
+std::string buildCatalogImage(const HashTable &hashTable)
+{
+    std::vector<Track> tracks = hashTable.getAllTracks();
+    if (tracks.size() > maxCatalogTracks)
+    {
+        std::cerr << "Error: " << tracks.size() << " tracks are more than a catalog image holds (" << maxCatalogTracks << ")." << std::endl;
+        return std::string();
+    }
+
+    // One bucket per track, rounded to a power of two, keeps chains short
+    uint32_t bucketCount = 1;
+    while (bucketCount < tracks.size())
+    {
+        bucketCount <<= 1;
+    }
+
+    // Counting sort of the tracks by bucket, which keeps the tracks of an artist in order
+    std::vector<uint32_t> trackBuckets(tracks.size());
+    std::vector<uint32_t> bucketStarts(bucketCount + 1, 0);
+    uint64_t stringBytes = 0;
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        const std::string &artist = tracks[i].getArtist();
+        if (artist.size() > UINT32_MAX)
+        {
+            std::cerr << "Error: Artist name of " << artist.size() << " bytes is longer than a catalog record holds." << std::endl;
+            return std::string();
+        }
+        trackBuckets[i] = static_cast<uint32_t>(catalogArtistHash(artist.data(), artist.size(), 0) % bucketCount);
+        bucketStarts[trackBuckets[i] + 1]++;
+        stringBytes += tracks[i].getTitle().size() + artist.size();
+    }
+    for (uint32_t bucket = 0; bucket < bucketCount; ++bucket)
+    {
+        bucketStarts[bucket + 1] += bucketStarts[bucket];
+    }
+
+    SharedCatalogHeader header = {};
+    header.magic = catalogMagic;
+    header.formatVersion = catalogFormatVersion;
+    header.bucketCount = bucketCount;
+    header.trackCount = tracks.size();
+    header.bucketsOffset = alignOffset(sizeof(SharedCatalogHeader));
+    header.recordsOffset = alignOffset(header.bucketsOffset + bucketStarts.size() * sizeof(uint32_t));
+    header.stringsOffset = header.recordsOffset + tracks.size() * sizeof(SharedTrackRecord);
+    header.imageSize = header.stringsOffset + stringBytes;
+
+    std::string image(header.imageSize, '\0');
+    std::memcpy(&image[0], &header, sizeof(header));
+    std::memcpy(&image[header.bucketsOffset], bucketStarts.data(), bucketStarts.size() * sizeof(uint32_t));
+
+    std::vector<uint32_t> nextSlot(bucketStarts.begin(), bucketStarts.end() - 1);
+    uint64_t stringOffset = 0;
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        const Track &track = tracks[i];
+        SharedTrackRecord record;
+        record.lineNumber = track.getLineNumber();
+        record.duration = track.getDuration();
+        record.titleOffset = stringOffset;
+        record.titleLength = static_cast<uint32_t>(track.getTitle().size());
+        std::memcpy(&image[header.stringsOffset + stringOffset], track.getTitle().data(), record.titleLength);
+        stringOffset += record.titleLength;
+        record.artistOffset = stringOffset;
+        record.artistLength = static_cast<uint32_t>(track.getArtist().size());
+        std::memcpy(&image[header.stringsOffset + stringOffset], track.getArtist().data(), record.artistLength);
+        stringOffset += record.artistLength;
+
+        uint32_t slot = nextSlot[trackBuckets[i]]++;
+        std::memcpy(&image[header.recordsOffset + slot * sizeof(SharedTrackRecord)], &record, sizeof(record));
+    }
+    return image;
+}
+
+/*
+Check an image and view it, the view is invalid if the image is truncated or not an image
+@param image the start of the image
+@param size the number of bytes available
+*/
+SharedCatalogView::SharedCatalogView(const char *image, size_t size)
+    : image(image), header(nullptr), bucketStarts(nullptr), records(nullptr), strings(nullptr)
+{
+    if (!image || size < sizeof(SharedCatalogHeader))
+    {
+        return;
+    }
+    const SharedCatalogHeader *candidate = reinterpret_cast<const SharedCatalogHeader *>(image);
+    if (candidate->magic != catalogMagic || candidate->formatVersion != catalogFormatVersion ||
+        candidate->imageSize > size || candidate->bucketCount == 0 ||
+        candidate->bucketsOffset + (candidate->bucketCount + 1ULL) * sizeof(uint32_t) > candidate->recordsOffset ||
+        candidate->recordsOffset + candidate->trackCount * sizeof(SharedTrackRecord) > candidate->stringsOffset ||
+        candidate->stringsOffset > candidate->imageSize)
+    {
+        return;
+    }
+
+    header = candidate;
+    bucketStarts = reinterpret_cast<const uint32_t *>(image + header->bucketsOffset);
+    records = reinterpret_cast<const SharedTrackRecord *>(image + header->recordsOffset);
+    strings = image + header->stringsOffset;
+}
+
+/*
+Check whether the image was accepted
+@return true if the image can be searched, false otherwise
+*/
+bool SharedCatalogView::isValid() const
+{
+    return header != nullptr;
+}
+
+/*
+Get the number of tracks in the image
+@return the number of tracks
+*/
+size_t SharedCatalogView::size() const
+{
+    return header ? header->trackCount : 0;
+}
+
+/*
+Search for tracks by artist in the image, ignoring case
+@param artist the artist name to search for
+@return a vector of Track objects that match the given artist
+*/
+std::vector<Track> SharedCatalogView::search(const std::string &artist) const
+{
+    std::vector<Track> result;
+    if (!header)
+    {
+        return result;
+    }
+
+    uint64_t stringBytes = header->imageSize - header->stringsOffset;
+    uint32_t bucket = static_cast<uint32_t>(catalogArtistHash(artist.data(), artist.size(), 0) % header->bucketCount);
+    uint32_t end = std::min<uint64_t>(bucketStarts[bucket + 1], header->trackCount);
+    for (uint32_t i = bucketStarts[bucket]; i < end; ++i)
+    {
+        const SharedTrackRecord &record = records[i];
+        if (record.artistLength != artist.size() || record.artistOffset + record.artistLength > stringBytes ||
+            record.titleOffset + record.titleLength > stringBytes)
+        {
+            continue;
+        }
+
+        const char *recordArtist = strings + record.artistOffset;
+        bool sameArtist = true;
+        for (size_t j = 0; j < artist.size() && sameArtist; ++j)
+        {
+            sameArtist = tolower(static_cast<unsigned char>(recordArtist[j])) == tolower(static_cast<unsigned char>(artist[j]));
+        }
+        if (sameArtist)
+        {
+            result.emplace_back(record.lineNumber, std::string(strings + record.titleOffset, record.titleLength),
+                                std::string(recordArtist, record.artistLength), record.duration);
+        }
+    }
+    return result;
+}
+
+/*
+Map the version word of a shared catalog, creating it when publishing
+@param name the name of the shared catalog
+@param writable true to create the version word and map it for writing
+@return the mapping of the version word, or null on failure
+*/
+static void *mapVersionWord(const std::string &name, bool writable)
+{
+    int fd = shm_open(name.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    // A new object is zero filled, which reads as version 0, nothing published
+    if (writable && ftruncate(fd, sizeof(std::atomic<uint64_t>)) < 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+    void *mapping = mmap(nullptr, sizeof(std::atomic<uint64_t>), writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return mapping == MAP_FAILED ? nullptr : mapping;
+}
+
+/*
+Wait until no other process is publishing a catalog, then keep them waiting
+Publishers hold an exclusive lock on the version word object, released when the descriptor is closed or the process dies
+@param name the name of the shared catalog
+@return the locked descriptor to close once published, or -1 on failure
+*/
+static int lockPublishers(const std::string &name)
+{
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    while (flock(fd, LOCK_EX) < 0)
+    {
+        if (errno != EINTR)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+/*
+Get the name of the shared memory object holding one version of a catalog
+@param name the name of the shared catalog
+@param version the version
+@return the name of the shared memory object
+*/
+static std::string imageName(const std::string &name, uint64_t version)
+{
+    return name + "." + std::to_string(version);
+}
+
+/*
+Publish the tracks of a hash table as a new version of a named shared catalog
+@param hashTable the HashTable object storing the tracks
+@param name the name of the shared catalog, starting with a slash
+@return the published version, or 0 on failure
+*/
+uint64_t publishSharedCatalog(const HashTable &hashTable, const std::string &name)
+{
+    // Publishers take turns, so two of them never claim the same version or remove each other's image
+    int lockFd = lockPublishers(name);
+    void *control = lockFd < 0 ? nullptr : mapVersionWord(name, true);
+    if (!control)
+    {
+        std::cerr << "Error: could not open shared catalog " << name << ": " << std::strerror(errno) << std::endl;
+        if (lockFd >= 0)
+        {
+            close(lockFd);
+        }
+        return 0;
+    }
+    std::atomic<uint64_t> &versionWord = *static_cast<std::atomic<uint64_t> *>(control);
+    uint64_t oldVersion = versionWord.load(std::memory_order_acquire);
+    uint64_t newVersion = oldVersion + 1;
+
+    // Write the whole image before any reader can learn its name through the version word
+    std::string image = buildCatalogImage(hashTable);
+    if (image.empty())
+    {
+        munmap(control, sizeof(std::atomic<uint64_t>));
+        close(lockFd);
+        return 0;
+    }
+    std::string newName = imageName(name, newVersion);
+    shm_unlink(newName.c_str()); // Left behind by a publisher that died before swapping, no other one is running
+    int fd = shm_open(newName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0444);
+    bool written = fd >= 0 && ftruncate(fd, image.size()) == 0;
+    if (written)
+    {
+        void *mapping = mmap(nullptr, image.size(), PROT_WRITE, MAP_SHARED, fd, 0);
+        written = mapping != MAP_FAILED;
+        if (written)
+        {
+            std::memcpy(mapping, image.data(), image.size());
+            munmap(mapping, image.size());
+        }
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    if (!written)
+    {
+        std::cerr << "Error: could not write shared catalog " << newName << ": " << std::strerror(errno) << std::endl;
+        shm_unlink(newName.c_str());
+        munmap(control, sizeof(std::atomic<uint64_t>));
+        close(lockFd);
+        return 0;
+    }
+
+    versionWord.store(newVersion, std::memory_order_release);
+    munmap(control, sizeof(std::atomic<uint64_t>));
+
+    // Readers still mapping the old version keep it alive, new readers can no longer open it
+    if (oldVersion != 0)
+    {
+        shm_unlink(imageName(name, oldVersion).c_str());
+    }
+    close(lockFd);
+    return newVersion;
+}
+
+// Constructor
+SharedCatalogReader::SharedCatalogReader(const std::string &name)
+    : name(name), control(nullptr), image(nullptr), imageSize(0), version(0) {}
+
+// Destructor
+SharedCatalogReader::~SharedCatalogReader()
+{
+    unmapImage();
+    if (control)
+    {
+        munmap(const_cast<void *>(control), sizeof(std::atomic<uint64_t>));
+    }
+}
+
+/*
+Unmap the current image
+*/
+void SharedCatalogReader::unmapImage()
+{
+    if (image)
+    {
+        munmap(const_cast<char *>(image), imageSize);
+        image = nullptr;
+        imageSize = 0;
+        version = 0;
+    }
+}
+
+/*
+Map the latest published version if it changed since the last call
+@return true if a valid version is mapped, false otherwise
+*/
+bool SharedCatalogReader::refresh()
+{
+    if (!control)
+    {
+        control = mapVersionWord(name, false);
+        if (!control)
+        {
+            return false;
+        }
+    }
+    const std::atomic<uint64_t> &versionWord = *static_cast<const std::atomic<uint64_t> *>(control);
+
+    // A version superseded between reading the word and opening it is gone, so read the word again
+    for (int attempt = 0; attempt < 3; ++attempt)
+    {
+        uint64_t latestVersion = versionWord.load(std::memory_order_acquire);
+        if (latestVersion == 0 || latestVersion == version)
+        {
+            return image != nullptr;
+        }
+
+        int fd = shm_open(imageName(name, latestVersion).c_str(), O_RDONLY, 0);
+        if (fd < 0)
+        {
+            continue;
+        }
+        struct stat status;
+        void *mapping = MAP_FAILED;
+        if (fstat(fd, &status) == 0 && status.st_size > 0)
+        {
+            mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            continue;
+        }
+        if (!SharedCatalogView(static_cast<const char *>(mapping), status.st_size).isValid())
+        {
+            munmap(mapping, status.st_size);
+            std::cerr << "Error: shared catalog " << imageName(name, latestVersion) << " is not a valid catalog image" << std::endl;
+            return image != nullptr;
+        }
+
+        unmapImage();
+        image = static_cast<const char *>(mapping);
+        imageSize = status.st_size;
+        version = latestVersion;
+        return true;
+    }
+    return image != nullptr;
+}
+
+/*
+Get the version currently mapped
+@return the version, or 0 if none is mapped
+*/
+uint64_t SharedCatalogReader::getVersion() const
+{
+    return version;
+}
+
+/*
+View the image currently mapped, only valid until the next refresh
+@return a view of the image
+*/
+SharedCatalogView SharedCatalogReader::view() const
+{
+    return SharedCatalogView(image, imageSize);
+}
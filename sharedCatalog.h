@@ -0,0 +1,151 @@
+#ifndef __SHAREDCATALOG_H_
+#define __SHAREDCATALOG_H_
+
+/*
+    sharedCatalog.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "track.h"
+#include "hashTable.h"
+
+/*
+Read-only catalog image that can be mapped at any address by many processes
+Every reference inside the image is an offset from its start, never a pointer:
+    header | bucket starts (bucketCount + 1 record indexes) | records grouped by bucket | string bytes
+Tracks of one artist share a bucket and keep their insertion order
+*/
+
+// SharedCatalogHeader struct is the start of an image
+struct SharedCatalogHeader
+{
+    uint64_t magic;
+    uint32_t formatVersion;
+    uint32_t bucketCount;
+    uint64_t trackCount;
+    uint64_t imageSize;
+    uint64_t bucketsOffset;
+    uint64_t recordsOffset;
+    uint64_t stringsOffset;
+};
+
+// SharedTrackRecord struct is one track of an image, its strings live in the string bytes
+struct SharedTrackRecord
+{
+    int32_t lineNumber;
+    int32_t duration;
+    uint64_t titleOffset; // From the start of the string bytes
+    uint64_t artistOffset;
+    uint32_t titleLength;
+    uint32_t artistLength;
+};
+
+/*
+Build the image of every track of a hash table
+@param hashTable the HashTable object storing the tracks
+@return the bytes of the image, empty if the catalog is too large to be numbered with 32 bits
+*/
+std::string buildCatalogImage(const HashTable &hashTable);
+
+// SharedCatalogView class definition, searches an image in place without copying it
+class SharedCatalogView
+{
+private:
+    // Member datas
+    const char *image;
+    const SharedCatalogHeader *header;
+    const uint32_t *bucketStarts;
+    const SharedTrackRecord *records;
+    const char *strings;
+
+public:
+    /*
+    Check an image and view it, the view is invalid if the image is truncated or not an image
+    @param image the start of the image
+    @param size the number of bytes available
+    */
+    SharedCatalogView(const char *image, size_t size);
+
+    /*
+    Check whether the image was accepted
+    @return true if the image can be searched, false otherwise
+    */
+    bool isValid() const;
+
+    /*
+    Get the number of tracks in the image
+    @return the number of tracks
+    */
+    size_t size() const;
+
+    /*
+    Search for tracks by artist in the image, ignoring case
+    @param artist the artist name to search for
+    @return a vector of Track objects that match the given artist
+    */
+    std::vector<Track> search(const std::string &artist) const;
+};
+
+/*
+Publish the tracks of a hash table as a new version of a named shared catalog
+The image goes to the shared memory object <name>.<version>, then the version word in <name> is swapped
+Readers that already mapped the previous version keep it until they refresh
+@param hashTable the HashTable object storing the tracks
+@param name the name of the shared catalog, starting with a slash
+@return the published version, or 0 on failure
+*/
+uint64_t publishSharedCatalog(const HashTable &hashTable, const std::string &name);
+
+// SharedCatalogReader class definition, maps the latest published version of a shared catalog read-only
+class SharedCatalogReader
+{
+private:
+    // Member datas
+    std::string name;
+    const void *control; // Mapping of the version word
+    const char *image;
+    size_t imageSize;
+    uint64_t version;
+
+    /*
+    Unmap the current image
+    */
+    void unmapImage();
+
+public:
+    // Constructor
+    SharedCatalogReader(const std::string &name);
+
+    // Destructor
+    ~SharedCatalogReader();
+
+    SharedCatalogReader(const SharedCatalogReader &) = delete;
+    SharedCatalogReader &operator=(const SharedCatalogReader &) = delete;
+
+    /*
+    Map the latest published version if it changed since the last call
+    @return true if a valid version is mapped, false otherwise
+    */
+    bool refresh();
+
+    /*
+    Get the version currently mapped
+    @return the version, or 0 if none is mapped
+    */
+    uint64_t getVersion() const;
+
+    /*
+    View the image currently mapped, only valid until the next refresh
+    @return a view of the image
+    */
+    SharedCatalogView view() const;
+};
+
+#endif
@@ -12,6 +12,20 @@
 #include "track.h"
 #include "hashTable.h"
 #include "main.h"
+#include "trackColumns.h"
+#include "catalogGenerator.h"
+#include "latencyHistogram.h"
+#include "lineReader.h"
+#include "blockCompressor.h"
+#include "artistDictionary.h"
+#include "ioUring.h"
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <zlib.h>
 
 TEST_CASE("Track and HashTable class functionality", "[Track][HashTable]")
 {
@@ -253,3 +267,1368 @@ TEST_CASE("HashTable class: Test Insert track with empty artist or title")
     REQUIRE(foundTracks2.size() == 1);
     REQUIRE(foundTracks2[0].getArtist() == "Artist2");
 }
+
+TEST_CASE("HashTable class: Test Search by title words")
+{
+    HashTable hashTable(10);
+    hashTable.insert(Track(1, "Love Will Tear Us Apart", "Joy Division", 204));
+    hashTable.insert(Track(2, "Let's Stay Together", "Al Green", 199));
+    hashTable.insert(Track(3, "Love and Happiness", "Al Green", 302));
+
+    // Words are matched case insensitively and ignoring punctuation
+    std::vector<Track> allWords = hashTable.searchByTitle("love APART", true);
+    REQUIRE(allWords.size() == 1);
+    REQUIRE(allWords[0].getTitle() == "Love Will Tear Us Apart");
+
+    std::vector<Track> anyWord = hashTable.searchByTitle("together happiness", false);
+    REQUIRE(anyWord.size() == 2);
+
+    REQUIRE(hashTable.searchByTitle("love missing", true).empty());
+
+    // Removed tracks disappear from the title index
+    REQUIRE(hashTable.remove("Love and Happiness", "Al Green"));
+    REQUIRE(hashTable.searchByTitle("love", true).size() == 1);
+}
+
+TEST_CASE("TitleIndex: Test removals sharing a common word")
+{
+    TitleIndex titleIndex;
+    for (uint32_t id = 0; id < 10; ++id)
+    {
+        titleIndex.add(id, "Love Song " + std::to_string(id));
+    }
+
+    // Removed ids disappear from results before and after their lists are rebuilt
+    for (uint32_t id = 0; id < 7; ++id)
+    {
+        titleIndex.remove(id, "Love Song " + std::to_string(id));
+        REQUIRE(titleIndex.find("love song", true).size() == 9 - id);
+    }
+    REQUIRE(titleIndex.find("love 8", true) == std::vector<uint32_t>{8});
+    REQUIRE(titleIndex.find("3 9", false) == std::vector<uint32_t>{9});
+
+    // A repeated word, a second removal and an id never indexed leave the other ids alone
+    titleIndex.add(20, "Love Love Love");
+    titleIndex.add(21, "Love Me");
+    titleIndex.remove(20, "Love Love Love");
+    titleIndex.remove(20, "Love Love Love");
+    titleIndex.remove(30, "Love");
+    REQUIRE(titleIndex.find("love", true) == std::vector<uint32_t>{7, 8, 9, 21});
+}
+
+TEST_CASE("TitleIndex: Test posting lists and sorted intersection")
+{
+    PostingList list;
+    list.append(3);
+    list.append(300);
+    list.append(70000);
+    list.append(70000); // Repeated id is stored once
+    REQUIRE(list.size() == 3);
+    REQUIRE(list.decode() == std::vector<uint32_t>{3, 300, 70000});
+
+    std::vector<uint32_t> evens, multiplesOfThree, expected;
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            evens.push_back(i);
+        }
+        if (i % 3 == 0)
+        {
+            multiplesOfThree.push_back(i);
+        }
+        if (i % 6 == 0)
+        {
+            expected.push_back(i);
+        }
+    }
+    REQUIRE(intersectSorted(evens, multiplesOfThree) == expected);
+    REQUIRE(intersectSorted(std::vector<uint32_t>{6, 600}, evens) == std::vector<uint32_t>{6, 600});
+    REQUIRE(unionSorted(std::vector<uint32_t>{1, 4}, std::vector<uint32_t>{2, 4}) == std::vector<uint32_t>{1, 2, 4});
+}
+
+TEST_CASE("HashTable class: Test Find similar artists")
+{
+    HashTable hashTable(10);
+    hashTable.insert(Track(1, "Decades", "Joy Division", 374));
+    hashTable.insert(Track(2, "Lets Stay Together", "Al Green", 199));
+    hashTable.insert(Track(3, "Victims Of The Revolution", "Bad Religion", 197));
+
+    // One substitution and one deletion away from "Joy Division"
+    std::vector<ArtistMatch> matches = hashTable.findSimilarArtists("joy divisoin", 2);
+    REQUIRE(matches.size() == 1);
+    REQUIRE(matches[0].artist == "Joy Division");
+    REQUIRE(matches[0].distance == 2);
+
+    REQUIRE(hashTable.findSimilarArtists("Al Gren", 2)[0].distance == 1);
+    REQUIRE(hashTable.findSimilarArtists("Metallica", 2).empty());
+
+    // Artists without any remaining track are no longer suggested
+    REQUIRE(hashTable.remove("Lets Stay Together", "Al Green"));
+    REQUIRE(hashTable.findSimilarArtists("Al Gren", 2).empty());
+}
+
+TEST_CASE("HashTable class: Test Search by duration range")
+{
+    HashTable hashTable(10);
+    hashTable.insert(Track(1, "Title1", "Artist1", 120));
+    hashTable.insert(Track(2, "Title2", "Artist2", 240));
+    hashTable.insert(Track(3, "Title3", "Artist1", 180));
+    hashTable.insert(Track(4, "Title4", "Artist3", 300));
+
+    REQUIRE(hashTable.countByDuration(180, 240) == 2);
+    std::vector<Track> foundTracks = hashTable.searchByDuration(150, 400);
+    REQUIRE(foundTracks.size() == 3);
+    REQUIRE(foundTracks[0].getDuration() == 180);
+    REQUIRE(foundTracks[1].getDuration() == 240);
+    REQUIRE(foundTracks[2].getDuration() == 300);
+    REQUIRE(hashTable.countByDuration(300, 100) == 0);
+
+    // The index follows later inserts and removals
+    REQUIRE(hashTable.remove("Title2", "Artist2"));
+    hashTable.insert(Track(5, "Title5", "Artist2", 200));
+    REQUIRE(hashTable.countByDuration(180, 240) == 2);
+    REQUIRE(hashTable.searchByDuration(190, 210)[0].getTitle() == "Title5");
+}
+
+TEST_CASE("DurationIndex: Test queries between changes against a plain list")
+{
+    // Queries read the pending changes alongside the columns, before and after they are merged
+    DurationIndex durationIndex;
+    std::vector<std::pair<int, uint32_t>> rows;
+    std::mt19937 rng(11);
+    for (uint32_t id = 0; id < 3000; ++id)
+    {
+        int duration = static_cast<int>(rng() % 500);
+        durationIndex.add(duration, id);
+        rows.emplace_back(duration, id);
+        if (id % 3 == 0)
+        {
+            size_t victim = rng() % rows.size();
+            durationIndex.remove(rows[victim].first, rows[victim].second);
+            durationIndex.remove(rows[victim].first, rows[victim].second); // Removing twice changes nothing
+            rows.erase(rows.begin() + victim);
+        }
+        if (id % 97 == 0)
+        {
+            int minDuration = static_cast<int>(rng() % 500);
+            int maxDuration = minDuration + static_cast<int>(rng() % 100);
+            std::vector<std::pair<int, uint32_t>> expected;
+            for (const std::pair<int, uint32_t> &row : rows)
+            {
+                if (row.first >= minDuration && row.first <= maxDuration)
+                {
+                    expected.push_back(row);
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+            std::vector<uint32_t> expectedIds;
+            for (const std::pair<int, uint32_t> &row : expected)
+            {
+                expectedIds.push_back(row.second);
+            }
+            REQUIRE(durationIndex.count(minDuration, maxDuration) == expected.size());
+            REQUIRE(durationIndex.find(minDuration, maxDuration) == expectedIds);
+        }
+    }
+    REQUIRE(durationIndex.count(0, 499) == rows.size());
+}
+
+TEST_CASE("TrackColumns: Test aggregates over the columnar copy")
+{
+    HashTable hashTable(10);
+    hashTable.insert(Track(1, "Title1", "Artist1", 120));
+    hashTable.insert(Track(2, "Title2", "Artist2", 180));
+    hashTable.insert(Track(3, "Title3", "ARTIST1", 240));
+
+    TrackColumns columns(hashTable);
+    REQUIRE(columns.size() == 3);
+    REQUIRE(columns.artistCount() == 2);
+    REQUIRE(columns.totalDuration() == 540);
+    REQUIRE(columns.minDuration() == 120);
+    REQUIRE(columns.maxDuration() == 240);
+    REQUIRE(columns.averageDuration() == Approx(180.0));
+
+    // Artists are grouped case insensitively under their first spelling
+    std::vector<std::pair<std::string, size_t>> artistCounts = columns.countPerArtist();
+    REQUIRE(artistCounts[0].first == "Artist1");
+    REQUIRE(artistCounts[0].second == 2);
+    REQUIRE(artistCounts[1].second == 1);
+
+    REQUIRE(columns.durationHistogram(60) == std::vector<size_t>{0, 0, 1, 1, 1});
+    REQUIRE(columns.isCurrent(hashTable));
+
+    // A huge duration lands in the last bucket instead of sizing the histogram
+    hashTable.insert(Track(4, "Title4", "Artist2", 2000000000));
+    REQUIRE_FALSE(columns.isCurrent(hashTable));
+    TrackColumns longColumns(hashTable);
+    std::vector<size_t> histogram = longColumns.durationHistogram(60);
+    REQUIRE(histogram.size() == TrackColumns::maxHistogramBuckets);
+    REQUIRE(histogram.back() == 1);
+    REQUIRE(longColumns.durationHistogram(1).back() == 1);
+
+    // A table holding the same number of changes is still another table
+    HashTable otherTable(10);
+    for (int i = 1; i <= 4; ++i)
+    {
+        otherTable.insert(Track(i, "Title" + std::to_string(i), "Artist" + std::to_string(i), 120));
+    }
+    REQUIRE(longColumns.isCurrent(hashTable));
+    REQUIRE_FALSE(longColumns.isCurrent(otherTable));
+}
+
+TEST_CASE("HashTable class: Test Insert many tracks with duplicates")
+{
+    HashTable hashTable(4);
+    hashTable.insert(Track(1, "Title1", "Artist1", 120));
+
+    std::vector<Track> batch = {
+        Track(2, "Title2", "Artist1", 180),
+        Track(3, "TITLE1", "artist1", 200), // Duplicate of a stored track
+        Track(4, "Title3", "Artist2", 240),
+        Track(5, "title2", "ARTIST1", 260), // Duplicate within the batch
+        Track(6, "Title4", "Artist1", 300)};
+    REQUIRE(hashTable.insertMany(batch) == 3);
+    REQUIRE(hashTable.size() == 4);
+
+    // Tracks keep their insertion order within a bucket
+    std::vector<Track> foundTracks = hashTable.search("Artist1");
+    REQUIRE(foundTracks.size() == 3);
+    REQUIRE(foundTracks[0].getTitle() == "Title1");
+    REQUIRE(foundTracks[1].getTitle() == "Title2");
+    REQUIRE(foundTracks[1].getDuration() == 180);
+    REQUIRE(foundTracks[2].getTitle() == "Title4");
+
+    REQUIRE(hashTable.remove("Title3", "Artist2"));
+    REQUIRE(hashTable.size() == 3);
+}
+
+TEST_CASE("HashTable class: Test Find and remove by title and artist")
+{
+    HashTable hashTable(3);
+    hashTable.insert(Track(1, "Title1", "Artist1", 120));
+    hashTable.insert(Track(2, "Title2", "Artist1", 180));
+    hashTable.insert(Track(3, "Title3", "Artist1", 240));
+    hashTable.insert(Track(4, "Title4", "Artist2", 300));
+
+    std::optional<Track> found = hashTable.find("title2", "ARTIST1");
+    REQUIRE(found.has_value());
+    REQUIRE(found->getDuration() == 180);
+    REQUIRE_FALSE(hashTable.find("Title2", "Artist2").has_value());
+
+    // Remove from the middle and the end of an artist's list, then append again
+    REQUIRE(hashTable.remove("Title2", "Artist1"));
+    REQUIRE(hashTable.remove("Title3", "Artist1"));
+    REQUIRE_FALSE(hashTable.remove("Title3", "Artist1"));
+    hashTable.insert(Track(5, "Title5", "Artist1", 200));
+
+    std::vector<Track> foundTracks = hashTable.search("Artist1");
+    REQUIRE(foundTracks.size() == 2);
+    REQUIRE(foundTracks[0].getTitle() == "Title1");
+    REQUIRE(foundTracks[1].getTitle() == "Title5");
+    REQUIRE_FALSE(hashTable.find("Title2", "Artist1").has_value());
+    REQUIRE(hashTable.getAllTracks().size() == 3);
+}
+
+TEST_CASE("HashTable class: Test Remove many tracks")
+{
+    HashTable hashTable(2);
+    hashTable.insert(Track(1, "Title1", "Artist1", 120));
+    hashTable.insert(Track(2, "Title2", "Artist2", 180));
+    hashTable.insert(Track(3, "Title3", "Artist1", 240));
+    hashTable.insert(Track(4, "Title4", "Artist3", 300));
+
+    std::vector<std::pair<std::string, std::string>> removals = {
+        {"title3", "artist1"},
+        {"Missing", "Artist1"},
+        {"Title4", "Artist3"},
+        {"Title3", "Artist1"}, // Already removed by the first request
+        {"Title1", "Artist1"}};
+    std::vector<bool> removed = hashTable.removeMany(removals);
+    REQUIRE(removed == std::vector<bool>{true, false, true, false, true});
+
+    REQUIRE(hashTable.size() == 1);
+    REQUIRE(hashTable.search("Artist1").empty());
+    REQUIRE(hashTable.search("Artist2").size() == 1);
+}
+
+TEST_CASE("CatalogGenerator: Test deterministic rows and malformed durations")
+{
+    GeneratorOptions options;
+    options.trackCount = 200;
+    options.duplicateRate = 0.1;
+    options.malformedRate = 0.1;
+    options.unicodeRate = 0.2;
+    options.seed = 42;
+
+    // The same seed produces the same catalog
+    std::ostringstream first, second;
+    REQUIRE(CatalogGenerator(options).write(first) == 200);
+    CatalogGenerator(options).write(second);
+    REQUIRE(first.str() == second.str());
+
+    // Every row has three tab separated fields
+    std::istringstream rows(first.str());
+    std::string row;
+    size_t rowCount = 0;
+    while (std::getline(rows, row))
+    {
+        REQUIRE(std::count(row.begin(), row.end(), '\t') == 2);
+        rowCount++;
+    }
+    REQUIRE(rowCount == 200);
+
+    // Rows are drawn from the generator's bits only, so they do not depend on the standard library
+    GeneratorOptions pinned;
+    pinned.trackCount = 1;
+    pinned.seed = 3;
+    std::string pinnedRow;
+    REQUIRE(CatalogGenerator(pinned).nextRow(pinnedRow));
+    REQUIRE(pinnedRow == "Blue Version on No. 1\tDovejo 1\t232");
+
+    // The loader skips malformed durations, including values too large for an int
+    std::string fileName = "generator_test_catalog.txt";
+    {
+        std::ofstream outputFile(fileName);
+        outputFile << first.str() << "Overflow\tArtist\t99999999999\n";
+    }
+    std::vector<Track> tracks = loadTracksFromFile(fileName);
+    std::remove(fileName.c_str());
+    REQUIRE(tracks.size() > 150);
+    REQUIRE(tracks.size() < 201);
+}
+
+TEST_CASE("ZipfSampler: Test ranks stay in range and favour low ranks")
+{
+    ZipfSampler sampler(100, 1.0);
+    std::mt19937_64 rng(1);
+    size_t firstRank = 0, lastRank = 0, outOfRange = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+        uint64_t rank = sampler.sample(rng);
+        outOfRange += rank < 1 || rank > 100;
+        firstRank += rank == 1;
+        lastRank += rank == 100;
+    }
+    REQUIRE(outOfRange == 0);
+    REQUIRE(firstRank > 10 * lastRank);
+}
+
+TEST_CASE("HashTable class: Test Statistics and automatic resize")
+{
+    HashTable hashTable(2);
+    hashTable.insert(Track(1, "Title1", "Artist1", 120));
+    hashTable.insert(Track(2, "Title2", "Artist2", 180));
+    hashTable.insert(Track(3, "Title3", "Artist1", 240)); // Exceeds one track per bucket
+    hashTable.insert(Track(4, "Title1", "Artist1", 120)); // Duplicate
+    hashTable.search("Artist1");
+    hashTable.remove("Missing", "Artist1");
+
+    HashTableStats stats = hashTable.getStats();
+    REQUIRE(stats.tableSize == 4);
+    REQUIRE(stats.trackCount == 3);
+    REQUIRE(stats.longestChain >= 2);
+    if (stats.countersEnabled)
+    {
+        REQUIRE(stats.inserts == 3);
+        REQUIRE(stats.duplicateRejects == 1);
+        REQUIRE(stats.searches == 1);
+        REQUIRE(stats.searchProbes >= 2);
+        REQUIRE(stats.removeMisses == 1);
+        REQUIRE(stats.resizes == 1);
+    }
+
+    // Resizing keeps every track reachable and in insertion order
+    hashTable.rehash(64);
+    std::vector<Track> foundTracks = hashTable.search("Artist1");
+    REQUIRE(foundTracks.size() == 2);
+    REQUIRE(foundTracks[0].getTitle() == "Title1");
+    REQUIRE(foundTracks[1].getTitle() == "Title3");
+    REQUIRE(hashTable.find("Title2", "Artist2").has_value());
+    REQUIRE(hashTable.remove("Title2", "Artist2"));
+
+    std::ostringstream json;
+    hashTable.writeStats(json);
+    REQUIRE(json.str().find("\"tableSize\":64") != std::string::npos);
+}
+
+TEST_CASE("HashTable class: Test Artist filter in front of search")
+{
+    HashTable hashTable(16);
+    for (int i = 0; i < 2000; ++i)
+    {
+        hashTable.insert(Track(i + 1, "Title" + std::to_string(i), "Artist" + std::to_string(i % 1000), 100 + i % 200));
+    }
+
+    // Absent artists are answered without the dictionary, present ones are never turned away
+    size_t missesFound = 0;
+    size_t hitsFound = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        missesFound += hashTable.search("Missing" + std::to_string(i)).size();
+        hitsFound += hashTable.search("ARTIST" + std::to_string(i)).size();
+    }
+    REQUIRE(missesFound == 0);
+    REQUIRE(hitsFound == 2000);
+    HashTableStats stats = hashTable.getStats();
+    REQUIRE(stats.filterBytes > 0);
+    if (stats.countersEnabled)
+    {
+        REQUIRE(stats.filterRejects >= 950);
+        REQUIRE(stats.filterRejects <= 1000);
+    }
+
+    // Artists left without tracks are dropped from the filter once enough of them pile up
+    for (int i = 0; i < 2000; ++i)
+    {
+        if (i % 1000 < 500)
+        {
+            hashTable.remove("Title" + std::to_string(i), "Artist" + std::to_string(i % 1000));
+        }
+    }
+    uint64_t rejectsBefore = hashTable.getStats().filterRejects;
+    size_t removedFound = 0;
+    for (int i = 0; i < 500; ++i)
+    {
+        removedFound += hashTable.search("Artist" + std::to_string(i)).size();
+    }
+    REQUIRE(removedFound == 0);
+    REQUIRE(hashTable.search("Artist500").size() == 2);
+    if (stats.countersEnabled)
+    {
+        REQUIRE(hashTable.getStats().filterRejects - rejectsBefore >= 300);
+    }
+
+    // An artist coming back is found again, and turning the filter off changes no result
+    hashTable.insert(Track(3000, "Comeback", "Artist7", 200));
+    REQUIRE(hashTable.search("artist7").size() == 1);
+    hashTable.setArtistFilter(false);
+    REQUIRE(hashTable.getStats().filterBytes == 0);
+    REQUIRE(hashTable.search("Artist7").size() == 1);
+    REQUIRE(hashTable.search("Artist3").empty());
+    REQUIRE(hashTable.search("Missing1").empty());
+    hashTable.setArtistFilter(true);
+    REQUIRE(hashTable.search("Artist999").size() == 2);
+}
+
+TEST_CASE("SearchCache: Test CLOCK eviction and precise invalidation")
+{
+    // 16 shards of 4 tracks each
+    SearchCache cache(64);
+    std::shared_ptr<const std::vector<Track>> twoTracks = std::make_shared<const std::vector<Track>>(2, Track(1, "Title", "Artist", 100));
+    cache.store("artist", twoTracks);
+    REQUIRE(cache.find("artist") == twoTracks);
+    REQUIRE(cache.find("other") == nullptr);
+    cache.invalidate("other");
+    REQUIRE(cache.find("artist") == twoTracks);
+    cache.invalidate("artist");
+    REQUIRE(cache.find("artist") == nullptr);
+    REQUIRE(cache.isEmpty());
+
+    // A result larger than a shard is never cached, and a shard evicts to stay within its tracks
+    cache.store("prolific", std::make_shared<const std::vector<Track>>(5, Track(1, "Title", "Artist", 100)));
+    REQUIRE(cache.find("prolific") == nullptr);
+    for (int i = 0; i < 200; ++i)
+    {
+        cache.store("artist" + std::to_string(i), twoTracks);
+    }
+    HashTableStats stats = {};
+    cache.fillStats(stats);
+    REQUIRE(stats.cachedTracks <= 64);
+    REQUIRE(stats.cachedResults == stats.cachedTracks / 2);
+    if (HASHTABLE_STATS)
+    {
+        REQUIRE(stats.cacheEvictions == 200 - stats.cachedResults);
+        REQUIRE(stats.cacheInvalidations == 1);
+    }
+    cache.setCapacity(0);
+    REQUIRE_FALSE(cache.isEnabled());
+    REQUIRE(cache.isEmpty());
+}
+
+TEST_CASE("HashTable class: Test Search results cached until their artist changes")
+{
+    HashTable hashTable(16);
+    hashTable.insert(Track(1, "Title1", "Artist1", 120));
+    hashTable.insert(Track(2, "Title2", "Artist2", 180));
+    hashTable.insert(Track(3, "Title3", "Artist1", 240));
+
+    // Every spelling shares the cached result
+    std::shared_ptr<const std::vector<Track>> first = hashTable.searchShared("Artist1");
+    REQUIRE(first->size() == 2);
+    REQUIRE(hashTable.searchShared("ARTIST1") == first);
+    REQUIRE(hashTable.search("artist1").size() == 2);
+    std::shared_ptr<const std::vector<Track>> other = hashTable.searchShared("Artist2");
+
+    // Only the artist whose tracks changed loses its result, the result already handed out stays as it was
+    hashTable.insert(Track(4, "Title4", "artist1", 300));
+    REQUIRE(hashTable.searchShared("Artist2") == other);
+    std::vector<Track> foundTracks = hashTable.search("Artist1");
+    REQUIRE(foundTracks.size() == 3);
+    REQUIRE(foundTracks[2].getArtist() == "artist1");
+    REQUIRE(first->size() == 2);
+    hashTable.insert(Track(5, "Title1", "ARTIST1", 120)); // Duplicate, nothing changes
+    REQUIRE(hashTable.search("Artist1").size() == 3);
+    REQUIRE(hashTable.remove("Title3", "ARTIST1"));
+    REQUIRE(hashTable.search("Artist1").size() == 2);
+    REQUIRE(hashTable.removeMany({{"Title2", "Artist2"}})[0]);
+    REQUIRE(hashTable.searchShared("Artist2")->empty());
+    hashTable.insert(Track(6, "Title6", "Artist2", 60));
+    REQUIRE(hashTable.search("Artist2").size() == 1);
+
+    HashTableStats stats = hashTable.getStats();
+    if (stats.countersEnabled)
+    {
+        REQUIRE(stats.cacheHits == 4);
+        REQUIRE(stats.cacheInvalidations == 3);
+    }
+
+    // Line numbers dropped later are not served from the cache
+    hashTable.discardLineNumbers();
+    REQUIRE(hashTable.search("Artist1")[0].getLineNumber() == 0);
+
+    // Searches from many threads share the cache
+    std::vector<std::thread> threads;
+    std::atomic<size_t> wrongResults(0);
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&hashTable, &wrongResults]()
+                             {
+            for (int i = 0; i < 1000; ++i)
+            {
+                if (hashTable.search(i % 2 ? "Artist1" : "Artist2").size() != (i % 2 ? 2u : 1u))
+                {
+                    wrongResults++;
+                }
+            } });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    REQUIRE(wrongResults == 0);
+
+    hashTable.setSearchCacheCapacity(0);
+    REQUIRE(hashTable.search("Artist1").size() == 2);
+    REQUIRE(hashTable.getStats().cachedResults == 0);
+}
+
+TEST_CASE("HashTable class: Test Sorted pages of the tracks of an artist")
+{
+    HashTable hashTable(16);
+    hashTable.insert(Track(1, "delta", "Artist1", 300));
+    hashTable.insert(Track(2, "Alpha", "Artist1", 200));
+    hashTable.insert(Track(3, "charlie", "ARTIST1", 100));
+    hashTable.insert(Track(4, "Bravo", "Artist1", 200));
+
+    // Few tracks are sorted for each page, titles ignoring case and every spelling together
+    TrackPage page = hashTable.searchPage("artist1", TrackOrder::Title, 1, 2);
+    REQUIRE(page.totalTracks == 4);
+    REQUIRE(page.tracks.size() == 2);
+    REQUIRE(page.tracks[0].getTitle() == "Bravo");
+    REQUIRE(page.tracks[1].getTitle() == "charlie");
+    page = hashTable.searchPage("Artist1", TrackOrder::Duration, 0, 10);
+    REQUIRE(page.tracks.size() == 4);
+    REQUIRE(page.tracks[0].getTitle() == "charlie");
+    REQUIRE(page.tracks[3].getTitle() == "delta");
+    REQUIRE(hashTable.searchPage("Artist1", TrackOrder::Title, 4, 10).tracks.empty());
+    REQUIRE(hashTable.searchPage("Nobody", TrackOrder::Title, 0, 10).totalTracks == 0);
+    REQUIRE(hashTable.getStats().orderedArtists == 0);
+
+    // A prolific artist is kept sorted from its inserts on, pages reading the same order as sorting every track
+    std::vector<std::pair<std::string, int>> expected;
+    for (int i = 0; i < 1500; ++i)
+    {
+        std::string title = "Song" + std::to_string((i * 7919) % 2000);
+        int duration = 60 + (i * 37) % 200;
+        hashTable.insert(Track(i + 10, title, "Prolific", duration));
+        expected.emplace_back(title, duration);
+    }
+    auto checkPages = [&](TrackOrder order)
+    {
+        std::vector<std::pair<std::string, int>> sorted(expected);
+        std::sort(sorted.begin(), sorted.end(), [order](const std::pair<std::string, int> &lhs, const std::pair<std::string, int> &rhs)
+                  { return order == TrackOrder::Title ? lhs.first < rhs.first : lhs.second < rhs.second; });
+        std::vector<std::pair<std::string, int>> paged;
+        for (size_t offset = 0; offset < sorted.size(); offset += 25)
+        {
+            TrackPage page = hashTable.searchPage("prolific", order, offset, 25);
+            REQUIRE(page.totalTracks == sorted.size());
+            for (const Track &track : page.tracks)
+            {
+                paged.emplace_back(track.getTitle(), track.getDuration());
+            }
+        }
+        REQUIRE(paged.size() == sorted.size());
+        for (size_t i = 0; i < sorted.size(); ++i)
+        {
+            REQUIRE((order == TrackOrder::Title ? paged[i].first == sorted[i].first : paged[i].second == sorted[i].second));
+        }
+    };
+    REQUIRE(hashTable.getStats().orderedArtists == 1);
+    REQUIRE(hashTable.getStats().orderedTracks == 1500);
+    checkPages(TrackOrder::Title);
+    checkPages(TrackOrder::Duration);
+
+    // Tracks added and removed afterwards take or leave their place in the kept order
+    hashTable.insert(Track(400, "AAA first", "PROLIFIC", 1));
+    REQUIRE(hashTable.remove(expected[0].first, "Prolific"));
+    expected.erase(expected.begin());
+    expected.emplace_back("AAA first", 1);
+    checkPages(TrackOrder::Title);
+    checkPages(TrackOrder::Duration);
+    REQUIRE(hashTable.searchPage("Prolific", TrackOrder::Duration, 0, 1).tracks[0].getTitle() == "AAA first");
+    REQUIRE(hashTable.getStats().orderedTracks == 1500);
+
+    // Removing most of them empties and joins blocks without losing the order
+    std::vector<std::pair<std::string, std::string>> removals;
+    for (size_t i = 0; i < 1200; ++i)
+    {
+        removals.emplace_back(expected[i].first, "Prolific");
+    }
+    hashTable.removeMany(removals);
+    expected.erase(expected.begin(), expected.begin() + 1200);
+    checkPages(TrackOrder::Title);
+    checkPages(TrackOrder::Duration);
+    REQUIRE(hashTable.getStats().orderedTracks == 300);
+}
+
+TEST_CASE("LatencyHistogram: Test bucket precision and percentiles")
+{
+    // Every value falls in a bucket whose upper bound is within about 3% above it
+    for (uint64_t value : {0ull, 1ull, 63ull, 64ull, 65ull, 1000ull, 123456789ull, (1ull << 40) + 17})
+    {
+        uint64_t upperBound = LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketIndex(value));
+        REQUIRE(upperBound >= value);
+        REQUIRE(upperBound - value <= value / 32);
+    }
+    REQUIRE(LatencyHistogram::bucketIndex(~0ull) == LatencyHistogram::bucketCount - 1);
+
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 1000; ++value)
+    {
+        histogram.record(value);
+    }
+    std::vector<uint64_t> totals;
+    histogram.addTo(totals);
+    LatencySummary summary = LatencyHistogram::summarize(totals);
+    REQUIRE(summary.count == 1000);
+    REQUIRE(summary.p50 >= 500);
+    REQUIRE(summary.p50 <= 515);
+    REQUIRE(summary.p99 >= 990);
+    REQUIRE(summary.p999 >= 999);
+    REQUIRE(summary.max >= 1000);
+    REQUIRE(summary.max <= 1031);
+}
+
+TEST_CASE("LatencyHistogram: Test recordings from many threads are merged")
+{
+    if (!LATENCY_STATS)
+    {
+        return;
+    }
+
+    uint64_t countBefore = summarizeLatency(Operation::Search).count;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([]()
+                             {
+            HashTable hashTable(16);
+            hashTable.insert(Track(1, "Title", "Artist", 120));
+            for (int j = 0; j < 250; ++j)
+            {
+                hashTable.search("Artist");
+            } });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    REQUIRE(summarizeLatency(Operation::Search).count == countBefore + 1000);
+
+    // Threads started one after another reuse the blocks of exited threads and keep their counts
+    size_t blocksBefore = countLatencyHistogramBlocks();
+    for (int i = 0; i < 20; ++i)
+    {
+        std::thread([]()
+                    { recordLatency(Operation::Load, 1000); })
+            .join();
+    }
+    REQUIRE(countLatencyHistogramBlocks() == blocksBefore);
+    REQUIRE(summarizeLatency(Operation::Search).count == countBefore + 1000);
+
+    std::ostringstream json;
+    writeLatencyReport(json);
+    REQUIRE(json.str().find("\"search\":{\"count\":") != std::string::npos);
+}
+
+TEST_CASE("Batch mode: Test commands and machine readable results")
+{
+    HashTable hashTable(16);
+    hashTable.insert(Track(1, "Title1", "Artist1", 120));
+
+    std::istringstream commands("# comment line\n"
+                                "search\tartist1\n"
+                                "add\tTitle2\tArtist1\t180\n"
+                                "add\ttitle2\tARTIST1\t180\n"
+                                "add\tTitle3\tArtist1\tlong\n"
+                                "\n"
+                                "count\tArtist1\n"
+                                "page\tartist1\tduration\t1\t5\n"
+                                "page\tArtist1\ttitle\tfirst\t5\n"
+                                "remove\tTitle1\tArtist1\n"
+                                "remove\tTitle1\tArtist1\n"
+                                "frobnicate\n");
+    std::ostringstream results;
+    BatchSummary summary = runBatch(hashTable, commands, results);
+
+    REQUIRE(summary.commands == 10);
+    REQUIRE(summary.failures == 3);
+    REQUIRE(results.str() == "OK\t1\n"
+                             "Title1\tArtist1\t120\n"
+                             "OK\n"
+                             "DUPLICATE\n"
+                             "ERR\tinvalid duration long\n"
+                             "OK\t2\n"
+                             "OK\t1\t2\n"
+                             "Title2\tArtist1\t180\n"
+                             "ERR\tinvalid offset or limit on line 9\n"
+                             "OK\n"
+                             "NOT_FOUND\n"
+                             "ERR\tinvalid command on line 12\n");
+    REQUIRE(hashTable.size() == 1);
+}
+
+TEST_CASE("LibraryServer: Test pipelined requests over a Unix socket")
+{
+    HashTable hashTable(16);
+    hashTable.insert(Track(1, "Title1", "Artist1", 120));
+    hashTable.insert(Track(2, "Title2", "Artist1", 180));
+
+    std::string socketPath = "/tmp/music_library_test_" + std::to_string(getpid()) + ".sock";
+    LibraryServer server(hashTable, socketPath);
+    REQUIRE(server.start());
+    std::thread serverThread([&server]()
+                             { server.run(); });
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    socketPath.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+
+    // Send every request before reading any response
+    std::string requests;
+    encodeRequest(Request{Opcode::Search, "", "artist1", 0}, requests);
+    encodeRequest(Request{Opcode::Insert, "Title3", "Artist1", 240}, requests);
+    encodeRequest(Request{Opcode::Insert, "title3", "ARTIST1", 240}, requests);
+    encodeRequest(Request{Opcode::Remove, "Title1", "Artist1", 0}, requests);
+    encodeRequest(Request{Opcode::Count, "", "Artist1", 0}, requests);
+    encodeRequest(Request{Opcode::Count, "", "Missing", 0}, requests);
+    requests.append("\x01\x00\x00\x00\x7f", 5); // Unknown opcode
+    REQUIRE(send(fd, requests.data(), requests.size(), 0) == static_cast<ssize_t>(requests.size()));
+
+    std::vector<Response> responses;
+    std::string input;
+    char chunk[4096];
+    ssize_t bytes;
+    while ((bytes = read(fd, chunk, sizeof(chunk))) > 0)
+    {
+        input.append(chunk, bytes);
+    }
+    Response response;
+    size_t offset = 0, frameSize;
+    while (decodeResponse(input.data() + offset, input.size() - offset, response, frameSize) == DecodeResult::Complete)
+    {
+        responses.push_back(response);
+        offset += frameSize;
+    }
+    close(fd);
+
+    // A client shutting down its side after the last request still gets every answer
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+    requests.clear();
+    encodeRequest(Request{Opcode::Count, "", "Artist1", 0}, requests);
+    encodeRequest(Request{Opcode::Search, "", "Artist1", 0}, requests);
+    // Titles longer than 65535 bytes are stored and returned whole
+    std::string longTitle(70000, 'x');
+    encodeRequest(Request{Opcode::Insert, longTitle, "Long Artist", 300}, requests);
+    encodeRequest(Request{Opcode::Search, "", "Long Artist", 0}, requests);
+    REQUIRE(send(fd, requests.data(), requests.size(), 0) == static_cast<ssize_t>(requests.size()));
+    REQUIRE(shutdown(fd, SHUT_WR) == 0);
+    input.clear();
+    while ((bytes = read(fd, chunk, sizeof(chunk))) > 0)
+    {
+        input.append(chunk, bytes);
+    }
+    close(fd);
+    std::vector<Response> halfClosedResponses;
+    offset = 0;
+    while (decodeResponse(input.data() + offset, input.size() - offset, response, frameSize) == DecodeResult::Complete)
+    {
+        halfClosedResponses.push_back(response);
+        offset += frameSize;
+    }
+    REQUIRE(halfClosedResponses.size() == 4);
+    REQUIRE(halfClosedResponses[1].tracks.size() == 2);
+    REQUIRE(halfClosedResponses[2].status == Status::Ok);
+    REQUIRE(halfClosedResponses[3].tracks.size() == 1);
+    REQUIRE(halfClosedResponses[3].tracks[0].getTitle() == longTitle);
+    REQUIRE(hashTable.find(longTitle, "Long Artist").has_value());
+
+    server.stop();
+    serverThread.join();
+
+    REQUIRE(responses.size() == 7);
+    REQUIRE(responses[0].status == Status::Ok);
+    REQUIRE(responses[0].count == 2);
+    REQUIRE(responses[0].tracks.size() == 2);
+    REQUIRE(responses[0].tracks[1].getTitle() == "Title2");
+    REQUIRE(responses[0].tracks[1].getDuration() == 180);
+    REQUIRE(responses[1].status == Status::Ok);
+    REQUIRE(responses[2].status == Status::Duplicate);
+    REQUIRE(responses[3].status == Status::Ok);
+    REQUIRE(responses[4].count == 2);
+    REQUIRE(responses[5].status == Status::NotFound);
+    REQUIRE(responses[6].status == Status::BadRequest); // The server hangs up after a bad request
+    REQUIRE(server.getRequestsServed() == 10);
+    REQUIRE(hashTable.size() == 3);
+}
+
+TEST_CASE("SharedCatalog: Test image search and version swap")
+{
+    HashTable hashTable(16);
+    hashTable.insert(Track(1, "Title1", "Artist1", 120));
+    hashTable.insert(Track(2, "Title2", "Artist2", 180));
+    hashTable.insert(Track(3, "Title3", "Artist1", 240));
+
+    // The image is searched in place and answers like the hash table
+    std::string image = buildCatalogImage(hashTable);
+    SharedCatalogView view(image.data(), image.size());
+    REQUIRE(view.isValid());
+    REQUIRE(view.size() == 3);
+    std::vector<Track> foundTracks = view.search("ARTIST1");
+    REQUIRE(foundTracks.size() == 2);
+    REQUIRE(foundTracks[0].getTitle() == "Title1");
+    REQUIRE(foundTracks[1].getTitle() == "Title3");
+    REQUIRE(foundTracks[1].getLineNumber() == 3);
+    REQUIRE(view.search("Missing").empty());
+    REQUIRE_FALSE(SharedCatalogView(image.data(), image.size() - 1).isValid());
+
+    std::string name = "/music_library_test_" + std::to_string(getpid());
+    SharedCatalogReader reader(name);
+    REQUIRE_FALSE(reader.refresh());
+    REQUIRE(publishSharedCatalog(hashTable, name) == 1);
+    REQUIRE(reader.refresh());
+    REQUIRE(reader.getVersion() == 1);
+    REQUIRE(reader.view().search("Artist2").size() == 1);
+
+    // A new version is picked up on refresh, until then the old one stays mapped
+    hashTable.remove("Title2", "Artist2");
+    REQUIRE(publishSharedCatalog(hashTable, name) == 2);
+    REQUIRE(reader.view().search("Artist2").size() == 1);
+    REQUIRE(reader.refresh());
+    REQUIRE(reader.getVersion() == 2);
+    REQUIRE(reader.view().search("Artist2").empty());
+    REQUIRE(reader.view().size() == 2);
+
+    // Publishers running together each claim their own version and the last image stays readable
+    std::vector<uint64_t> versions(8);
+    std::vector<std::thread> publishers;
+    for (size_t i = 0; i < versions.size(); ++i)
+    {
+        publishers.emplace_back([&, i]()
+                                { versions[i] = publishSharedCatalog(hashTable, name); });
+    }
+    for (std::thread &publisher : publishers)
+    {
+        publisher.join();
+    }
+    std::sort(versions.begin(), versions.end());
+    REQUIRE(std::adjacent_find(versions.begin(), versions.end()) == versions.end());
+    REQUIRE(versions.front() == 3);
+    REQUIRE(versions.back() == 10);
+    REQUIRE(reader.refresh());
+    REQUIRE(reader.getVersion() == 10);
+    REQUIRE(reader.view().size() == 2);
+
+    shm_unlink((name + ".10").c_str());
+    shm_unlink(name.c_str());
+}
+
+TEST_CASE("FrozenCatalog: Test perfect hash search and file reload")
+{
+    HashTable hashTable(16);
+    for (int i = 0; i < 3000; ++i)
+    {
+        hashTable.insert(Track(i + 1, "Title" + std::to_string(i), "Artist" + std::to_string(i % 1000), 100 + i % 200));
+    }
+    hashTable.insert(Track(3001, "Other Title", "ARTIST7", 90));
+    hashTable.remove("Title999", "Artist999");
+
+    // Every artist is found in its own slot with the tracks and order of the hash table, spellings included
+    std::string image = buildFrozenCatalog(hashTable);
+    FrozenCatalogView view(image.data(), image.size());
+    REQUIRE(view.isValid());
+    REQUIRE(view.size() == hashTable.size());
+    REQUIRE(view.artistCount() == 1000);
+    bool sameResults = true;
+    for (int artist = 0; artist < 1000; ++artist)
+    {
+        std::vector<Track> expected = hashTable.search("artist" + std::to_string(artist));
+        std::vector<Track> foundTracks = view.search("artist" + std::to_string(artist));
+        sameResults = sameResults && foundTracks.size() == expected.size() &&
+                      view.count("ARTIST" + std::to_string(artist)) == expected.size();
+        for (size_t i = 0; sameResults && i < expected.size(); ++i)
+        {
+            sameResults = foundTracks[i].getTitle() == expected[i].getTitle() &&
+                          foundTracks[i].getArtist() == expected[i].getArtist() &&
+                          foundTracks[i].getDuration() == expected[i].getDuration() &&
+                          foundTracks[i].getLineNumber() == 0;
+        }
+    }
+    REQUIRE(sameResults);
+    std::vector<Track> mixedSpellings = view.search("Artist7");
+    REQUIRE(mixedSpellings.size() == 4);
+    REQUIRE(mixedSpellings[3].getArtist() == "ARTIST7");
+    REQUIRE(view.search("Artist1000").empty());
+    REQUIRE(view.count("Missing") == 0);
+    REQUIRE_FALSE(FrozenCatalogView(image.data(), image.size() - 1).isValid());
+
+    // An empty table still freezes into a valid image that finds nothing
+    HashTable emptyTable(16);
+    std::string emptyImage = buildFrozenCatalog(emptyTable);
+    REQUIRE(FrozenCatalogView(emptyImage.data(), emptyImage.size()).isValid());
+    REQUIRE(FrozenCatalogView(emptyImage.data(), emptyImage.size()).search("Artist1").empty());
+
+    std::string fileName = "/tmp/music_library_frozen_" + std::to_string(getpid()) + ".mph";
+    REQUIRE(saveFrozenCatalog(hashTable, fileName));
+    FrozenCatalogFile frozenFile;
+    REQUIRE(frozenFile.open(fileName));
+    REQUIRE(frozenFile.view().search("Artist42").size() == 3);
+    REQUIRE(frozenFile.view().size() == hashTable.size());
+    std::remove(fileName.c_str());
+    REQUIRE_FALSE(frozenFile.open("/tmp/music_library_missing_file.mph"));
+    REQUIRE_FALSE(frozenFile.view().isValid());
+}
+
+TEST_CASE("BackgroundLoader: Test progress, visibility and cancellation")
+{
+    std::string fileName = "/tmp/music_library_background_" + std::to_string(getpid()) + ".txt";
+    {
+        std::ofstream file(fileName);
+        for (int i = 0; i < 20000; ++i)
+        {
+            file << "Title" << i << "\tArtist" << i % 100 << "\t" << 100 + i % 200 << "\n";
+        }
+        file << "Title0\tARTIST0\t100\n"; // Duplicate
+        file << "Broken\tArtist0\tlong\n";
+    }
+
+    HashTable hashTable(16);
+    std::mutex tableMutex;
+    BackgroundLoader loader(hashTable, tableMutex);
+    REQUIRE(loader.start(fileName));
+
+    // The table can be searched while the load runs, each search sees whole chunks only
+    bool onlyWholeChunks = true;
+    while (loader.isRunning())
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        onlyWholeChunks = onlyWholeChunks && (hashTable.size() % BackgroundLoader::chunkSize == 0 || hashTable.size() == 20000);
+        hashTable.search("Artist1");
+    }
+    loader.wait();
+    REQUIRE(onlyWholeChunks);
+
+    LoadProgress progress = loader.getProgress();
+    REQUIRE(progress.state == LoadState::Finished);
+    REQUIRE(progress.rowsParsed == 20002);
+    REQUIRE(progress.rowsInserted == 20000);
+    REQUIRE(progress.warnings == 1);
+    REQUIRE(progress.duplicates == 1);
+    REQUIRE(hashTable.size() == 20000);
+    REQUIRE(hashTable.search("Artist7").size() == 200);
+
+    // A cancelled load keeps the chunks it already added
+    HashTable otherTable(16);
+    BackgroundLoader otherLoader(otherTable, tableMutex);
+    REQUIRE(otherLoader.start(fileName));
+    otherLoader.cancel();
+    otherLoader.wait();
+    progress = otherLoader.getProgress();
+    REQUIRE(progress.state == LoadState::Cancelled);
+    REQUIRE(otherTable.size() == progress.rowsInserted);
+
+    REQUIRE(loader.start("/tmp/music_library_missing_file.txt"));
+    loader.wait();
+    REQUIRE(loader.getProgress().state == LoadState::Failed);
+    std::remove(fileName.c_str());
+}
+
+TEST_CASE("FileIngest: Test many files with io_uring and with reader threads")
+{
+    std::vector<std::string> fileNames;
+    for (int file = 0; file < 6; ++file)
+    {
+        fileNames.push_back("/tmp/music_library_ingest_" + std::to_string(getpid()) + "_" + std::to_string(file) + ".txt");
+        std::ofstream output(fileNames.back());
+        for (int row = 0; row < 3000; ++row)
+        {
+            output << "Title" << file << "-" << row << "\tArtist" << row % 50 << "\t" << 60 + row % 300 << "\n";
+        }
+        output << "Shared\tArtist0\t" << 100 + file; // In every file without a final newline, the first copy wins
+    }
+    fileNames.insert(fileNames.begin() + 2, "/tmp/music_library_missing_file.txt");
+
+    for (bool useIoUring : {true, false})
+    {
+        IngestOptions options;
+        options.useIoUring = useIoUring;
+        options.parseThreads = 3;
+        options.blockSize = 4096; // Many blocks per file
+        options.maxBufferedFiles = 2;
+        options.reportDuplicates = false;
+
+        HashTable hashTable(16);
+        IngestSummary summary = ingestFiles(hashTable, fileNames, options);
+        REQUIRE((summary.usedIoUring && !useIoUring) == false);
+        REQUIRE(summary.files.size() == 7);
+        REQUIRE_FALSE(summary.files[2].opened);
+        REQUIRE(summary.files[0].rows == 3001);
+        REQUIRE(summary.files[0].inserted == 3001);
+        REQUIRE(summary.files[1].inserted == 3000);
+        REQUIRE(summary.inserted == 6 * 3000 + 1);
+        REQUIRE(hashTable.size() == 6 * 3000 + 1);
+        REQUIRE(hashTable.find("Shared", "Artist0")->getDuration() == 100);
+        REQUIRE(hashTable.find("Title5-2999", "Artist49").has_value());
+    }
+
+    for (const std::string &fileName : fileNames)
+    {
+        std::remove(fileName.c_str());
+    }
+}
+
+TEST_CASE("IoUring: Test a full submission ring, withdrawn reads and cancellation")
+{
+    IoUring ring;
+    if (!ring.setup(4))
+    {
+        return; // Kernels without io_uring are covered by the fallback of FileIngest
+    }
+    std::string fileName = "/tmp/music_library_ring_" + std::to_string(getpid()) + ".txt";
+    std::ofstream(fileName) << "Title\tArtist\t100\n";
+    int fd = open(fileName.c_str(), O_RDONLY);
+    REQUIRE(fd >= 0);
+
+    // A full ring refuses reads instead of dropping them, and reads not yet submitted can be taken back
+    char buffer[64];
+    unsigned queued = 0;
+    while (ring.queueRead(fd, buffer, sizeof(buffer), 0, queued))
+    {
+        queued++;
+    }
+    REQUIRE(queued == 4);
+    std::vector<uint64_t> withdrawn = ring.withdrawQueued();
+    REQUIRE(withdrawn == std::vector<uint64_t>{0, 1, 2, 3});
+    REQUIRE(ring.submitAndWait(0));
+    uint64_t userData;
+    int result;
+    REQUIRE_FALSE(ring.popCompletion(userData, result));
+
+    // A read completes with its user data, cancelling a finished read still completes the cancellation
+    REQUIRE(ring.queueRead(fd, buffer, sizeof(buffer), 0, 7));
+    REQUIRE(ring.submitAndWait(1));
+    REQUIRE(ring.popCompletion(userData, result));
+    REQUIRE(userData == 7);
+    REQUIRE(result == 17);
+    REQUIRE(ring.queueCancel(7, 8));
+    REQUIRE(ring.submitAndWait(1));
+    REQUIRE(ring.popCompletion(userData, result));
+    REQUIRE(userData == 8);
+    REQUIRE(result < 0);
+
+    close(fd);
+    std::remove(fileName.c_str());
+}
+
+TEST_CASE("LineReader: Test gzip input detected by magic bytes")
+{
+    std::string base = "/tmp/music_library_compressed_" + std::to_string(getpid());
+    std::string text;
+    for (int i = 0; i < 50000; ++i)
+    {
+        text += "Title" + std::to_string(i) + "\tArtist" + std::to_string(i % 100) + "\t" + std::to_string(100 + i % 200) + "\n";
+    }
+    text += "Last\tArtist0\t60"; // No final newline
+
+    // Two members, as written by separate compressing threads
+    size_t half = text.size() / 2;
+    for (const std::string &part : {text.substr(0, half), text.substr(half)})
+    {
+        gzFile file = gzopen((base + ".gz").c_str(), part.data() == text.data() ? "wb" : "ab");
+        gzwrite(file, part.data(), static_cast<unsigned>(part.size()));
+        gzclose(file);
+    }
+    std::vector<Track> tracks = loadTracksFromFile(base + ".gz");
+    REQUIRE(tracks.size() == 50001);
+    REQUIRE(tracks[12345].getTitle() == "Title12345");
+    REQUIRE(tracks.back().getTitle() == "Last");
+    REQUIRE(tracks.back().getLineNumber() == 50001);
+
+    // A truncated file keeps the lines before the damage and is reported
+    std::ifstream compressedFile(base + ".gz", std::ios::binary);
+    std::string compressed((std::istreambuf_iterator<char>(compressedFile)), std::istreambuf_iterator<char>());
+    std::ofstream(base + ".truncated.gz", std::ios::binary) << compressed.substr(0, compressed.size() / 4);
+    LineReader truncated(base + ".truncated.gz");
+    REQUIRE(truncated.getCompression() == Compression::Gzip);
+    std::string line;
+    size_t lines = 0;
+    while (truncated.readLine(line))
+    {
+        lines++;
+    }
+    REQUIRE(lines > 0);
+    REQUIRE(lines < 50001);
+    REQUIRE(truncated.isCorrupt());
+
+    std::string decompressed;
+    REQUIRE(decompressGzip(compressed, decompressed));
+    REQUIRE(decompressed == text);
+
+    // zstd is recognised but cannot be read by this build
+    std::ofstream(base + ".zst", std::ios::binary) << "\x28\xb5\x2f\xfd";
+    REQUIRE_FALSE(LineReader(base + ".zst").isOpen());
+    REQUIRE(loadTracksFromFile(base + ".zst").empty());
+
+    for (const char *suffix : {".gz", ".truncated.gz", ".zst"})
+    {
+        std::remove((base + suffix).c_str());
+    }
+}
+
+TEST_CASE("BlockCompressor: Test compressed snapshot round trip")
+{
+    std::string text;
+    for (int i = 0; i < 20000; ++i)
+    {
+        text += "Title" + std::to_string(i) + "\tArtist" + std::to_string(i % 50) + "\t" + std::to_string(100 + i % 300) + "\n";
+    }
+
+    // Small blocks and several threads, the members must still come out in order
+    std::ostringstream compressedStream;
+    BlockCompressor compressor(compressedStream, 6, 3, 4096);
+    for (size_t offset = 0; offset < text.size(); offset += 1000)
+    {
+        compressor.write(text.data() + offset, std::min<size_t>(1000, text.size() - offset));
+    }
+    REQUIRE(compressor.finish());
+    std::string compressed = compressedStream.str();
+    REQUIRE(detectCompression(compressed.data(), compressed.size()) == Compression::Gzip);
+    REQUIRE(compressed.size() < text.size() / 3);
+    std::string decompressed;
+    REQUIRE(decompressGzip(compressed, decompressed));
+    REQUIRE(decompressed == text);
+
+    // Nothing written still gives a valid, empty gzip file
+    std::ostringstream emptyStream;
+    REQUIRE(BlockCompressor(emptyStream).finish());
+    REQUIRE(decompressGzip(emptyStream.str(), decompressed));
+    REQUIRE(decompressed.empty());
+
+    // A saved snapshot loads back with every track
+    HashTable hashTable(101);
+    for (int i = 0; i < 5000; ++i)
+    {
+        hashTable.insert(Track(i + 1, "Title" + std::to_string(i), "Artist" + std::to_string(i % 50), 100 + i % 300));
+    }
+    std::string fileName = "/tmp/music_library_snapshot_" + std::to_string(getpid()) + ".txt.gz";
+    REQUIRE(writeTracksToFile(hashTable, fileName, Compression::Gzip));
+    std::vector<Track> reloaded = loadTracksFromFile(fileName);
+    REQUIRE(reloaded.size() == hashTable.size());
+    HashTable reloadedTable(101);
+    REQUIRE(reloadedTable.insertMany(reloaded, false) == hashTable.size());
+    std::remove(fileName.c_str());
+}
+
+TEST_CASE("ArtistDictionary class: Test front coded artist names")
+{
+    ArtistDictionary dictionary;
+    REQUIRE(dictionary.find("Nobody") == ArtistDictionary::notFound);
+
+    // Enough names to be sorted into blocks several times, sharing long prefixes
+    bool idsInOrder = true;
+    for (int i = 0; i < 5000; ++i)
+    {
+        idsInOrder = idsInOrder && dictionary.intern("The Artist " + std::to_string(i)) == static_cast<uint32_t>(i);
+    }
+    REQUIRE(idsInOrder);
+    uint32_t upperCase = dictionary.intern("THE ARTIST 42");
+    REQUIRE(upperCase == 5000);
+    REQUIRE(dictionary.intern("The Artist 42") == 42);
+    REQUIRE(dictionary.size() == 5001);
+
+    // Ids keep their names across rebuilds
+    bool namesKept = true;
+    for (uint32_t id = 0; id < 5000; ++id)
+    {
+        namesKept = namesKept && dictionary.getName(id) == "The Artist " + std::to_string(id);
+    }
+    REQUIRE(namesKept);
+    REQUIRE(dictionary.getName(upperCase) == "THE ARTIST 42");
+    REQUIRE(dictionary.find("the artist 42") == ArtistDictionary::notFound);
+
+    // Every spelling is found ignoring case, and shares the folded hash
+    std::vector<uint32_t> spellings = dictionary.findIgnoringCase("the artist 42");
+    std::sort(spellings.begin(), spellings.end());
+    REQUIRE(spellings == std::vector<uint32_t>{42, upperCase});
+    REQUIRE(dictionary.getHash(42) == dictionary.getHash(upperCase));
+    REQUIRE(dictionary.findIgnoringCase("The Artist 5000").empty());
+
+    // Tracks keep the spelling they were inserted with
+    HashTable hashTable(8);
+    hashTable.insert(Track(1, "Title1", "Artist1", 120));
+    hashTable.insert(Track(2, "Title2", "ARTIST1", 180));
+    std::vector<Track> found = hashTable.search("artist1");
+    REQUIRE(found.size() == 2);
+    REQUIRE(found[0].getArtist() == "Artist1");
+    REQUIRE(found[1].getArtist() == "ARTIST1");
+    REQUIRE(hashTable.getStats().artistCount == 2);
+}
+
+TEST_CASE("HashTable class: Test compact track records")
+{
+    REQUIRE(sizeof(TrackRecord) == 16);
+
+    HashTable hashTable(8);
+    for (int i = 0; i < 3000; ++i)
+    {
+        hashTable.insert(Track(i + 1, "A fairly long title number " + std::to_string(i), "Artist" + std::to_string(i % 7), 60 + i));
+    }
+
+    // Removing most tracks compacts the title arena, the remaining titles must survive it
+    std::vector<std::pair<std::string, std::string>> removals;
+    for (int i = 0; i < 3000; ++i)
+    {
+        if (i % 10 != 0)
+        {
+            removals.emplace_back("A fairly long title number " + std::to_string(i), "Artist" + std::to_string(i % 7));
+        }
+    }
+    hashTable.removeMany(removals);
+    REQUIRE(hashTable.size() == 300);
+    std::optional<Track> found = hashTable.find("a fairly long title number 2990", "ARTIST1");
+    REQUIRE(found.has_value());
+    REQUIRE(found->getTitle() == "A fairly long title number 2990");
+    REQUIRE(found->getArtist() == "Artist1");
+    REQUIRE(found->getDuration() == 3050);
+    REQUIRE(found->getLineNumber() == 2991);
+    REQUIRE(hashTable.search("artist0").size() == 43);
+    REQUIRE(hashTable.getStats().trackBytes < 3000 * (sizeof(TrackNode) + sizeof(int)) + 3000 * 32);
+
+    // Once discarded, line numbers read as 0 while everything else is kept
+    hashTable.discardLineNumbers();
+    hashTable.insert(Track(5000, "New title", "Artist0", 200));
+    REQUIRE(hashTable.find("A fairly long title number 2990", "Artist1")->getLineNumber() == 0);
+    REQUIRE(hashTable.find("New title", "Artist0")->getDuration() == 200);
+    REQUIRE(hashTable.search("Artist0").size() == 44);
+
+    // The longest title a record holds is stored whole, a longer one is refused rather than cut
+    std::string longestTitle(HashTable::maxTitleLength, 'x');
+    REQUIRE(hashTable.insert(Track(6000, longestTitle, "Long", 100)) == InsertResult::Inserted);
+    REQUIRE(hashTable.find(longestTitle, "Long")->getTitle().size() == HashTable::maxTitleLength);
+    REQUIRE(hashTable.insert(Track(6000, longestTitle, "LONG", 100), false) == InsertResult::Duplicate);
+    std::string tooLongTitle = longestTitle + "y";
+    REQUIRE(hashTable.insert(Track(6001, tooLongTitle, "Long", 100)) == InsertResult::Refused);
+    REQUIRE(hashTable.insertMany({Track(6002, tooLongTitle, "Long", 100), Track(6003, "Short", "Long", 100)}, false) == 1);
+    REQUIRE(hashTable.size() == 303);
+    REQUIRE_FALSE(hashTable.find(tooLongTitle, "Long").has_value());
+    REQUIRE(hashTable.search("Long").size() == 2);
+    REQUIRE(hashTable.remove(longestTitle, "Long"));
+}
+
+TEST_CASE("HashTable class: Test removed nodes are reclaimed")
+{
+    HashTable hashTable(8);
+    for (int i = 0; i < 6000; ++i)
+    {
+        hashTable.insert(Track(i + 1, "Song " + std::to_string(i) + (i % 3 == 0 ? " Love" : ""), "Artist" + std::to_string(i % 3), 100 + i % 50));
+    }
+    REQUIRE(hashTable.searchPage("Artist0", TrackOrder::Title, 0, 5).totalTracks == 2000);
+    size_t fullBytes = hashTable.getStats().trackBytes;
+
+    // Removing most tracks renumbers the rest, every index must follow
+    std::vector<std::pair<std::string, std::string>> removals;
+    for (int i = 0; i < 6000; ++i)
+    {
+        if (i % 6 != 0)
+        {
+            removals.emplace_back("Song " + std::to_string(i) + (i % 3 == 0 ? " Love" : ""), "Artist" + std::to_string(i % 3));
+        }
+    }
+    hashTable.removeMany(removals);
+    REQUIRE(hashTable.size() == 1000);
+    REQUIRE(hashTable.getStats().trackBytes < fullBytes / 3);
+    std::vector<Track> foundTracks = hashTable.search("artist0");
+    REQUIRE(foundTracks.size() == 1000);
+    REQUIRE(foundTracks[1].getTitle() == "Song 6 Love");
+    REQUIRE(foundTracks[1].getLineNumber() == 7);
+    REQUIRE(hashTable.search("Artist1").empty());
+    std::vector<Track> loveTracks = hashTable.searchByTitle("love", true);
+    REQUIRE(loveTracks.size() == 1000);
+    REQUIRE(loveTracks.back().getTitle() == "Song 5994 Love");
+    REQUIRE(hashTable.countByDuration(100, 100) == 40);
+    REQUIRE(hashTable.searchByDuration(104, 104).front().getTitle() == "Song 54 Love");
+    TrackPage page = hashTable.searchPage("Artist0", TrackOrder::Duration, 0, 2);
+    REQUIRE(page.totalTracks == 1000);
+    REQUIRE(page.tracks[0].getTitle() == "Song 0 Love");
+    REQUIRE(page.tracks[1].getTitle() == "Song 150 Love");
+
+    // Tracks inserted and removed afterwards get the next ids in order
+    hashTable.insert(Track(7000, "Late Love", "Artist0", 100));
+    REQUIRE(hashTable.searchByTitle("love", true).back().getTitle() == "Late Love");
+    REQUIRE(hashTable.searchPage("Artist0", TrackOrder::Duration, 40, 1).tracks[0].getTitle() == "Late Love");
+    REQUIRE(hashTable.remove("Song 0 Love", "Artist0"));
+    REQUIRE(hashTable.searchByTitle("love", true).front().getTitle() == "Song 6 Love");
+    REQUIRE(hashTable.find("Song 5994 Love", "ARTIST0")->getDuration() == 144);
+}
+
+TEST_CASE("BasicHashTable class: Test compile time configurations")
+{
+    // Power of two buckets round up and grow like the default table
+    FastHashTable fastTable(5);
+    REQUIRE(fastTable.getStats().tableSize == 8);
+    for (int i = 0; i < 100; ++i)
+    {
+        fastTable.insert(Track(i + 1, "Title" + std::to_string(i), "Artist" + std::to_string(i % 10), 100 + i));
+    }
+    REQUIRE(fastTable.getStats().tableSize == 128);
+    REQUIRE(fastTable.search("ARTIST3").size() == 10);
+    REQUIRE(fastTable.find("title42", "artist2").has_value());
+
+    // Case sensitive keys tell spellings apart
+    CaseSensitiveHashTable caseSensitiveTable(16);
+    caseSensitiveTable.insert(Track(1, "Title", "Artist", 120));
+    caseSensitiveTable.insert(Track(2, "TITLE", "ARTIST", 180));
+    REQUIRE(caseSensitiveTable.size() == 2);
+    REQUIRE(caseSensitiveTable.search("Artist").size() == 1);
+    REQUIRE(caseSensitiveTable.search("ARTIST")[0].getDuration() == 180);
+    REQUIRE(caseSensitiveTable.search("artist").empty());
+    REQUIRE_FALSE(caseSensitiveTable.remove("title", "artist"));
+    REQUIRE(caseSensitiveTable.remove("TITLE", "ARTIST"));
+
+    // A fixed capacity never grows
+    FixedHashTable fixedTable(1);
+    std::vector<Track> tracks;
+    for (int i = 0; i < 70000; ++i)
+    {
+        tracks.emplace_back(i + 1, "Title" + std::to_string(i), "Artist" + std::to_string(i % 1000), 100);
+    }
+    REQUIRE(fixedTable.insertMany(tracks) == 70000);
+    REQUIRE(fixedTable.getStats().tableSize == 65536);
+    REQUIRE(fixedTable.getStats().resizes == 0);
+    REQUIRE(fixedTable.search("artist999").size() == 70);
+}
@@ -0,0 +1,55 @@
+/*
+    textUtils.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cctype>
+#include "textUtils.h"
+
+/*
+Convert a string to lowercase
+@param str the string to convert
+@return a lowercase copy of the given string
+*/
+std::string toLowerCase(const std::string &str)
+{
+    std::string result = str;
+    for (char &c : result)
+    {
+        c = tolower(static_cast<unsigned char>(c));
+    }
+    return result;
+}
+
+/*
+Split a text into lowercase words
+Letters, digits and non-ASCII bytes form words, everything else separates them
+@param text the text to split
+@return the words of the text in order of appearance
+*/
+std::vector<std::string> tokenizeWords(const std::string &text)
+{
+    std::vector<std::string> words;
+    std::string currentWord;
+    for (char c : text)
+    {
+        unsigned char uc = static_cast<unsigned char>(c);
+        // Keep UTF-8 sequences intact by treating every non-ASCII byte as part of a word
+        if (isalnum(uc) || uc >= 0x80)
+        {
+            currentWord += static_cast<char>(tolower(uc));
+        }
+        else if (!currentWord.empty())
+        {
+            words.push_back(currentWord);
+            currentWord.clear();
+        }
+    }
+    if (!currentWord.empty())
+    {
+        words.push_back(currentWord);
+    }
+    return words;
+}
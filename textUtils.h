@@ -0,0 +1,29 @@
+#ifndef __TEXTUTILS_H_
+#define __TEXTUTILS_H_
+
+/*
+    textUtils.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <string>
+#include <vector>
+
+/*
+Convert a string to lowercase
+@param str the string to convert
+@return a lowercase copy of the given string
+*/
+std::string toLowerCase(const std::string &str);
+
+/*
+Split a text into lowercase words
+Letters, digits and non-ASCII bytes form words, everything else separates them
+@param text the text to split
+@return the words of the text in order of appearance
+*/
+std::vector<std::string> tokenizeWords(const std::string &text);
+
+#endif
@@ -0,0 +1,383 @@
+/*
+    titleIndex.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "titleIndex.h"
+#include "textUtils.h"
+
+// Constructor
+PostingList::PostingList()
+    : count(0), last(0) {}
+
+/*
+Append an id to the list
+@param id the id to append, must be greater than every id already in the list
+*/
+void PostingList::append(uint32_t id)
+{
+    // A title repeating a word maps to the same id twice, keep it once
+    if (count > 0 && id <= last)
+    {
+        return;
+    }
+
+    // Store the gap to the previous id, 7 bits per byte with the high bit marking continuation
+    uint32_t delta = count == 0 ? id : id - last;
+    while (delta >= 0x80)
+    {
+        bytes.push_back(static_cast<uint8_t>(delta | 0x80));
+        delta >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(delta));
+
+    last = id;
+    count++;
+}
+
+/*
+Decode the list
+@return the ids of the list in ascending order
+*/
+std::vector<uint32_t> PostingList::decode() const
+{
+    std::vector<uint32_t> ids;
+    ids.reserve(count);
+
+    uint32_t current = 0;
+    size_t position = 0;
+    while (position < bytes.size())
+    {
+        uint32_t delta = 0;
+        int shift = 0;
+        while (bytes[position] & 0x80)
+        {
+            delta |= static_cast<uint32_t>(bytes[position++] & 0x7F) << shift;
+            shift += 7;
+        }
+        delta |= static_cast<uint32_t>(bytes[position++]) << shift;
+
+        current += delta;
+        ids.push_back(current);
+    }
+    return ids;
+}
+
+// Getter methods
+uint32_t PostingList::size() const
+{
+    return count;
+}
+bool PostingList::empty() const
+{
+    return count == 0;
+}
+
+/*
+Intersect a short sorted list with a much longer one by binary searching the long list
+@param small the shorter sorted list
+@param large the longer sorted list
+@return the ids present in both lists, in ascending order
+*/
+static std::vector<uint32_t> gallopingIntersect(const std::vector<uint32_t> &small, const std::vector<uint32_t> &large)
+{
+    std::vector<uint32_t> result;
+    auto position = large.begin();
+    for (uint32_t id : small)
+    {
+        position = std::lower_bound(position, large.end(), id);
+        if (position == large.end())
+        {
+            break;
+        }
+        if (*position == id)
+        {
+            result.push_back(id);
+        }
+    }
+    return result;
+}
+
+/*
+Intersect two sorted id lists
+@param a the first sorted list
+@param b the second sorted list
+@return the ids present in both lists, in ascending order
+*/
+std::vector<uint32_t> intersectSorted(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b)
+{
+    // When one list is far shorter, probing the longer one is cheaper than a merge
+    if (a.size() * 32 < b.size())
+    {
+        return gallopingIntersect(a, b);
+    }
+    if (b.size() * 32 < a.size())
+    {
+        return gallopingIntersect(b, a);
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(std::min(a.size(), b.size()));
+    size_t i = 0, j = 0;
+
+#ifdef __SSE2__
+    // Compare blocks of four ids against every rotation of the other block
+    while (i + 4 <= a.size() && j + 4 <= b.size())
+    {
+        __m128i blockA = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&a[i]));
+        __m128i blockB = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&b[j]));
+
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(blockA, blockB),
+                         _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(2, 1, 0, 3)))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(matches));
+        for (int k = 0; k < 4; ++k)
+        {
+            if (mask & (1 << k))
+            {
+                result.push_back(a[i + k]);
+            }
+        }
+
+        // Advance the block whose largest id is smaller, or both when they end on the same id
+        uint32_t maxA = a[i + 3];
+        uint32_t maxB = b[j + 3];
+        if (maxA <= maxB)
+        {
+            i += 4;
+        }
+        if (maxB <= maxA)
+        {
+            j += 4;
+        }
+    }
+#endif
+
+    // Merge whatever is left
+    while (i < a.size() && j < b.size())
+    {
+        if (a[i] < b[j])
+        {
+            i++;
+        }
+        else if (b[j] < a[i])
+        {
+            j++;
+        }
+        else
+        {
+            result.push_back(a[i]);
+            i++;
+            j++;
+        }
+    }
+    return result;
+}
+
+/*
+Merge two sorted id lists
+@param a the first sorted list
+@param b the second sorted list
+@return the ids present in either list, in ascending order
+*/
+std::vector<uint32_t> unionSorted(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b)
+{
+    std::vector<uint32_t> result;
+    result.reserve(a.size() + b.size());
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+    return result;
+}
+
+/*
+Index the words of a track title
+@param id the id of the track, must be greater than every id ever indexed
+@param title the title of the track
+*/
+void TitleIndex::add(uint32_t id, const std::string &title)
+{
+    if (indexedIds.size() <= id)
+    {
+        indexedIds.resize(id + 1, false);
+    }
+    indexedIds[id] = true;
+    for (const auto &word : tokenizeWords(title))
+    {
+        postings[word].list.append(id);
+    }
+}
+
+/*
+Remove the words of a track title from the index
+@param id the id of the track
+@param title the title the track was indexed with
+*/
+void TitleIndex::remove(uint32_t id, const std::string &title)
+{
+    // Only an id that is listed and not removed yet counts towards the rebuild of its lists
+    if (id >= indexedIds.size() || !indexedIds[id] || (id < removedIds.size() && removedIds[id]))
+    {
+        return;
+    }
+    if (removedIds.size() <= id)
+    {
+        removedIds.resize(id + 1, false);
+    }
+    removedIds[id] = true;
+
+    // A word repeated in the title is listed once, so it is counted once
+    std::vector<std::string> words = tokenizeWords(title);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    for (const auto &word : words)
+    {
+        auto it = postings.find(word);
+        if (it == postings.end())
+        {
+            continue;
+        }
+
+        // Rebuild the list once half of it is removed, which keeps removal amortized constant time
+        WordPostings &wordPostings = it->second;
+        wordPostings.removedCount++;
+        if (wordPostings.removedCount * 2 < wordPostings.list.size())
+        {
+            continue;
+        }
+        PostingList liveList;
+        for (uint32_t listedId : wordPostings.list.decode())
+        {
+            if (listedId >= removedIds.size() || !removedIds[listedId])
+            {
+                liveList.append(listedId);
+            }
+        }
+        if (liveList.empty())
+        {
+            postings.erase(it);
+        }
+        else
+        {
+            wordPostings.list = liveList;
+            wordPostings.removedCount = 0;
+        }
+    }
+}
+
+/*
+Find the tracks whose title contains the words of a query
+@param query the words to search for
+@param matchAllWords true to require every word (AND), false to require any word (OR)
+@return the ids of the matching tracks in ascending order
+*/
+std::vector<uint32_t> TitleIndex::find(const std::string &query, bool matchAllWords) const
+{
+    std::vector<std::string> words = tokenizeWords(query);
+    std::vector<const PostingList *> lists;
+    for (const auto &word : words)
+    {
+        auto it = postings.find(word);
+        if (it != postings.end())
+        {
+            lists.push_back(&it->second.list);
+        }
+        else if (matchAllWords)
+        {
+            // A word that appears in no title makes the whole AND query empty
+            return {};
+        }
+    }
+    if (lists.empty())
+    {
+        return {};
+    }
+
+    // Start from the shortest list so intermediate results stay small
+    std::sort(lists.begin(), lists.end(), [](const PostingList *lhs, const PostingList *rhs)
+              { return lhs->size() < rhs->size(); });
+
+    std::vector<uint32_t> result = lists[0]->decode();
+    for (size_t i = 1; i < lists.size(); ++i)
+    {
+        if (matchAllWords)
+        {
+            result = intersectSorted(result, lists[i]->decode());
+            if (result.empty())
+            {
+                break;
+            }
+        }
+        else
+        {
+            result = unionSorted(result, lists[i]->decode());
+        }
+    }
+
+    // Drop the removed ids still present in the lists
+    result.erase(std::remove_if(result.begin(), result.end(), [this](uint32_t id)
+                                { return id < removedIds.size() && removedIds[id]; }),
+                 result.end());
+    return result;
+}
+
+/*
+Give every track a new id, dropping the removed ones from the lists
+@param newIds the new id by old id, increasing over the ids kept, UINT32_MAX for the ids to drop
+*/
+void TitleIndex::remapIds(const std::vector<uint32_t> &newIds)
+{
+    // New ids keep the order of the old ones, so every list stays sorted
+    for (auto it = postings.begin(); it != postings.end();)
+    {
+        PostingList remapped;
+        for (uint32_t listedId : it->second.list.decode())
+        {
+            bool removed = listedId < removedIds.size() && removedIds[listedId];
+            if (!removed && listedId < newIds.size() && newIds[listedId] != UINT32_MAX)
+            {
+                remapped.append(newIds[listedId]);
+            }
+        }
+        if (remapped.empty())
+        {
+            it = postings.erase(it);
+            continue;
+        }
+        it->second.list = remapped;
+        it->second.removedCount = 0;
+        ++it;
+    }
+
+    std::vector<bool> remappedIds;
+    for (uint32_t id = 0; id < indexedIds.size() && id < newIds.size(); ++id)
+    {
+        bool removed = id < removedIds.size() && removedIds[id];
+        if (indexedIds[id] && !removed && newIds[id] != UINT32_MAX)
+        {
+            if (remappedIds.size() <= newIds[id])
+            {
+                remappedIds.resize(newIds[id] + 1, false);
+            }
+            remappedIds[newIds[id]] = true;
+        }
+    }
+    indexedIds.swap(remappedIds);
+    std::vector<bool>().swap(removedIds);
+}
+
+// Remove every word from the index
+void TitleIndex::clear()
+{
+    postings.clear();
+    removedIds.clear();
+    indexedIds.clear();
+}
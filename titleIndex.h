@@ -0,0 +1,112 @@
+#ifndef __TITLEINDEX_H_
+#define __TITLEINDEX_H_
+
+/*
+    titleIndex.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// PostingList stores a sorted list of track ids as delta encoded variable length integers
+class PostingList
+{
+private:
+    // Member datas
+    std::vector<uint8_t> bytes;
+    uint32_t count;
+    uint32_t last;
+
+public:
+    // Constructor
+    PostingList();
+
+    /*
+    Append an id to the list
+    @param id the id to append, must be greater than every id already in the list
+    */
+    void append(uint32_t id);
+
+    /*
+    Decode the list
+    @return the ids of the list in ascending order
+    */
+    std::vector<uint32_t> decode() const;
+
+    // Getter methods
+    uint32_t size() const;
+    bool empty() const;
+};
+
+/*
+Intersect two sorted id lists
+@param a the first sorted list
+@param b the second sorted list
+@return the ids present in both lists, in ascending order
+*/
+std::vector<uint32_t> intersectSorted(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b);
+
+/*
+Merge two sorted id lists
+@param a the first sorted list
+@param b the second sorted list
+@return the ids present in either list, in ascending order
+*/
+std::vector<uint32_t> unionSorted(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b);
+
+// TitleIndex class definition, an inverted index from title words to track ids
+class TitleIndex
+{
+private:
+    // WordPostings struct pairs the posting list of a word with the number of removed ids still in it
+    struct WordPostings
+    {
+        PostingList list;
+        uint32_t removedCount = 0;
+    };
+
+    // Member datas
+    std::unordered_map<std::string, WordPostings> postings;
+    // Removed ids stay in their posting lists until half of a list is removed, then the list is rebuilt
+    std::vector<bool> removedIds;
+    std::vector<bool> indexedIds; // Ids added since the last clear, only those count as removals
+
+public:
+    /*
+    Index the words of a track title
+    @param id the id of the track, must be greater than every id ever indexed
+    @param title the title of the track
+    */
+    void add(uint32_t id, const std::string &title);
+
+    /*
+    Remove the words of a track title from the index
+    @param id the id of the track
+    @param title the title the track was indexed with
+    */
+    void remove(uint32_t id, const std::string &title);
+
+    /*
+    Find the tracks whose title contains the words of a query
+    @param query the words to search for
+    @param matchAllWords true to require every word (AND), false to require any word (OR)
+    @return the ids of the matching tracks in ascending order
+    */
+    std::vector<uint32_t> find(const std::string &query, bool matchAllWords) const;
+
+    /*
+    Give every track a new id, dropping the removed ones from the lists
+    @param newIds the new id by old id, increasing over the ids kept, UINT32_MAX for the ids to drop
+    */
+    void remapIds(const std::vector<uint32_t> &newIds);
+
+    // Remove every word from the index
+    void clear();
+};
+
+#endif
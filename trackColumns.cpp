@@ -0,0 +1,196 @@
+/*
+    trackColumns.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <algorithm>
+
+#include "trackColumns.h"
+
+/*
+Constructor, copies every track of a hash table into columns
+@param hashTable the HashTable object storing the tracks
+*/
+TrackColumns::TrackColumns(const HashTable &hashTable)
+    : titleOffsets(1, 0), artists(&hashTable.getArtists()), sourceVersion(hashTable.getVersion())
+{
+    // By dictionary id, the id of the first spelling met of the same artist
+    std::vector<uint32_t> firstSpellings(artists->size(), ArtistDictionary::notFound);
+    std::string lastArtist;
+    uint32_t lastArtistId = ArtistDictionary::notFound;
+
+    hashTable.forEachTrack([&](const Track &track)
+    {
+        lineNumbers.push_back(track.getLineNumber());
+        durations.push_back(track.getDuration());
+        titleData += track.getTitle();
+        titleOffsets.push_back(titleData.size());
+
+        // Tracks by the same artist follow each other, so the dictionary is asked once per run of them
+        if (lastArtistId == ArtistDictionary::notFound || track.getArtist() != lastArtist)
+        {
+            lastArtist = track.getArtist();
+            uint32_t artistId = artists->find(lastArtist);
+            if (firstSpellings[artistId] == ArtistDictionary::notFound)
+            {
+                for (uint32_t spellingId : artists->findIgnoringCase(lastArtist))
+                {
+                    firstSpellings[spellingId] = artistId;
+                }
+                artistOrder.push_back(artistId);
+            }
+            lastArtistId = firstSpellings[artistId];
+        }
+        artistIds.push_back(lastArtistId);
+    });
+}
+
+/*
+Check whether the copy still matches a table
+@param hashTable the HashTable object storing the tracks
+@return true if the copy was made from this table and no track changed since, false otherwise
+*/
+bool TrackColumns::isCurrent(const HashTable &hashTable) const
+{
+    // Versions are never shared between tables, so a table built at the address of the source does not match
+    return sourceVersion == hashTable.getVersion();
+}
+
+// Getter methods
+size_t TrackColumns::size() const
+{
+    return durations.size();
+}
+size_t TrackColumns::artistCount() const
+{
+    return artistOrder.size();
+}
+int TrackColumns::getLineNumber(size_t row) const
+{
+    return lineNumbers[row];
+}
+int TrackColumns::getDuration(size_t row) const
+{
+    return durations[row];
+}
+std::string TrackColumns::getTitle(size_t row) const
+{
+    return titleData.substr(titleOffsets[row], titleOffsets[row + 1] - titleOffsets[row]);
+}
+std::string TrackColumns::getArtist(size_t row) const
+{
+    return artists->getName(artistIds[row]);
+}
+
+/*
+Sum the durations of every track
+@return the total duration in seconds
+*/
+long long TrackColumns::totalDuration() const
+{
+    // Plain loops over the contiguous column let the compiler vectorize the scans
+    long long total = 0;
+    for (size_t i = 0; i < durations.size(); ++i)
+    {
+        total += durations[i];
+    }
+    return total;
+}
+
+/*
+Find the shortest duration
+@return the shortest duration in seconds, or 0 if there are no tracks
+*/
+int TrackColumns::minDuration() const
+{
+    if (durations.empty())
+    {
+        return 0;
+    }
+    int minimum = durations[0];
+    for (size_t i = 1; i < durations.size(); ++i)
+    {
+        minimum = std::min(minimum, durations[i]);
+    }
+    return minimum;
+}
+
+/*
+Find the longest duration
+@return the longest duration in seconds, or 0 if there are no tracks
+*/
+int TrackColumns::maxDuration() const
+{
+    if (durations.empty())
+    {
+        return 0;
+    }
+    int maximum = durations[0];
+    for (size_t i = 1; i < durations.size(); ++i)
+    {
+        maximum = std::max(maximum, durations[i]);
+    }
+    return maximum;
+}
+
+/*
+Average the durations of every track
+@return the average duration in seconds, or 0 if there are no tracks
+*/
+double TrackColumns::averageDuration() const
+{
+    if (durations.empty())
+    {
+        return 0;
+    }
+    return static_cast<double>(totalDuration()) / durations.size();
+}
+
+/*
+Count the tracks of every artist
+@return pairs of artist name and number of tracks, ordered by decreasing count
+*/
+std::vector<std::pair<std::string, size_t>> TrackColumns::countPerArtist() const
+{
+    // Counted by dictionary id, the names are only decoded for the result
+    std::vector<size_t> counts(artists->size(), 0);
+    for (size_t i = 0; i < artistIds.size(); ++i)
+    {
+        counts[artistIds[i]]++;
+    }
+
+    std::vector<std::pair<std::string, size_t>> result;
+    result.reserve(artistOrder.size());
+    for (uint32_t artistId : artistOrder)
+    {
+        result.emplace_back(artists->getName(artistId), counts[artistId]);
+    }
+    std::stable_sort(result.begin(), result.end(), [](const std::pair<std::string, size_t> &lhs, const std::pair<std::string, size_t> &rhs)
+                     { return lhs.second > rhs.second; });
+    return result;
+}
+
+/*
+Count the tracks falling in consecutive duration buckets, at most maxHistogramBuckets of them
+@param bucketWidth the width of a bucket in seconds
+@return the number of tracks in each bucket, bucket i covers [i * bucketWidth, (i + 1) * bucketWidth),
+except the bucket maxHistogramBuckets - 1 which also covers every longer duration
+*/
+std::vector<size_t> TrackColumns::durationHistogram(int bucketWidth) const
+{
+    if (bucketWidth <= 0 || durations.empty())
+    {
+        return {};
+    }
+
+    // Negative durations are counted in the first bucket, a few huge ones cannot size the histogram
+    size_t bucketCount = std::min<size_t>(std::max(maxDuration(), 0) / bucketWidth + 1, maxHistogramBuckets);
+    std::vector<size_t> buckets(bucketCount, 0);
+    for (size_t i = 0; i < durations.size(); ++i)
+    {
+        buckets[std::min<size_t>(std::max(durations[i], 0) / bucketWidth, bucketCount - 1)]++;
+    }
+    return buckets;
+}
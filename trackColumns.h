@@ -0,0 +1,100 @@
+#ifndef __TRACKCOLUMNS_H_
+#define __TRACKCOLUMNS_H_
+
+/*
+    trackColumns.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated:
+*/
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "artistDictionary.h"
+#include "hashTable.h"
+
+// TrackColumns class definition, a read only column oriented copy of the tracks for analytics scans
+// The copy remembers the version of its table, so a caller may keep it until the table changes
+// Artist names are not copied but read from the table's dictionary, so the copy must not outlive its table
+class TrackColumns
+{
+private:
+    // Member datas, row i of every column describes the same track
+    std::vector<int> lineNumbers;
+    std::vector<int> durations;
+    std::vector<uint32_t> artistIds; // Dictionary ids, spellings equal ignoring case share the id of the first one met
+    // Titles are stored back to back, the title of row i spans titleOffsets[i] to titleOffsets[i + 1]
+    std::string titleData;
+    std::vector<size_t> titleOffsets;
+    std::vector<uint32_t> artistOrder; // Dictionary ids of the distinct artists, in the order first met
+    const ArtistDictionary *artists;   // Dictionary of the table, which resolves the ids to names
+    uint64_t sourceVersion; // Version of the table when copied
+
+public:
+    /*
+    Constructor, copies every track of a hash table into columns
+    @param hashTable the HashTable object storing the tracks
+    */
+    TrackColumns(const HashTable &hashTable);
+
+    /*
+    Check whether the copy still matches a table
+    @param hashTable the HashTable object storing the tracks
+    @return true if the copy was made from this table and no track changed since, false otherwise
+    */
+    bool isCurrent(const HashTable &hashTable) const;
+
+    // Durations past the last of this many histogram buckets are counted in the last one
+    static constexpr size_t maxHistogramBuckets = 1024;
+
+    // Getter methods
+    size_t size() const;
+    size_t artistCount() const;
+    int getLineNumber(size_t row) const;
+    int getDuration(size_t row) const;
+    std::string getTitle(size_t row) const;
+    std::string getArtist(size_t row) const;
+
+    /*
+    Sum the durations of every track
+    @return the total duration in seconds
+    */
+    long long totalDuration() const;
+
+    /*
+    Find the shortest duration
+    @return the shortest duration in seconds, or 0 if there are no tracks
+    */
+    int minDuration() const;
+
+    /*
+    Find the longest duration
+    @return the longest duration in seconds, or 0 if there are no tracks
+    */
+    int maxDuration() const;
+
+    /*
+    Average the durations of every track
+    @return the average duration in seconds, or 0 if there are no tracks
+    */
+    double averageDuration() const;
+
+    /*
+    Count the tracks of every artist
+    @return pairs of artist name and number of tracks, ordered by decreasing count
+    */
+    std::vector<std::pair<std::string, size_t>> countPerArtist() const;
+
+    /*
+    Count the tracks falling in consecutive duration buckets, at most maxHistogramBuckets of them
+    @param bucketWidth the width of a bucket in seconds
+    @return the number of tracks in each bucket, bucket i covers [i * bucketWidth, (i + 1) * bucketWidth),
+    except the bucket maxHistogramBuckets - 1 which also covers every longer duration
+    */
+    std::vector<size_t> durationHistogram(int bucketWidth) const;
+};
+
+#endif
@@ -0,0 +1,188 @@
+/*
+    trackIO.cpp
+    Author: M00826933
+    Created: 19/10/26
+    Updated: 19/10/26
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include "blockCompressor.h"
+#include "latencyHistogram.h"
+#include "lineReader.h"
+#include "trackIO.h"
+
+/*
+Parse one tab separated line of a track file
+@param line the line holding a title, an artist and a duration
+@param lineNumber the number of the line in its file
+@param tracks the vector to append the track to
+@param warnings the stream to report an invalid duration to, may be null
+@return true if the line held a valid track, false otherwise
+*/
+bool parseTrackLine(const std::string &line, int lineNumber, std::vector<Track> &tracks, std::ostream *warnings)
+{
+    std::istringstream lineStream(line);
+    std::string title, artist, durationStr;
+    std::getline(lineStream, title, '\t');
+    std::getline(lineStream, artist, '\t');
+    std::getline(lineStream, durationStr, '\t');
+
+    try
+    {
+        int duration = std::stoi(durationStr);
+        tracks.emplace_back(lineNumber, title, artist, duration);
+        return true;
+    }
+    catch (const std::logic_error &ex)
+    {
+        // Both invalid_argument (not a number) and out_of_range (too large for an int) end up here
+        if (warnings)
+        {
+            *warnings << "Warning: Invalid duration value on line " << lineNumber << ": Track \"" << title << "\" by artist \"" << artist << ". Skipping track." << std::endl;
+        }
+        return false;
+    }
+}
+
+/*
+Load tracks from a file
+@param fileName the name of the file containing the tracks
+@return a vector of Track objects loaded from the file
+*/
+std::vector<Track> loadTracksFromFile(const std::string &fileName)
+{
+    ScopedLatencyTimer timer(Operation::Load);
+    std::vector<Track> tracks;
+    LineReader inputFile(fileName);
+
+    // Open input file, gzip compressed files are decompressed on the fly
+    if (!inputFile.isOpen())
+    {
+        if (inputFile.getCompression() == Compression::Zstd)
+        {
+            std::cerr << "Error: file " << fileName << " is zstd compressed, which this build cannot read" << std::endl;
+        }
+        else
+        {
+            std::cerr << "Error: could not open file " << fileName << std::endl;
+        }
+        return tracks;
+    }
+
+    // Check if file is empty
+    std::string line;
+    if (!inputFile.readLine(line))
+    {
+        std::cerr << "Error: file " << fileName << " is empty" << std::endl;
+        return tracks;
+    }
+
+    int lineNumber = 0;
+    do
+    {
+        lineNumber++;
+        parseTrackLine(line, lineNumber, tracks, &std::cerr);
+    } while (inputFile.readLine(line));
+
+    if (inputFile.isCorrupt())
+    {
+        std::cerr << "Warning: file " << fileName << " ends with invalid or truncated compressed data" << std::endl;
+    }
+    return tracks;
+}
+
+/*
+Load the tracks to remove from a file
+Each line holds a track title and an artist name separated by a tab
+@param fileName the name of the file containing the tracks to remove
+@return pairs of title and artist loaded from the file
+*/
+std::vector<std::pair<std::string, std::string>> loadRemovalsFromFile(const std::string &fileName)
+{
+    std::vector<std::pair<std::string, std::string>> removals;
+    std::ifstream inputFile(fileName);
+
+    // Open input file
+    if (!inputFile)
+    {
+        std::cerr << "Error: could not open file " << fileName << std::endl;
+        return removals;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(inputFile, line))
+    {
+        lineNumber++;
+        std::istringstream lineStream(line);
+        std::string title, artist;
+        std::getline(lineStream, title, '\t');
+        if (!std::getline(lineStream, artist, '\t'))
+        {
+            std::cerr << "Warning: Missing artist on line " << lineNumber << " of " << fileName << ". Skipping line." << std::endl;
+            continue;
+        }
+        removals.emplace_back(title, artist);
+    }
+
+    inputFile.close();
+    return removals;
+}
+
+/*
+Write every track of the hash table to a file, one tab separated line per track
+@param hashTable the HashTable object storing the tracks
+@param fileName the name of the file to write
+@param compression Compression::Gzip to compress the file on every core, Compression::None for plain text
+@return true if successful, false otherwise
+*/
+bool writeTracksToFile(const HashTable &hashTable, const std::string &fileName, Compression compression)
+{
+    ScopedLatencyTimer timer(Operation::Save);
+    if (compression == Compression::Zstd)
+    {
+        std::cerr << "Error: this build cannot write zstd compressed files" << std::endl;
+        return false;
+    }
+
+    std::ofstream outputFile(fileName, std::ios::binary);
+
+    if (!outputFile)
+    {
+        std::cerr << "Error: could not open file " << fileName << " for writing" << std::endl;
+        return false;
+    }
+
+    if (compression == Compression::Gzip)
+    {
+        // Format the lines into one reused buffer, the compressing threads take it over block by block
+        // Level 1 keeps saving close to plain text speed, higher levels cost several times the time for a few percent
+        BlockCompressor compressor(outputFile, 1);
+        std::string line;
+        hashTable.forEachTrack([&compressor, &line](const Track &track)
+        {
+            line.assign(track.getTitle()).append(1, '\t').append(track.getArtist()).append(1, '\t');
+            line.append(std::to_string(track.getDuration())).append(1, '\n');
+            compressor.write(line.data(), line.size());
+        });
+        if (!compressor.finish())
+        {
+            std::cerr << "Error: could not compress the tracks into " << fileName << std::endl;
+            return false;
+        }
+        outputFile.close();
+        return static_cast<bool>(outputFile);
+    }
+
+    // Stream the tracks straight from the table, flushing only once at the end
+    hashTable.forEachTrack([&outputFile](const Track &track)
+    {
+        outputFile << track.getTitle() << '\t' << track.getArtist() << '\t' << track.getDuration() << '\n';
+    });
+
+    outputFile.close();
+    return static_cast<bool>(outputFile);
+}
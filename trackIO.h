@@ -0,0 +1,54 @@
+#ifndef __TRACKIO_H_
+#define __TRACKIO_H_
+
+/*
+    trackIO.h
+    Author: M00826933
+    Created: 19/10/26
+    Updated: 19/10/26
+*/
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "track.h"
+#include "hashTable.h"
+#include "lineReader.h"
+
+/*
+Parse one tab separated line of a track file
+@param line the line holding a title, an artist and a duration
+@param lineNumber the number of the line in its file
+@param tracks the vector to append the track to
+@param warnings the stream to report an invalid duration to, may be null
+@return true if the line held a valid track, false otherwise
+*/
+bool parseTrackLine(const std::string &line, int lineNumber, std::vector<Track> &tracks, std::ostream *warnings);
+
+/*
+Load tracks from a file
+@param fileName the name of the file containing the tracks
+@return a vector of Track objects loaded from the file
+*/
+std::vector<Track> loadTracksFromFile(const std::string &fileName);
+
+/*
+Load the tracks to remove from a file
+Each line holds a track title and an artist name separated by a tab
+@param fileName the name of the file containing the tracks to remove
+@return pairs of title and artist loaded from the file
+*/
+std::vector<std::pair<std::string, std::string>> loadRemovalsFromFile(const std::string &fileName);
+
+/*
+Write every track of the hash table to a file, one tab separated line per track
+@param hashTable the HashTable object storing the tracks
+@param fileName the name of the file to write
+@param compression Compression::Gzip to compress the file on every core, Compression::None for plain text
+@return true if successful, false otherwise
+*/
+bool writeTracksToFile(const HashTable &hashTable, const std::string &fileName, Compression compression = Compression::None);
+
+#endif